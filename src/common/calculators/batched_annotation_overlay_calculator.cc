@@ -0,0 +1,229 @@
+// "common/prebuilt/calculators/batched_annotation_overlay_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/util/span_rasterizer.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace {
+
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kVectorTag[] = "VECTOR";
+
+}  // namespace
+
+namespace mediapipe {
+
+using prebuilt::SpanRasterizer;
+
+// Draws lines, points and rectangles of RenderData onto a CPU image, all
+// annotations of a frame in one anti-aliased pass.
+//
+// CPU alternative to AnnotationOverlayCalculator for graphs with many
+// annotations, e.g. landmarks and connections of several people. Rather than
+// one OpenCV call per annotation, each walking the image on its own, the
+// annotations are collected into a SpanRasterizer that draws them band by
+// band with SIMD span kernels.
+//
+// Lines, gradient lines (in their first color), scribbles, points, rectangles
+// and filled rectangles are drawn. Other annotations, such as text and ovals,
+// are skipped with a warning. Points are discs with the annotation thickness
+// as their radius, like AnnotationOverlayCalculator draws them.
+//
+// Inputs:
+//   IMAGE: ImageFrame, SRGB or SRGBA.
+//   Any number of untagged RenderData streams.
+//   VECTOR (optional): Any number of std::vector<RenderData> streams, as
+//           VECTOR:0, VECTOR:1 and so on.
+//
+// Outputs:
+//   IMAGE: ImageFrame of the input format with the annotations drawn on.
+//
+// Usage example:
+// node {
+//   calculator: "BatchedAnnotationOverlayCalculator"
+//   input_stream: "IMAGE:input_video"
+//   input_stream: "detections_render_data"
+//   input_stream: "VECTOR:0:landmarks_render_data_list"
+//   output_stream: "IMAGE:output_video"
+// }
+//
+class BatchedAnnotationOverlayCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Adds the annotations of `render_data` to rasterizer_, scaling normalized
+  // coordinates by the image size.
+  void AddRenderData(const RenderData& render_data, int width, int height);
+
+  SpanRasterizer rasterizer_;
+};
+
+REGISTER_CALCULATOR(BatchedAnnotationOverlayCalculator);
+
+absl::Status BatchedAnnotationOverlayCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    const std::string& tag = cc->Inputs().TagAndIndexFromId(id).first;
+    if (tag.empty()) {
+      cc->Inputs().Get(id).Set<RenderData>();
+    } else if (tag == kVectorTag) {
+      cc->Inputs().Get(id).Set<std::vector<RenderData>>();
+    } else {
+      RET_CHECK_EQ(tag, kImageTag) << "Unexpected input stream tag: " << tag;
+    }
+  }
+
+  cc->Outputs().Tag(kImageTag).Set<ImageFrame>();
+  return absl::OkStatus();
+}
+
+absl::Status BatchedAnnotationOverlayCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+void BatchedAnnotationOverlayCalculator::AddRenderData(
+    const RenderData& render_data, int width, int height) {
+  for (const auto& annotation : render_data.render_annotations()) {
+    const SpanRasterizer::Color color = {
+        static_cast<uint8_t>(annotation.color().r()),
+        static_cast<uint8_t>(annotation.color().g()),
+        static_cast<uint8_t>(annotation.color().b())};
+    const float thickness = annotation.thickness();
+
+    switch (annotation.data_case()) {
+      case RenderAnnotation::kLine: {
+        const auto& line = annotation.line();
+        const float scale_x = line.normalized() ? width : 1.f;
+        const float scale_y = line.normalized() ? height : 1.f;
+        rasterizer_.AddLine(line.x_start() * scale_x, line.y_start() * scale_y,
+                            line.x_end() * scale_x, line.y_end() * scale_y,
+                            thickness, color);
+        break;
+      }
+      case RenderAnnotation::kGradientLine: {
+        const auto& line = annotation.gradient_line();
+        const float scale_x = line.normalized() ? width : 1.f;
+        const float scale_y = line.normalized() ? height : 1.f;
+        const SpanRasterizer::Color color1 = {
+            static_cast<uint8_t>(line.color1().r()),
+            static_cast<uint8_t>(line.color1().g()),
+            static_cast<uint8_t>(line.color1().b())};
+        rasterizer_.AddLine(line.x_start() * scale_x, line.y_start() * scale_y,
+                            line.x_end() * scale_x, line.y_end() * scale_y,
+                            thickness, color1);
+        break;
+      }
+      case RenderAnnotation::kScribble: {
+        const auto& points = annotation.scribble().point();
+        for (int i = 1; i < points.size(); ++i) {
+          const float scale_x = points[i].normalized() ? width : 1.f;
+          const float scale_y = points[i].normalized() ? height : 1.f;
+          rasterizer_.AddLine(
+              points[i - 1].x() * scale_x, points[i - 1].y() * scale_y,
+              points[i].x() * scale_x, points[i].y() * scale_y, thickness,
+              color);
+        }
+        break;
+      }
+      case RenderAnnotation::kPoint: {
+        const auto& point = annotation.point();
+        const float scale_x = point.normalized() ? width : 1.f;
+        const float scale_y = point.normalized() ? height : 1.f;
+        rasterizer_.AddDisc(point.x() * scale_x, point.y() * scale_y,
+                            thickness, color);
+        break;
+      }
+      case RenderAnnotation::kRectangle: {
+        const auto& rect = annotation.rectangle();
+        const float scale_x = rect.normalized() ? width : 1.f;
+        const float scale_y = rect.normalized() ? height : 1.f;
+        rasterizer_.AddRect(rect.left() * scale_x, rect.top() * scale_y,
+                            rect.right() * scale_x, rect.bottom() * scale_y,
+                            rect.rotation(), thickness, color);
+        break;
+      }
+      case RenderAnnotation::kFilledRectangle: {
+        const auto& filled = annotation.filled_rectangle();
+        const auto& rect = filled.rectangle();
+        const float scale_x = rect.normalized() ? width : 1.f;
+        const float scale_y = rect.normalized() ? height : 1.f;
+        const SpanRasterizer::Color fill_color = {
+            static_cast<uint8_t>(filled.fill_color().r()),
+            static_cast<uint8_t>(filled.fill_color().g()),
+            static_cast<uint8_t>(filled.fill_color().b())};
+        rasterizer_.AddFilledRect(rect.left() * scale_x, rect.top() * scale_y,
+                                  rect.right() * scale_x,
+                                  rect.bottom() * scale_y, fill_color);
+        if (thickness > 0.f) {
+          rasterizer_.AddRect(rect.left() * scale_x, rect.top() * scale_y,
+                              rect.right() * scale_x, rect.bottom() * scale_y,
+                              rect.rotation(), thickness, color);
+        }
+        break;
+      }
+      default:
+        LOG_FIRST_N(WARNING, 1)
+            << "BatchedAnnotationOverlayCalculator only draws lines, points "
+               "and rectangles; skipping annotation of type "
+            << annotation.data_case() << ".";
+        break;
+    }
+  }
+}
+
+absl::Status BatchedAnnotationOverlayCalculator::Process(
+    CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kImageTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const auto& input_frame = cc->Inputs().Tag(kImageTag).Get<ImageFrame>();
+  RET_CHECK(input_frame.Format() == ImageFormat::SRGB ||
+            input_frame.Format() == ImageFormat::SRGBA)
+      << "Only SRGB and SRGBA images are supported.";
+  const int width = input_frame.Width();
+  const int height = input_frame.Height();
+
+  rasterizer_.Clear();
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    const std::string& tag = cc->Inputs().TagAndIndexFromId(id).first;
+    if (cc->Inputs().Get(id).IsEmpty()) continue;
+    if (tag.empty()) {
+      AddRenderData(cc->Inputs().Get(id).Get<RenderData>(), width, height);
+    } else if (tag == kVectorTag) {
+      for (const auto& render_data :
+           cc->Inputs().Get(id).Get<std::vector<RenderData>>()) {
+        AddRenderData(render_data, width, height);
+      }
+    }
+  }
+
+  auto output_frame = absl::make_unique<ImageFrame>();
+  output_frame->CopyFrom(input_frame, ImageFrame::kDefaultAlignmentBoundary);
+  if (!rasterizer_.empty()) {
+    rasterizer_.Draw(output_frame->MutablePixelData(), width, height,
+                     output_frame->WidthStep(),
+                     output_frame->NumberOfChannels());
+  }
+
+  cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
+                                   cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,138 @@
+// "common/prebuilt/calculators/cached_inference_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/cached_tflite_inference_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/model_registry.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/resource_util.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace {
+
+constexpr char kTensorsTag[] = "TENSORS";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Runs a TFLite model on CPU with an interpreter leased from the process-wide
+// ModelRegistry, on mediapipe::Tensor.
+//
+// Counterpart of CachedTfLiteInferenceCalculator for graphs that build their
+// inputs with ImageToTensorCalculator or RoiToTensorCalculator, and CPU
+// alternative to InferenceCalculator. Takes the same options. With
+// `batch_size`, the model inputs are resized to that batch before the
+// interpreter is prepared, so the batched output of RoiToTensorCalculator
+// with NORM_RECTS runs in one Invoke.
+//
+// Inputs:
+//   TENSORS: Vector of kFloat32 Tensor, copied into the model inputs in order.
+// Output:
+//   TENSORS: Vector of kFloat32 Tensor, copies of the model outputs, shaped
+//            like them.
+//
+// Usage example:
+// node {
+//   calculator: "CachedInferenceCalculator"
+//   input_stream: "TENSORS:eye_tensors"
+//   output_stream: "TENSORS:iris_tensors"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.CachedTfLiteInferenceCalculatorOptions] {
+//       model_path: "mediapipe/modules/iris_landmark/iris_landmark.tflite"
+//       batch_size: 2
+//     }
+//   }
+// }
+//
+class CachedInferenceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  prebuilt::InterpreterLease interpreter_;
+};
+
+REGISTER_CALCULATOR(CachedInferenceCalculator);
+
+absl::Status CachedInferenceCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  return absl::OkStatus();
+}
+
+absl::Status CachedInferenceCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  const auto& options =
+      cc->Options<::mediapipe::CachedTfLiteInferenceCalculatorOptions>();
+  RET_CHECK(options.has_model_path()) << "Missing model_path in options.";
+
+  prebuilt::InterpreterKey key;
+  ASSIGN_OR_RETURN(key.model_path, PathToResourceAsFile(options.model_path()));
+  key.num_threads = options.num_threads();
+  key.use_mediapipe_custom_ops = options.use_mediapipe_custom_ops();
+  key.batch_size = options.batch_size();
+  ASSIGN_OR_RETURN(interpreter_,
+                   prebuilt::ModelRegistry::GetInstance().AcquireInterpreter(
+                       key));
+  return absl::OkStatus();
+}
+
+absl::Status CachedInferenceCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kTensorsTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  const auto& input_tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+  RET_CHECK_EQ(input_tensors.size(), interpreter_->inputs().size());
+
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    TfLiteTensor* tensor = interpreter_->tensor(interpreter_->inputs()[i]);
+    RET_CHECK(tensor->type == kTfLiteFloat32 &&
+              input_tensors[i].element_type() ==
+                  Tensor::ElementType::kFloat32);
+    RET_CHECK_EQ(tensor->bytes, input_tensors[i].bytes())
+        << "Input tensor " << i << " does not match the model input size.";
+    auto view = input_tensors[i].GetCpuReadView();
+    std::memcpy(tensor->data.raw, view.buffer<float>(), tensor->bytes);
+  }
+
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+
+  auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+  output_tensors->reserve(interpreter_->outputs().size());
+  for (const int index : interpreter_->outputs()) {
+    const TfLiteTensor* tensor = interpreter_->tensor(index);
+    RET_CHECK_EQ(tensor->type, kTfLiteFloat32);
+    const TfLiteIntArray* dims = tensor->dims;
+    output_tensors->emplace_back(
+        Tensor::ElementType::kFloat32,
+        Tensor::Shape{std::vector<int>(dims->data, dims->data + dims->size)});
+    auto view = output_tensors->back().GetCpuWriteView();
+    std::memcpy(view.buffer<float>(), tensor->data.raw, tensor->bytes);
+  }
+  cc->Outputs()
+      .Tag(kTensorsTag)
+      .Add(output_tensors.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
+absl::Status CachedInferenceCalculator::Close(CalculatorContext* cc) {
+  // Hands the prepared interpreter back to the registry pool.
+  interpreter_ = prebuilt::InterpreterLease();
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,129 @@
+// "common/prebuilt/calculators/cached_tflite_inference_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/cached_tflite_inference_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/model_registry.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/resource_util.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace {
+
+constexpr char kTensorsTag[] = "TENSORS";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Runs a TFLite model on CPU with an interpreter leased from the process-wide
+// ModelRegistry.
+//
+// Drop-in replacement for the CPU path of TfLiteInferenceCalculator. The
+// difference is startup cost: the interpreter (built, with tensors allocated)
+// goes back to the registry when the graph closes, so restarting the graph or
+// creating another graph with the same model and options skips model loading,
+// InterpreterBuilder and AllocateTensors.
+//
+// Inputs:
+//   TENSORS: Vector of TfLiteTensor, copied into the model inputs in order.
+// Output:
+//   TENSORS: Vector of TfLiteTensor referencing the interpreter outputs, valid
+//            until the next Process call.
+//
+// Options:
+//   See cached_tflite_inference_calculator.proto
+//
+// Usage example:
+// node {
+//   calculator: "CachedTfLiteInferenceCalculator"
+//   input_stream: "TENSORS:image_tensor"
+//   output_stream: "TENSORS:bitmap_tensor"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.CachedTfLiteInferenceCalculatorOptions] {
+//       model_path: "path/to/model.tflite"
+//       use_mediapipe_custom_ops: true
+//     }
+//   }
+// }
+//
+class CachedTfLiteInferenceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  prebuilt::InterpreterLease interpreter_;
+};
+
+REGISTER_CALCULATOR(CachedTfLiteInferenceCalculator);
+
+absl::Status CachedTfLiteInferenceCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kTensorsTag).Set<std::vector<TfLiteTensor>>();
+  cc->Outputs().Tag(kTensorsTag).Set<std::vector<TfLiteTensor>>();
+  return absl::OkStatus();
+}
+
+absl::Status CachedTfLiteInferenceCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  const auto& options =
+      cc->Options<::mediapipe::CachedTfLiteInferenceCalculatorOptions>();
+  RET_CHECK(options.has_model_path()) << "Missing model_path in options.";
+
+  prebuilt::InterpreterKey key;
+  ASSIGN_OR_RETURN(key.model_path, PathToResourceAsFile(options.model_path()));
+  key.num_threads = options.num_threads();
+  key.use_mediapipe_custom_ops = options.use_mediapipe_custom_ops();
+  key.batch_size = options.batch_size();
+  ASSIGN_OR_RETURN(interpreter_,
+                   prebuilt::ModelRegistry::GetInstance().AcquireInterpreter(
+                       key));
+  return absl::OkStatus();
+}
+
+absl::Status CachedTfLiteInferenceCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kTensorsTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  const auto& input_tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<TfLiteTensor>>();
+  RET_CHECK_EQ(input_tensors.size(), interpreter_->inputs().size());
+
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    TfLiteTensor* tensor = interpreter_->tensor(interpreter_->inputs()[i]);
+    RET_CHECK_EQ(tensor->bytes, input_tensors[i].bytes)
+        << "Input tensor " << i << " does not match the model input size.";
+    std::memcpy(tensor->data.raw, input_tensors[i].data.raw, tensor->bytes);
+  }
+
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+
+  auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
+  output_tensors->reserve(interpreter_->outputs().size());
+  for (const int index : interpreter_->outputs()) {
+    output_tensors->emplace_back(*interpreter_->tensor(index));
+  }
+  cc->Outputs()
+      .Tag(kTensorsTag)
+      .Add(output_tensors.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
+absl::Status CachedTfLiteInferenceCalculator::Close(CalculatorContext* cc) {
+  // Hands the prepared interpreter back to the registry pool.
+  interpreter_ = prebuilt::InterpreterLease();
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
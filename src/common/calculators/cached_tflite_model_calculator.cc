@@ -0,0 +1,86 @@
+// "common/prebuilt/calculators/cached_tflite_model_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "mediapipe/examples/common/prebuilt/calculators/cached_tflite_model_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/model_registry.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/resource_util.h"
+#include "tensorflow/lite/model.h"
+
+namespace {
+
+constexpr char kModelTag[] = "MODEL";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Same packet type as the MODEL side packet of TfLiteModelCalculator.
+using TfLiteModelPtr =
+    std::unique_ptr<tflite::FlatBufferModel,
+                    std::function<void(tflite::FlatBufferModel*)>>;
+
+// Provides a .tflite model from the process-wide ModelRegistry as a side
+// packet. The file is memory mapped and verified by the first graph that asks
+// for it; every later graph, including restarts of the same graph, gets the
+// already mapped model.
+//
+// Output side packet:
+//   MODEL: TfLiteModelPtr, accepted by the MODEL input side packet of
+//          TfLiteInferenceCalculator and InferenceCalculator.
+//
+// Usage example:
+// node {
+//   calculator: "CachedTfLiteModelCalculator"
+//   output_side_packet: "MODEL:model"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.CachedTfLiteModelCalculatorOptions] {
+//       model_path: "mediapipe/modules/pose_detection/pose_detection.tflite"
+//     }
+//   }
+// }
+//
+class CachedTfLiteModelCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+};
+
+REGISTER_CALCULATOR(CachedTfLiteModelCalculator);
+
+absl::Status CachedTfLiteModelCalculator::GetContract(CalculatorContract* cc) {
+  cc->OutputSidePackets().Tag(kModelTag).Set<TfLiteModelPtr>();
+  return absl::OkStatus();
+}
+
+absl::Status CachedTfLiteModelCalculator::Open(CalculatorContext* cc) {
+  const auto& options =
+      cc->Options<::mediapipe::CachedTfLiteModelCalculatorOptions>();
+  RET_CHECK(options.has_model_path()) << "Missing model_path in options.";
+
+  ASSIGN_OR_RETURN(const std::string model_path,
+                   PathToResourceAsFile(options.model_path()));
+  ASSIGN_OR_RETURN(
+      std::shared_ptr<tflite::FlatBufferModel> model,
+      prebuilt::ModelRegistry::GetInstance().GetModel(model_path));
+
+  // The deleter only drops this graph's reference; the registry keeps the
+  // mapping for the next graph.
+  tflite::FlatBufferModel* raw_model = model.get();
+  cc->OutputSidePackets().Tag(kModelTag).Set(MakePacket<TfLiteModelPtr>(
+      TfLiteModelPtr(raw_model, [model](tflite::FlatBufferModel*) {})));
+  return absl::OkStatus();
+}
+
+absl::Status CachedTfLiteModelCalculator::Process(CalculatorContext* cc) {
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,141 @@
+// "common/prebuilt/calculators/compact_mask_smoothing_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <cmath>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/calculators/compact_mask_smoothing_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/compact_mask.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kMasksTag[] = "MASKS";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Reuses the masks of the previous frame to steady the masks of the current
+// one, like SegmentationSmoothingCalculator, but on the compact masks of
+// several people. Each mask is paired with the previous frame's mask of the
+// same person, found by position and size, and the previous mask is
+// resampled onto it and blended in with weight combine_with_previous_ratio.
+// Masks without a match, e.g. of a person who just appeared, pass through.
+//
+// Inputs:
+//   MASKS: std::vector<prebuilt::CompactMask>, of the people in a frame.
+//
+// Outputs:
+//   MASKS: std::vector<prebuilt::CompactMask>, the blended masks.
+//
+// Usage example:
+// node {
+//   calculator: "CompactMaskSmoothingCalculator"
+//   input_stream: "MASKS:multi_pose_compact_masks"
+//   output_stream: "MASKS:smoothed_multi_pose_compact_masks"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.CompactMaskSmoothingCalculatorOptions] {
+//       combine_with_previous_ratio: 0.7
+//     }
+//   }
+// }
+//
+class CompactMaskSmoothingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // The unused mask of `previous` that best matches `mask`, or -1.
+  int FindPrevious(const prebuilt::CompactMask& mask,
+                   const std::vector<prebuilt::CompactMask>& previous,
+                   const std::vector<bool>& used) const;
+
+  float ratio_ = 0;
+  float max_center_shift_ = 0;
+  float max_size_change_ = 0;
+  // The previous output.
+  Packet previous_;
+};
+
+REGISTER_CALCULATOR(CompactMaskSmoothingCalculator);
+
+absl::Status CompactMaskSmoothingCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kMasksTag).Set<std::vector<prebuilt::CompactMask>>();
+  cc->Outputs().Tag(kMasksTag).Set<std::vector<prebuilt::CompactMask>>();
+  return absl::OkStatus();
+}
+
+absl::Status CompactMaskSmoothingCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  const auto& options =
+      cc->Options<::mediapipe::CompactMaskSmoothingCalculatorOptions>();
+  RET_CHECK(options.combine_with_previous_ratio() >= 0 &&
+            options.combine_with_previous_ratio() <= 1);
+  RET_CHECK_GE(options.max_center_shift(), 0);
+  RET_CHECK_GE(options.max_size_change(), 0);
+  ratio_ = options.combine_with_previous_ratio();
+  max_center_shift_ = options.max_center_shift();
+  max_size_change_ = options.max_size_change();
+  return absl::OkStatus();
+}
+
+absl::Status CompactMaskSmoothingCalculator::Process(CalculatorContext* cc) {
+  const Packet& input = cc->Inputs().Tag(kMasksTag).Value();
+  if (ratio_ == 0 || previous_.IsEmpty()) {
+    previous_ = input;
+    cc->Outputs().Tag(kMasksTag).AddPacket(input);
+    return absl::OkStatus();
+  }
+
+  const auto& previous =
+      previous_.Get<std::vector<prebuilt::CompactMask>>();
+  auto masks = absl::make_unique<std::vector<prebuilt::CompactMask>>(
+      input.Get<std::vector<prebuilt::CompactMask>>());
+  std::vector<bool> used(previous.size(), false);
+  for (auto& mask : *masks) {
+    const int match = FindPrevious(mask, previous, used);
+    if (match < 0) continue;
+    used[match] = true;
+    prebuilt::BlendWithPrevious(previous[match], ratio_, &mask);
+  }
+  previous_ = Adopt(masks.release()).At(cc->InputTimestamp());
+  cc->Outputs().Tag(kMasksTag).AddPacket(previous_);
+  return absl::OkStatus();
+}
+
+int CompactMaskSmoothingCalculator::FindPrevious(
+    const prebuilt::CompactMask& mask,
+    const std::vector<prebuilt::CompactMask>& previous,
+    const std::vector<bool>& used) const {
+  const auto center = prebuilt::MaskCenter(mask);
+  const float size = prebuilt::MaskSize(mask);
+  int best = -1;
+  float best_shift = max_center_shift_;
+  for (int i = 0; i < static_cast<int>(previous.size()); ++i) {
+    const prebuilt::CompactMask& candidate = previous[i];
+    if (used[i] || candidate.image_width != mask.image_width ||
+        candidate.image_height != mask.image_height) {
+      continue;
+    }
+    const float candidate_size = prebuilt::MaskSize(candidate);
+    if (std::abs(candidate_size - size) > max_size_change_ * size) continue;
+    const auto candidate_center = prebuilt::MaskCenter(candidate);
+    const float shift = std::hypot(candidate_center[0] - center[0],
+                                   candidate_center[1] - center[1]) /
+                        size;
+    if (shift <= best_shift) {
+      best = i;
+      best_shift = shift;
+    }
+  }
+  return best;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,131 @@
+// "common/prebuilt/calculators/compact_mask_upsample_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/util/compact_mask.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kMasksTag[] = "MASKS";
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+constexpr char kRegionTag[] = "REGION";
+constexpr char kMaskTag[] = "MASK";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Upsamples the compact masks of the people in a frame into one 8-bit mask
+// at the frame's resolution, or of a region of the frame only. Where people
+// overlap, the larger value wins.
+//
+// With REGION connected the calculator is the consumer's request: it runs
+// only at the timestamps that carry a REGION packet, and upsamples only the
+// pixels inside it, so that a caller needing, say, the mask around a face or
+// one mask a second pays for nothing else.
+//
+// Inputs:
+//   MASKS: std::vector<prebuilt::CompactMask>, of the people in a frame.
+//   IMAGE_SIZE: std::pair<int, int>, the size of the frame.
+//   REGION (optional): NormalizedRect, the part of the frame wanted. Its
+//          rotation is ignored.
+//
+// Outputs:
+//   MASK: A GRAY8 ImageFrame of the frame or the region, 0 where there is
+//         nobody. Nothing is output for a region outside the frame.
+//
+// Usage example:
+// node {
+//   calculator: "CompactMaskUpsampleCalculator"
+//   input_stream: "MASKS:multi_pose_segmentation_masks"
+//   input_stream: "IMAGE_SIZE:image_size"
+//   input_stream: "REGION:mask_request"
+//   output_stream: "MASK:segmentation_mask"
+// }
+//
+class CompactMaskUpsampleCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+};
+
+REGISTER_CALCULATOR(CompactMaskUpsampleCalculator);
+
+absl::Status CompactMaskUpsampleCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kMasksTag).Set<std::vector<prebuilt::CompactMask>>();
+  cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+  if (cc->Inputs().HasTag(kRegionTag)) {
+    cc->Inputs().Tag(kRegionTag).Set<NormalizedRect>();
+  }
+  cc->Outputs().Tag(kMaskTag).Set<ImageFrame>();
+  return absl::OkStatus();
+}
+
+absl::Status CompactMaskUpsampleCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+absl::Status CompactMaskUpsampleCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().HasTag(kRegionTag) &&
+      cc->Inputs().Tag(kRegionTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  if (cc->Inputs().Tag(kImageSizeTag).IsEmpty()) return absl::OkStatus();
+  const auto& image_size =
+      cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+
+  int x = 0;
+  int y = 0;
+  int width = image_size.first;
+  int height = image_size.second;
+  if (cc->Inputs().HasTag(kRegionTag)) {
+    const auto& region = cc->Inputs().Tag(kRegionTag).Get<NormalizedRect>();
+    const int left = std::round(
+        (region.x_center() - region.width() / 2) * image_size.first);
+    const int top = std::round(
+        (region.y_center() - region.height() / 2) * image_size.second);
+    const int right = std::round(
+        (region.x_center() + region.width() / 2) * image_size.first);
+    const int bottom = std::round(
+        (region.y_center() + region.height() / 2) * image_size.second);
+    x = std::max(left, 0);
+    y = std::max(top, 0);
+    width = std::min(right, image_size.first) - x;
+    height = std::min(bottom, image_size.second) - y;
+  }
+  // A region outside the frame holds no pixels.
+  if (width <= 0 || height <= 0) return absl::OkStatus();
+
+  auto output = absl::make_unique<ImageFrame>(
+      ImageFormat::GRAY8, width, height, ImageFrame::kDefaultAlignmentBoundary);
+  output->SetToZero();
+  if (!cc->Inputs().Tag(kMasksTag).IsEmpty()) {
+    for (const auto& mask : cc->Inputs()
+                                .Tag(kMasksTag)
+                                .Get<std::vector<prebuilt::CompactMask>>()) {
+      RET_CHECK(mask.image_width == image_size.first &&
+                mask.image_height == image_size.second)
+          << "The mask belongs to a frame of another size.";
+      prebuilt::UpsampleMask(mask, x, y, width, height,
+                             output->MutablePixelData(), output->WidthStep());
+    }
+  }
+  cc->Outputs().Tag(kMaskTag).Add(output.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,123 @@
+// "common/prebuilt/calculators/compact_segmentation_mask_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/core/end_loop_calculator.h"
+#include "mediapipe/examples/common/prebuilt/util/compact_mask.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kMaskTag[] = "MASK";
+constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+constexpr char kCompactMaskTag[] = "COMPACT_MASK";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Keeps a segmentation mask at the resolution the model produced it in, as
+// an 8-bit prebuilt::CompactMask that knows where it lies in the frame,
+// instead of warping it into a float mask of the frame's size the way
+// PoseLandmarksAndSegmentationInverseProjection does on every frame. The
+// frame-sized mask is made only where a consumer asks for it, see
+// CompactMaskUpsampleCalculator.
+//
+// Inputs:
+//   MASK: An Image on CPU holding a VEC32F1 mask of probabilities, as
+//         TensorsToSegmentationCalculator produces for the ROI.
+//   NORM_RECT: The NormalizedRect the mask was cropped from.
+//   LETTERBOX_PADDING: std::array<float, 4>, the padding ImageToTensor
+//         added around the crop.
+//   IMAGE_SIZE: std::pair<int, int>, the size of the frame.
+//
+// Outputs:
+//   COMPACT_MASK: prebuilt::CompactMask. Nothing is output when no mask
+//         arrives, e.g. with segmentation disabled.
+//
+// Usage example:
+// node {
+//   calculator: "CompactSegmentationMaskCalculator"
+//   input_stream: "MASK:roi_segmentation_mask"
+//   input_stream: "NORM_RECT:roi"
+//   input_stream: "LETTERBOX_PADDING:letterbox_padding"
+//   input_stream: "IMAGE_SIZE:image_size"
+//   output_stream: "COMPACT_MASK:compact_mask"
+// }
+//
+class CompactSegmentationMaskCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+};
+
+REGISTER_CALCULATOR(CompactSegmentationMaskCalculator);
+
+absl::Status CompactSegmentationMaskCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kMaskTag).Set<Image>();
+  cc->Inputs().Tag(kNormRectTag).Set<NormalizedRect>();
+  cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
+  cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+  cc->Outputs().Tag(kCompactMaskTag).Set<prebuilt::CompactMask>();
+  return absl::OkStatus();
+}
+
+absl::Status CompactSegmentationMaskCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+absl::Status CompactSegmentationMaskCalculator::Process(
+    CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kMaskTag).IsEmpty()) return absl::OkStatus();
+  RET_CHECK(!cc->Inputs().Tag(kNormRectTag).IsEmpty());
+  RET_CHECK(!cc->Inputs().Tag(kLetterboxPaddingTag).IsEmpty());
+  RET_CHECK(!cc->Inputs().Tag(kImageSizeTag).IsEmpty());
+
+  const auto& image = cc->Inputs().Tag(kMaskTag).Get<Image>();
+  RET_CHECK(!image.UsesGpu()) << "Only CPU masks are supported.";
+  const std::shared_ptr<ImageFrame> frame = image.GetImageFrameSharedPtr();
+  RET_CHECK(frame->Format() == ImageFormat::VEC32F1)
+      << "Only VEC32F1 masks are supported.";
+
+  auto mask = absl::make_unique<prebuilt::CompactMask>();
+  mask->width = frame->Width();
+  mask->height = frame->Height();
+  mask->values.resize(mask->width * mask->height);
+  prebuilt::QuantizeMask(reinterpret_cast<const float*>(frame->PixelData()),
+                         frame->WidthStep() / sizeof(float), mask->width,
+                         mask->height, mask->values.data());
+
+  const auto& image_size =
+      cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+  if (!prebuilt::SetMaskPlacement(
+          cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>(),
+          cc->Inputs().Tag(kLetterboxPaddingTag).Get<std::array<float, 4>>(),
+          image_size.first, image_size.second, mask.get())) {
+    // An empty ROI covers no pixels.
+    return absl::OkStatus();
+  }
+  cc->Outputs().Tag(kCompactMaskTag).Add(mask.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+// Collects the masks of the people in a frame from a per-person loop.
+typedef EndLoopCalculator<std::vector<prebuilt::CompactMask>>
+    EndLoopCompactMaskCalculator;
+REGISTER_CALCULATOR(EndLoopCompactMaskCalculator);
+
+}  // namespace mediapipe
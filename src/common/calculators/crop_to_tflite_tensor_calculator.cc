@@ -0,0 +1,176 @@
+// "common/prebuilt/calculators/crop_to_tflite_tensor_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/crop_to_tflite_tensor_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace {
+
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kTensorsTag[] = "TENSORS";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Crops an image on CPU and writes it straight into a float image tensor.
+//
+// Replaces ImageCroppingCalculator followed by TfLiteConverterCalculator. The
+// crop is a view into the input frame, and when the crop already has the
+// tensor size the pixels are normalized into the tensor in a single pass, with
+// no intermediate ImageFrame.
+//
+// Inputs:
+//   IMAGE: ImageFrame, SRGB or SRGBA.
+// Output:
+//   TENSORS: Vector holding one kTfLiteFloat32 TfLiteTensor of shape
+//            [tensor_height, tensor_width, tensor_channels].
+//
+// Options:
+//   See crop_to_tflite_tensor_calculator.proto
+//
+// Usage example:
+// node {
+//   calculator: "CropToTfLiteTensorCalculator"
+//   input_stream: "IMAGE:input_video"
+//   output_stream: "TENSORS:image_tensor"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.CropToTfLiteTensorCalculatorOptions] {
+//       tensor_width: 256
+//       tensor_height: 256
+//       crop_width: 256
+//       crop_height: 256
+//     }
+//   }
+// }
+//
+class CropToTfLiteTensorCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  cv::Rect CropRect(int image_width, int image_height) const;
+
+  ::mediapipe::CropToTfLiteTensorCalculatorOptions options_;
+  std::unique_ptr<tflite::Interpreter> interpreter_;
+  // Scratch buffers, reused across frames when resizing or dropping alpha.
+  cv::Mat resized_;
+  cv::Mat converted_;
+};
+
+REGISTER_CALCULATOR(CropToTfLiteTensorCalculator);
+
+absl::Status CropToTfLiteTensorCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
+  cc->Outputs().Tag(kTensorsTag).Set<std::vector<TfLiteTensor>>();
+  return absl::OkStatus();
+}
+
+absl::Status CropToTfLiteTensorCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  options_ = cc->Options<::mediapipe::CropToTfLiteTensorCalculatorOptions>();
+  RET_CHECK_GT(options_.tensor_width(), 0);
+  RET_CHECK_GT(options_.tensor_height(), 0);
+  RET_CHECK(options_.tensor_channels() == 3 || options_.tensor_channels() == 4)
+      << "Only 3 or 4 channel tensors are supported.";
+  RET_CHECK_EQ(options_.crop_width() > 0, options_.crop_height() > 0)
+      << "Set both crop_width and crop_height, or neither.";
+
+  // The interpreter only owns the output tensor, the same way
+  // TfLiteConverterCalculator provides its CPU tensors.
+  interpreter_ = absl::make_unique<tflite::Interpreter>();
+  interpreter_->AddTensors(1);
+  interpreter_->SetInputs({0});
+  interpreter_->SetTensorParametersReadWrite(
+      0, kTfLiteFloat32, "",
+      {options_.tensor_height(), options_.tensor_width(),
+       options_.tensor_channels()},
+      TfLiteQuantization());
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  return absl::OkStatus();
+}
+
+cv::Rect CropToTfLiteTensorCalculator::CropRect(int image_width,
+                                                int image_height) const {
+  int width = options_.crop_width();
+  int height = options_.crop_height();
+  if (width == 0) {
+    // Largest crop with the tensor aspect ratio.
+    width = image_width;
+    height = image_width * options_.tensor_height() / options_.tensor_width();
+    if (height > image_height) {
+      height = image_height;
+      width = image_height * options_.tensor_width() / options_.tensor_height();
+    }
+  }
+  width = std::min(width, image_width);
+  height = std::min(height, image_height);
+
+  const int x =
+      std::round(options_.norm_center_x() * image_width - width / 2.f);
+  const int y =
+      std::round(options_.norm_center_y() * image_height - height / 2.f);
+  return cv::Rect(std::min(std::max(x, 0), image_width - width),
+                  std::min(std::max(y, 0), image_height - height), width,
+                  height);
+}
+
+absl::Status CropToTfLiteTensorCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kImageTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  const auto& input_frame = cc->Inputs().Tag(kImageTag).Get<ImageFrame>();
+  const cv::Mat image = formats::MatView(&input_frame);
+  RET_CHECK(image.channels() == 3 || image.channels() == 4)
+      << "Only SRGB and SRGBA images are supported.";
+
+  const int width = options_.tensor_width();
+  const int height = options_.tensor_height();
+  const int channels = options_.tensor_channels();
+
+  cv::Mat source = image(CropRect(image.cols, image.rows));
+  if (source.cols != width || source.rows != height) {
+    cv::resize(source, resized_, cv::Size(width, height), 0, 0,
+               cv::INTER_AREA);
+    source = resized_;
+  }
+  if (source.channels() != channels) {
+    cv::cvtColor(source, converted_,
+                 channels == 3 ? cv::COLOR_RGBA2RGB : cv::COLOR_RGB2RGBA);
+    source = converted_;
+  }
+
+  TfLiteTensor* tensor = interpreter_->tensor(interpreter_->inputs()[0]);
+  cv::Mat tensor_mat(height, width, CV_32FC(channels), tensor->data.f);
+  if (options_.zero_center()) {
+    source.convertTo(tensor_mat, CV_32F, 2.0 / 255.0, -1.0);
+  } else {
+    source.convertTo(tensor_mat, CV_32F, 1.0 / 255.0);
+  }
+
+  auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
+  output_tensors->emplace_back(*tensor);
+  cc->Outputs()
+      .Tag(kTensorsTag)
+      .Add(output_tensors.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,277 @@
+// "common/prebuilt/calculators/deadline_admission_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <algorithm>
+#include <deque>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/calculators/deadline_admission_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kFinishedTag[] = "FINISHED";
+constexpr char kAllowTag[] = "ALLOW";
+
+}  // namespace
+
+namespace mediapipe {
+
+// A drop-in replacement for FlowLimiterCalculator that admits a frame only
+// when it is expected to come back on FINISHED within a deadline, rather than
+// whenever fewer than a fixed number of frames are in flight.
+//
+// The calculator keeps running estimates of the time from admission to
+// FINISHED and of the interval between FINISHED packets while the graph is
+// busy. A frame that arrives while other frames are in flight is expected to
+// finish one interval after the last admitted frame, or one latency after
+// now, whichever is later. It is admitted when that is within deadline_ms of
+// its arrival and fewer than max_in_flight frames are in flight.
+//
+// Otherwise the frame waits until the next FINISHED packet, and is dropped as
+// soon as a newer frame arrives or it can no longer make the deadline, so the
+// newest frame is always the one admitted next. A frame arriving at an idle
+// graph is always admitted, which keeps the estimates current even when the
+// graph is slower than the deadline.
+//
+// Admitted, dropped and late frames are counted in the graph counters
+// "<node> admitted", "<node> dropped" and "<node> late", and logged on Close.
+// A frame is late when it finishes after its deadline, or when it never
+// finishes within in_flight_timeout_ms.
+//
+// Inputs:
+//   An untagged stream of frames of any type.
+//   FINISHED: Any packet, back edge from the graph output. Its timestamp
+//             marks the frame as finished; earlier frames still in flight
+//             are taken as dropped downstream.
+//
+// Outputs:
+//   An untagged stream with the admitted frames.
+//   ALLOW (optional): bool, whether each input frame was admitted, at the
+//             frame's timestamp.
+//
+// Usage example:
+// node {
+//   calculator: "DeadlineAdmissionCalculator"
+//   input_stream: "input_video"
+//   input_stream: "FINISHED:output_video"
+//   input_stream_info: {
+//     tag_index: "FINISHED"
+//     back_edge: true
+//   }
+//   output_stream: "throttled_input_video"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.DeadlineAdmissionCalculatorOptions] {
+//       deadline_ms: 100
+//     }
+//   }
+// }
+//
+class DeadlineAdmissionCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  struct InFlightFrame {
+    Timestamp timestamp;
+    absl::Time arrival;
+    absl::Time admission;
+  };
+
+  // Retires the frames finished by a FINISHED packet at `timestamp`.
+  void Finish(Timestamp timestamp, absl::Time now, CalculatorContext* cc);
+  // Gives up on frames that have been in flight for too long.
+  void ExpireInFlight(absl::Time now, CalculatorContext* cc);
+  // When a frame admitted at `now` is expected to finish.
+  absl::Time PredictCompletion(absl::Time now) const;
+  // Admits, drops or keeps waiting the pending frame.
+  void Decide(absl::Time now, CalculatorContext* cc);
+  void Admit(absl::Time now, CalculatorContext* cc);
+  void Drop(CalculatorContext* cc);
+  // Moves `estimate` towards `sample`, or starts it there.
+  void Smooth(absl::Duration sample, bool* has_estimate,
+              absl::Duration* estimate) const;
+
+  absl::Duration deadline_;
+  absl::Duration in_flight_timeout_;
+  int max_in_flight_ = 0;
+  double smoothing_ = 0;
+
+  std::deque<InFlightFrame> in_flight_;
+  // The newest frame not yet admitted or dropped.
+  Packet pending_;
+  absl::Time pending_arrival_;
+
+  absl::Duration latency_ = absl::ZeroDuration();
+  absl::Duration interval_ = absl::ZeroDuration();
+  bool has_latency_ = false;
+  bool has_interval_ = false;
+  absl::Time last_finish_ = absl::InfinitePast();
+  // Expected completion of the newest admitted frame.
+  absl::Time last_completion_ = absl::InfinitePast();
+
+  int64 admitted_ = 0;
+  int64 dropped_ = 0;
+  int64 late_ = 0;
+};
+
+REGISTER_CALCULATOR(DeadlineAdmissionCalculator);
+
+absl::Status DeadlineAdmissionCalculator::GetContract(CalculatorContract* cc) {
+  RET_CHECK_EQ(cc->Inputs().NumEntries(""), 1);
+  RET_CHECK_EQ(cc->Outputs().NumEntries(""), 1);
+  cc->Inputs().Index(0).SetAny();
+  cc->Inputs().Tag(kFinishedTag).SetAny();
+  cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+  if (cc->Outputs().HasTag(kAllowTag)) {
+    cc->Outputs().Tag(kAllowTag).Set<bool>();
+  }
+  // Frames and FINISHED packets are handled as they arrive; the back edge
+  // never lines up with the input timestamps.
+  cc->SetInputStreamHandler("ImmediateInputStreamHandler");
+  return absl::OkStatus();
+}
+
+absl::Status DeadlineAdmissionCalculator::Open(CalculatorContext* cc) {
+  const auto& options =
+      cc->Options<::mediapipe::DeadlineAdmissionCalculatorOptions>();
+  RET_CHECK_GT(options.deadline_ms(), 0);
+  RET_CHECK_GT(options.max_in_flight(), 0);
+  RET_CHECK(options.smoothing() > 0 && options.smoothing() <= 1);
+  deadline_ = absl::Milliseconds(options.deadline_ms());
+  in_flight_timeout_ = options.in_flight_timeout_ms() > 0
+                           ? absl::Milliseconds(options.in_flight_timeout_ms())
+                           : absl::InfiniteDuration();
+  max_in_flight_ = options.max_in_flight();
+  smoothing_ = options.smoothing();
+  return absl::OkStatus();
+}
+
+absl::Status DeadlineAdmissionCalculator::Process(CalculatorContext* cc) {
+  const absl::Time now = absl::Now();
+  const auto& finished = cc->Inputs().Tag(kFinishedTag);
+  if (!finished.IsEmpty()) Finish(finished.Value().Timestamp(), now, cc);
+  ExpireInFlight(now, cc);
+
+  const auto& input = cc->Inputs().Index(0);
+  if (!input.IsEmpty()) {
+    // The newest frame replaces any frame still waiting.
+    if (!pending_.IsEmpty()) Drop(cc);
+    pending_ = input.Value();
+    pending_arrival_ = now;
+  }
+  if (!pending_.IsEmpty()) Decide(now, cc);
+  return absl::OkStatus();
+}
+
+absl::Status DeadlineAdmissionCalculator::Close(CalculatorContext* cc) {
+  if (!pending_.IsEmpty()) Drop(cc);
+  LOG(INFO) << cc->NodeName() << ": admitted " << admitted_ << " frames, "
+            << "dropped " << dropped_ << ", " << late_ << " finished late. "
+            << "Latency estimate " << absl::ToDoubleMilliseconds(latency_)
+            << " ms, interval estimate "
+            << absl::ToDoubleMilliseconds(interval_) << " ms.";
+  return absl::OkStatus();
+}
+
+void DeadlineAdmissionCalculator::Finish(Timestamp timestamp, absl::Time now,
+                                         CalculatorContext* cc) {
+  bool busy = false;
+  while (!in_flight_.empty() && in_flight_.front().timestamp <= timestamp) {
+    const InFlightFrame frame = in_flight_.front();
+    in_flight_.pop_front();
+    if (frame.timestamp != timestamp) continue;  // Dropped downstream.
+
+    Smooth(now - frame.admission, &has_latency_, &latency_);
+    // A frame admitted before the previous one finished queued behind it,
+    // so the gap between the two is the time the graph takes per frame.
+    busy = frame.admission < last_finish_;
+    if (now - frame.arrival > deadline_) {
+      ++late_;
+      cc->GetCounter(absl::StrCat(cc->NodeName(), " late"))->Increment();
+    }
+  }
+  if (busy) Smooth(now - last_finish_, &has_interval_, &interval_);
+  last_finish_ = now;
+}
+
+void DeadlineAdmissionCalculator::ExpireInFlight(absl::Time now,
+                                                 CalculatorContext* cc) {
+  while (!in_flight_.empty() &&
+         now - in_flight_.front().admission > in_flight_timeout_) {
+    in_flight_.pop_front();
+    ++late_;
+    cc->GetCounter(absl::StrCat(cc->NodeName(), " late"))->Increment();
+  }
+}
+
+absl::Time DeadlineAdmissionCalculator::PredictCompletion(
+    absl::Time now) const {
+  absl::Time completion = now + latency_;
+  if (!in_flight_.empty()) {
+    completion = std::max(completion, last_completion_ + interval_);
+  }
+  return completion;
+}
+
+void DeadlineAdmissionCalculator::Decide(absl::Time now,
+                                         CalculatorContext* cc) {
+  if (in_flight_.empty()) {
+    Admit(now, cc);
+    return;
+  }
+  if (static_cast<int>(in_flight_.size()) < max_in_flight_ &&
+      PredictCompletion(now) - pending_arrival_ <= deadline_) {
+    Admit(now, cc);
+    return;
+  }
+  // Even an idle graph would finish this frame too late.
+  if (has_latency_ && now + latency_ - pending_arrival_ > deadline_) {
+    Drop(cc);
+  }
+}
+
+void DeadlineAdmissionCalculator::Admit(absl::Time now,
+                                        CalculatorContext* cc) {
+  const Timestamp timestamp = pending_.Timestamp();
+  last_completion_ = PredictCompletion(now);
+  in_flight_.push_back({timestamp, pending_arrival_, now});
+  cc->Outputs().Index(0).AddPacket(pending_);
+  if (cc->Outputs().HasTag(kAllowTag)) {
+    cc->Outputs().Tag(kAllowTag).AddPacket(
+        MakePacket<bool>(true).At(timestamp));
+  }
+  pending_ = Packet();
+  ++admitted_;
+  cc->GetCounter(absl::StrCat(cc->NodeName(), " admitted"))->Increment();
+}
+
+void DeadlineAdmissionCalculator::Drop(CalculatorContext* cc) {
+  const Timestamp timestamp = pending_.Timestamp();
+  cc->Outputs().Index(0).SetNextTimestampBound(
+      timestamp.NextAllowedInStream());
+  if (cc->Outputs().HasTag(kAllowTag)) {
+    cc->Outputs().Tag(kAllowTag).AddPacket(
+        MakePacket<bool>(false).At(timestamp));
+  }
+  pending_ = Packet();
+  ++dropped_;
+  cc->GetCounter(absl::StrCat(cc->NodeName(), " dropped"))->Increment();
+}
+
+void DeadlineAdmissionCalculator::Smooth(absl::Duration sample,
+                                         bool* has_estimate,
+                                         absl::Duration* estimate) const {
+  *estimate = *has_estimate ? *estimate + (sample - *estimate) * smoothing_
+                            : sample;
+  *has_estimate = true;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,191 @@
+// "common/prebuilt/calculators/face_landmarks_to_eye_rois_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/calculators/face_landmarks_to_eye_rois_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
+
+// Face mesh indices of the eye corners, outer corner first, as split off for
+// IrisLandmarkLeftAndRightCpu.
+constexpr int kEyeCorners[2][2] = {{33, 133}, {362, 263}};
+
+constexpr float kPi = 3.14159265358979f;
+
+float NormalizeRadians(float angle) {
+  return angle - 2 * kPi * std::floor((angle + kPi) / (2 * kPi));
+}
+
+// Corner `corner`, 0 to 3, of `rect` in pixels.
+std::pair<float, float> Corner(const mediapipe::NormalizedRect& rect,
+                               int corner, int width, int height) {
+  const float x = (corner & 1 ? 0.5f : -0.5f) * rect.width() * width;
+  const float y = (corner & 2 ? 0.5f : -0.5f) * rect.height() * height;
+  const float cosine = std::cos(rect.rotation());
+  const float sine = std::sin(rect.rotation());
+  return {rect.x_center() * width + cosine * x - sine * y,
+          rect.y_center() * height + sine * x + cosine * y};
+}
+
+// The largest distance, in pixels, between corresponding corners of `a` and
+// `b`, which covers shift, resizing and rotation alike.
+float CornerShift(const mediapipe::NormalizedRect& a,
+                  const mediapipe::NormalizedRect& b, int width, int height) {
+  float shift = 0;
+  for (int corner = 0; corner < 4; ++corner) {
+    const auto from = Corner(a, corner, width, height);
+    const auto to = Corner(b, corner, width, height);
+    shift = std::max(
+        shift, std::hypot(to.first - from.first, to.second - from.second));
+  }
+  return shift;
+}
+
+}  // namespace
+
+namespace mediapipe {
+
+// Derives the ROIs of both eyes for the iris model from the face mesh of the
+// same frame, left eye first, in one node.
+//
+// Replaces the two IrisLandmarkLandmarksToRoi subgraphs of
+// IrisLandmarkLeftAndRightCpu and computes the same ROIs: the box around the
+// two eye corners, turned so the corners lie level, squared on its longer
+// side and scaled by roi_scale. The output feeds RoiToTensorCalculator with
+// NORM_RECTS, which crops both eyes into one batch.
+//
+// An eye whose ROI moved less than reuse_threshold since the previous frame
+// keeps the previous ROI. The iris model then sees the eye in the same place
+// of its input from frame to frame, which steadies the landmarks of a still
+// eye; the pixels are still sampled anew, since the iris moves within a
+// still eye.
+//
+// Inputs:
+//   LANDMARKS: NormalizedLandmarkList, the face mesh of one face.
+//   IMAGE_SIZE: std::pair<int, int>, width and height of the image.
+//
+// Outputs:
+//   NORM_RECTS: std::vector<NormalizedRect>, the ROIs of the left and the
+//               right eye.
+//
+// Usage example:
+// node {
+//   calculator: "FaceLandmarksToEyeRoisCalculator"
+//   input_stream: "LANDMARKS:face_landmarks"
+//   input_stream: "IMAGE_SIZE:image_size"
+//   output_stream: "NORM_RECTS:eye_rois"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.FaceLandmarksToEyeRoisCalculatorOptions] {
+//       reuse_threshold: 0.05
+//     }
+//   }
+// }
+//
+class FaceLandmarksToEyeRoisCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // The ROI of the eye with `corners` in `landmarks`.
+  NormalizedRect EyeRoi(const NormalizedLandmarkList& landmarks,
+                        const int corners[2], int width, int height) const;
+
+  ::mediapipe::FaceLandmarksToEyeRoisCalculatorOptions options_;
+  // ROIs of the previous frame and the image size they were derived for;
+  // empty when there were no landmarks.
+  std::vector<NormalizedRect> previous_;
+  std::pair<int, int> previous_size_;
+};
+
+REGISTER_CALCULATOR(FaceLandmarksToEyeRoisCalculator);
+
+absl::Status FaceLandmarksToEyeRoisCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kLandmarksTag).Set<NormalizedLandmarkList>();
+  cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+  cc->Outputs().Tag(kNormRectsTag).Set<std::vector<NormalizedRect>>();
+  return absl::OkStatus();
+}
+
+absl::Status FaceLandmarksToEyeRoisCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ =
+      cc->Options<::mediapipe::FaceLandmarksToEyeRoisCalculatorOptions>();
+  RET_CHECK_GT(options_.roi_scale(), 0);
+  RET_CHECK_GE(options_.reuse_threshold(), 0);
+  return absl::OkStatus();
+}
+
+NormalizedRect FaceLandmarksToEyeRoisCalculator::EyeRoi(
+    const NormalizedLandmarkList& landmarks, const int corners[2], int width,
+    int height) const {
+  const auto& outer = landmarks.landmark(corners[0]);
+  const auto& inner = landmarks.landmark(corners[1]);
+  const float x_min = std::min(outer.x(), inner.x());
+  const float x_max = std::max(outer.x(), inner.x());
+  const float y_min = std::min(outer.y(), inner.y());
+  const float y_max = std::max(outer.y(), inner.y());
+  const float side = std::max((x_max - x_min) * width,
+                              (y_max - y_min) * height) *
+                     options_.roi_scale();
+
+  NormalizedRect roi;
+  roi.set_x_center((x_min + x_max) / 2);
+  roi.set_y_center((y_min + y_max) / 2);
+  roi.set_width(side / width);
+  roi.set_height(side / height);
+  roi.set_rotation(NormalizeRadians(-std::atan2(
+      -(inner.y() - outer.y()) * height, (inner.x() - outer.x()) * width)));
+  return roi;
+}
+
+absl::Status FaceLandmarksToEyeRoisCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kLandmarksTag).IsEmpty() ||
+      cc->Inputs().Tag(kImageSizeTag).IsEmpty()) {
+    previous_.clear();
+    return absl::OkStatus();
+  }
+  const auto& landmarks =
+      cc->Inputs().Tag(kLandmarksTag).Get<NormalizedLandmarkList>();
+  const auto& size =
+      cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+  RET_CHECK_GT(landmarks.landmark_size(), kEyeCorners[1][0])
+      << "Expected the landmarks of the face mesh.";
+  const int width = size.first;
+  const int height = size.second;
+
+  if (size != previous_size_) previous_.clear();
+  auto rois = absl::make_unique<std::vector<NormalizedRect>>();
+  for (int eye = 0; eye < 2; ++eye) {
+    NormalizedRect roi = EyeRoi(landmarks, kEyeCorners[eye], width, height);
+    if (!previous_.empty() &&
+        CornerShift(roi, previous_[eye], width, height) <
+            options_.reuse_threshold() * roi.width() * width) {
+      roi = previous_[eye];
+    }
+    rois->push_back(roi);
+  }
+  previous_ = *rois;
+  previous_size_ = size;
+
+  cc->Outputs().Tag(kNormRectsTag).Add(rois.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
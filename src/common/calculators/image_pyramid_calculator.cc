@@ -0,0 +1,101 @@
+// "common/prebuilt/calculators/image_pyramid_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/calculators/image_pyramid_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/image_pyramid.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kPyramidTag[] = "PYRAMID";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Wraps a frame in a prebuilt::ImagePyramid, for the models of a graph to
+// take their inputs from with RoiToTensorCalculator. The frame is converted
+// to RGB once here, rather than once per model, and the halved levels are
+// built the first time a model asks for them.
+//
+// An SRGB frame becomes level 0 without a copy; the alpha of an SRGBA frame
+// is dropped into a new RGB image.
+//
+// Inputs:
+//   IMAGE: ImageFrame, SRGB or SRGBA.
+//
+// Outputs:
+//   PYRAMID: prebuilt::ImagePyramid.
+//
+// Usage example:
+// node {
+//   calculator: "ImagePyramidCalculator"
+//   input_stream: "IMAGE:input_video"
+//   output_stream: "PYRAMID:pyramid"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.ImagePyramidCalculatorOptions] {
+//       min_level_size: 128
+//     }
+//   }
+// }
+//
+class ImagePyramidCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  int min_level_size_ = 0;
+};
+
+REGISTER_CALCULATOR(ImagePyramidCalculator);
+
+absl::Status ImagePyramidCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
+  cc->Outputs().Tag(kPyramidTag).Set<prebuilt::ImagePyramid>();
+  return absl::OkStatus();
+}
+
+absl::Status ImagePyramidCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  min_level_size_ =
+      cc->Options<::mediapipe::ImagePyramidCalculatorOptions>()
+          .min_level_size();
+  RET_CHECK_GT(min_level_size_, 0);
+  return absl::OkStatus();
+}
+
+absl::Status ImagePyramidCalculator::Process(CalculatorContext* cc) {
+  const Packet& packet = cc->Inputs().Tag(kImageTag).Value();
+  const auto& frame = packet.Get<ImageFrame>();
+  RET_CHECK(frame.Format() == ImageFormat::SRGB ||
+            frame.Format() == ImageFormat::SRGBA)
+      << "Only SRGB and SRGBA frames are supported.";
+
+  std::unique_ptr<prebuilt::ImagePyramid> pyramid;
+  if (frame.Format() == ImageFormat::SRGB) {
+    pyramid = absl::make_unique<prebuilt::ImagePyramid>(
+        formats::MatView(&frame), SharedPtrWithPacket<ImageFrame>(packet),
+        min_level_size_);
+  } else {
+    auto rgb = std::make_shared<cv::Mat>();
+    cv::cvtColor(formats::MatView(&frame), *rgb, cv::COLOR_RGBA2RGB);
+    pyramid = absl::make_unique<prebuilt::ImagePyramid>(*rgb, rgb,
+                                                        min_level_size_);
+  }
+  cc->Outputs().Tag(kPyramidTag).Add(pyramid.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,146 @@
+// "common/prebuilt/calculators/iris_tensors_to_landmarks_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kMatrixTag[] = "MATRIX";
+constexpr char kIrisLandmarksTag[] = "IRIS_LANDMARKS";
+constexpr char kEyeContourLandmarksTag[] = "EYE_CONTOUR_LANDMARKS";
+
+// Input side of the iris model, in pixels.
+constexpr float kInputSize = 64.f;
+// Landmarks per eye of the two model outputs.
+constexpr int kNumEyeContourLandmarks = 71;
+constexpr int kNumIrisLandmarks = 5;
+
+// Appends the `count` landmarks of each eye in `tensor` to `landmarks`,
+// projected through the eye's matrix.
+absl::Status AppendLandmarks(const mediapipe::Tensor& tensor, int count,
+                             const std::vector<std::array<float, 16>>& matrices,
+                             mediapipe::NormalizedLandmarkList* landmarks) {
+  const int batch = matrices.size();
+  RET_CHECK(tensor.element_type() == mediapipe::Tensor::ElementType::kFloat32);
+  RET_CHECK_EQ(tensor.shape().num_elements(), batch * count * 3)
+      << "Expected " << count << " landmarks for each of " << batch
+      << " eyes.";
+  auto view = tensor.GetCpuReadView();
+  const float* values = view.buffer<float>();
+  for (int eye = 0; eye < batch; ++eye) {
+    const auto& m = matrices[eye];
+    const float roi_width = std::hypot(m[0], m[1]);
+    for (int i = 0; i < count; ++i) {
+      const float* value = values + (eye * count + i) * 3;
+      const float u = value[0] / kInputSize;
+      const float v = value[1] / kInputSize;
+      auto* landmark = landmarks->add_landmark();
+      landmark->set_x(m[0] * u + m[1] * v + m[3]);
+      landmark->set_y(m[4] * u + m[5] * v + m[7]);
+      landmark->set_z(value[2] / kInputSize * roi_width);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+namespace mediapipe {
+
+// Decodes the output of the iris model run on a batch of eyes, as cropped by
+// RoiToTensorCalculator with NORM_RECTS, into landmarks of the image.
+//
+// Does for every eye of the batch what the TensorsToLandmarksCalculator,
+// LandmarkLetterboxRemovalCalculator and LandmarkProjectionCalculator nodes
+// of IrisLandmarkCpu do for one. The landmarks go through the MATRIX of
+// RoiToTensorCalculator, so an eye that was cropped mirrored comes out the
+// right way round. The depth is scaled by the ROI width, as in
+// LandmarkProjectionCalculator; the ROIs are square in pixels, as eye ROIs
+// are, so the width is the length of either axis of the matrix.
+//
+// Inputs:
+//   TENSORS: Vector of kFloat32 Tensor, the eye contour output of shape
+//            [batch, 213] then the iris output of shape [batch, 15].
+//   MATRIX: std::vector<std::array<float, 16>>, one per eye of the batch.
+//
+// Outputs:
+//   IRIS_LANDMARKS: NormalizedLandmarkList, the 5 iris landmarks of each eye,
+//                   in batch order.
+//   EYE_CONTOUR_LANDMARKS (optional): NormalizedLandmarkList, the 71 eye
+//                   contour landmarks of each eye, in batch order.
+//
+// Usage example:
+// node {
+//   calculator: "IrisTensorsToLandmarksCalculator"
+//   input_stream: "TENSORS:iris_tensors"
+//   input_stream: "MATRIX:eye_matrices"
+//   output_stream: "IRIS_LANDMARKS:iris_landmarks"
+//   output_stream: "EYE_CONTOUR_LANDMARKS:eye_contour_landmarks"
+// }
+//
+class IrisTensorsToLandmarksCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+};
+
+REGISTER_CALCULATOR(IrisTensorsToLandmarksCalculator);
+
+absl::Status IrisTensorsToLandmarksCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  cc->Inputs().Tag(kMatrixTag).Set<std::vector<std::array<float, 16>>>();
+  cc->Outputs().Tag(kIrisLandmarksTag).Set<NormalizedLandmarkList>();
+  if (cc->Outputs().HasTag(kEyeContourLandmarksTag)) {
+    cc->Outputs().Tag(kEyeContourLandmarksTag).Set<NormalizedLandmarkList>();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IrisTensorsToLandmarksCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+absl::Status IrisTensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kTensorsTag).IsEmpty() ||
+      cc->Inputs().Tag(kMatrixTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const auto& tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+  const auto& matrices =
+      cc->Inputs().Tag(kMatrixTag).Get<std::vector<std::array<float, 16>>>();
+  RET_CHECK_EQ(tensors.size(), 2)
+      << "Expected the eye contour and iris outputs of the iris model.";
+
+  auto iris_landmarks = absl::make_unique<NormalizedLandmarkList>();
+  MP_RETURN_IF_ERROR(AppendLandmarks(tensors[1], kNumIrisLandmarks, matrices,
+                                     iris_landmarks.get()));
+  cc->Outputs()
+      .Tag(kIrisLandmarksTag)
+      .Add(iris_landmarks.release(), cc->InputTimestamp());
+
+  if (cc->Outputs().HasTag(kEyeContourLandmarksTag)) {
+    auto contour_landmarks = absl::make_unique<NormalizedLandmarkList>();
+    MP_RETURN_IF_ERROR(AppendLandmarks(tensors[0], kNumEyeContourLandmarks,
+                                       matrices, contour_landmarks.get()));
+    cc->Outputs()
+        .Tag(kEyeContourLandmarksTag)
+        .Add(contour_landmarks.release(), cc->InputTimestamp());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,71 @@
+// "common/prebuilt/calculators/luma_sobel_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/util/luma_sobel.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+// Sobel edge detection on CPU: the luminance conversion of
+// LuminanceCalculator and the 3x3 Sobel of SobelEdgesCalculator in one pass
+// over the frame, with no luminance frame in between. See LumaSobelFilter.
+//
+// Inputs:
+//   An ImageFrame, SRGB or SRGBA.
+//
+// Outputs:
+//   An ImageFrame of the same size and format holding the gradient
+//   magnitude of the luminance in every color channel, with opaque alpha.
+//
+// Usage example:
+// node {
+//   calculator: "LumaSobelCalculator"
+//   input_stream: "input_video"
+//   output_stream: "output_video"
+// }
+//
+class LumaSobelCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  prebuilt::LumaSobelFilter filter_;
+};
+
+REGISTER_CALCULATOR(LumaSobelCalculator);
+
+absl::Status LumaSobelCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Index(0).Set<ImageFrame>();
+  cc->Outputs().Index(0).Set<ImageFrame>();
+  return absl::OkStatus();
+}
+
+absl::Status LumaSobelCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+absl::Status LumaSobelCalculator::Process(CalculatorContext* cc) {
+  const auto& input = cc->Inputs().Index(0).Get<ImageFrame>();
+  RET_CHECK(input.Format() == ImageFormat::SRGB ||
+            input.Format() == ImageFormat::SRGBA)
+      << "Only SRGB and SRGBA frames are supported.";
+
+  auto output = absl::make_unique<ImageFrame>(
+      input.Format(), input.Width(), input.Height(),
+      ImageFrame::kDefaultAlignmentBoundary);
+  filter_.Apply(input.PixelData(), input.WidthStep(), input.NumberOfChannels(),
+                input.Width(), input.Height(), output->MutablePixelData(),
+                output->WidthStep(), output->NumberOfChannels());
+  cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,177 @@
+// "common/prebuilt/calculators/multi_face_geometry_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/calculators/multi_face_geometry_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/face_geometry_solver.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/modules/face_geometry/protos/environment.pb.h"
+#include "mediapipe/modules/face_geometry/protos/face_geometry.pb.h"
+#include "mediapipe/modules/face_geometry/protos/geometry_pipeline_metadata.pb.h"
+#include "mediapipe/util/resource_util.h"
+
+namespace {
+
+constexpr char kEnvironmentTag[] = "ENVIRONMENT";
+constexpr char kNumFacesTag[] = "NUM_FACES";
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+constexpr char kMultiFaceLandmarksTag[] = "MULTI_FACE_LANDMARKS";
+constexpr char kMultiFaceGeometryTag[] = "MULTI_FACE_GEOMETRY";
+
+// Canonical mesh vertices are x, y, z, u, v.
+constexpr int kVertexSize = 5;
+
+}  // namespace
+
+namespace mediapipe {
+
+// Estimates face geometry for every face in a frame in one call. A drop-in
+// replacement for FaceGeometryPipelineCalculator, with the same inputs and
+// outputs, built on FaceGeometrySolver: the canonical face is prepared once
+// in Open, and the Procrustes fits of all faces run on workspaces kept across
+// frames, so that only the output protos are allocated per frame.
+//
+// Inputs:
+//   IMAGE_SIZE: std::pair<int, int> of the frame width and height.
+//   MULTI_FACE_LANDMARKS: std::vector<NormalizedLandmarkList>, from the face
+//                         landmark pipeline without attention.
+//
+// Input side packets:
+//   ENVIRONMENT: face_geometry::Environment.
+//   NUM_FACES (optional): int, the most faces expected per frame. Sizes the
+//                         workspaces up front; without it they grow to the
+//                         largest frame seen.
+//
+// Outputs:
+//   MULTI_FACE_GEOMETRY: std::vector<face_geometry::FaceGeometry>, one per
+//                        face whose landmarks could be fitted.
+//
+// Usage example:
+// node {
+//   calculator: "MultiFaceGeometryCalculator"
+//   input_side_packet: "ENVIRONMENT:environment"
+//   input_side_packet: "NUM_FACES:num_faces"
+//   input_stream: "IMAGE_SIZE:input_image_size"
+//   input_stream: "MULTI_FACE_LANDMARKS:multi_face_landmarks"
+//   output_stream: "MULTI_FACE_GEOMETRY:multi_face_geometry"
+//   options: {
+//     [mediapipe.MultiFaceGeometryCalculatorOptions.ext] {
+//       metadata_path: "mediapipe/modules/face_geometry/data/geometry_pipeline_metadata_landmarks.binarypb"
+//     }
+//   }
+// }
+//
+class MultiFaceGeometryCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  std::unique_ptr<prebuilt::FaceGeometrySolver> solver_;
+  face_geometry::Mesh3d canonical_mesh_;
+};
+
+REGISTER_CALCULATOR(MultiFaceGeometryCalculator);
+
+absl::Status MultiFaceGeometryCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->InputSidePackets().Tag(kEnvironmentTag).Set<face_geometry::Environment>();
+  if (cc->InputSidePackets().HasTag(kNumFacesTag)) {
+    cc->InputSidePackets().Tag(kNumFacesTag).Set<int>();
+  }
+  cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+  cc->Inputs()
+      .Tag(kMultiFaceLandmarksTag)
+      .Set<std::vector<NormalizedLandmarkList>>();
+  cc->Outputs()
+      .Tag(kMultiFaceGeometryTag)
+      .Set<std::vector<face_geometry::FaceGeometry>>();
+  return absl::OkStatus();
+}
+
+absl::Status MultiFaceGeometryCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  const auto& options =
+      cc->Options<::mediapipe::MultiFaceGeometryCalculatorOptions>();
+  RET_CHECK(options.has_metadata_path()) << "Missing metadata_path in options.";
+  ASSIGN_OR_RETURN(const std::string metadata_path,
+                   PathToResourceAsFile(options.metadata_path()));
+  std::string metadata_blob;
+  MP_RETURN_IF_ERROR(file::GetContents(metadata_path, &metadata_blob));
+  face_geometry::GeometryPipelineMetadata metadata;
+  RET_CHECK(metadata.ParseFromString(metadata_blob))
+      << "Failed to parse the geometry pipeline metadata.";
+
+  ASSIGN_OR_RETURN(
+      prebuilt::FaceGeometrySolver solver,
+      prebuilt::FaceGeometrySolver::Create(
+          cc->InputSidePackets()
+              .Tag(kEnvironmentTag)
+              .Get<face_geometry::Environment>(),
+          metadata));
+  solver_ = absl::make_unique<prebuilt::FaceGeometrySolver>(std::move(solver));
+  if (cc->InputSidePackets().HasTag(kNumFacesTag)) {
+    solver_->Reserve(cc->InputSidePackets().Tag(kNumFacesTag).Get<int>());
+  }
+  canonical_mesh_ = metadata.canonical_mesh();
+  return absl::OkStatus();
+}
+
+absl::Status MultiFaceGeometryCalculator::Process(CalculatorContext* cc) {
+  // Both inputs are needed; faces were not found in this frame otherwise.
+  if (cc->Inputs().Tag(kMultiFaceLandmarksTag).IsEmpty() ||
+      cc->Inputs().Tag(kImageSizeTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const auto& multi_face_landmarks =
+      cc->Inputs()
+          .Tag(kMultiFaceLandmarksTag)
+          .Get<std::vector<NormalizedLandmarkList>>();
+  const auto& image_size =
+      cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+  MP_RETURN_IF_ERROR(solver_->Solve(multi_face_landmarks, image_size.first,
+                                    image_size.second));
+
+  auto multi_face_geometry =
+      absl::make_unique<std::vector<face_geometry::FaceGeometry>>(
+          solver_->num_faces());
+  for (int i = 0; i < solver_->num_faces(); ++i) {
+    const auto& face = solver_->face(i);
+    auto& face_geometry = (*multi_face_geometry)[i];
+
+    // The canonical mesh with its positions moved to the metric landmarks.
+    auto* mesh = face_geometry.mutable_mesh();
+    *mesh = canonical_mesh_;
+    float* vertices = mesh->mutable_vertex_buffer()->mutable_data();
+    for (int v = 0; v < solver_->num_landmarks(); ++v) {
+      vertices[v * kVertexSize] = face.metric_landmarks(0, v);
+      vertices[v * kVertexSize + 1] = face.metric_landmarks(1, v);
+      vertices[v * kVertexSize + 2] = face.metric_landmarks(2, v);
+    }
+
+    // Column-major, like MatrixDataProtoFromMatrix.
+    auto* matrix = face_geometry.mutable_pose_transform_matrix();
+    matrix->set_rows(4);
+    matrix->set_cols(4);
+    for (int k = 0; k < 16; ++k) {
+      matrix->add_packed_data(face.pose_transform.data()[k]);
+    }
+  }
+  cc->Outputs()
+      .Tag(kMultiFaceGeometryTag)
+      .Add(multi_face_geometry.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
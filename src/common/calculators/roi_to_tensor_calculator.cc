@@ -0,0 +1,340 @@
+// "common/prebuilt/calculators/roi_to_tensor_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/roi_to_tensor_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/image_pyramid.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kPyramidTag[] = "PYRAMID";
+constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
+constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
+constexpr char kMatrixTag[] = "MATRIX";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Crops, rotates, resizes and normalizes regions of interest of a CPU image
+// into a model input tensor, in one affine warp per ROI.
+//
+// CPU alternative to ImageToTensorCalculator for landmark models. Only the
+// output-sized region is sampled: each ROI is resampled with a single
+// bilinear cv::warpAffine, whose fixed-point kernels are vectorized, into a
+// scratch buffer of tensor size that is then normalized into the tensor. No
+// rotated or cropped copy of the frame is made.
+//
+// With NORM_RECTS, all ROIs of a frame are batched into one tensor, for
+// models with a batch dimension, e.g. landmarks for several people at once.
+// `flip_horizontally` mirrors single ROIs of the batch, e.g. the right eye
+// for the iris model, within the same warp.
+//
+// With PYRAMID instead of IMAGE, each ROI is sampled from the smallest level
+// of the ImagePyramidCalculator output that still has as many pixels across
+// it as the tensor, so that the models of a graph share one RGB conversion
+// and downscaling of the frame, and small tensors of large ROIs are not
+// aliased.
+//
+// Inputs:
+//   One of:
+//   IMAGE: ImageFrame, SRGB or SRGBA.
+//   PYRAMID: prebuilt::ImagePyramid.
+//   One of:
+//   NORM_RECT: NormalizedRect, the ROI. The whole image when not connected.
+//   NORM_RECTS: Vector of NormalizedRect, batched into one tensor.
+//
+// Outputs:
+//   TENSORS: Vector holding one kFloat32 Tensor of shape [1, height, width, 3],
+//            or [number of ROIs, height, width, 3] with NORM_RECTS.
+//   LETTERBOX_PADDING (optional): std::array<float, 4>, the normalized left,
+//            top, right and bottom padding added by keep_aspect_ratio.
+//            Vector of them with NORM_RECTS.
+//   MATRIX (optional): std::array<float, 16>, row major 4x4 matrix mapping
+//            normalized tensor coordinates to normalized image coordinates,
+//            as output by ImageToTensorCalculator. Vector of them with
+//            NORM_RECTS.
+//
+// Usage example:
+// node {
+//   calculator: "RoiToTensorCalculator"
+//   input_stream: "IMAGE:image"
+//   input_stream: "NORM_RECT:roi"
+//   output_stream: "TENSORS:input_tensors"
+//   output_stream: "LETTERBOX_PADDING:letterbox_padding"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.RoiToTensorCalculatorOptions] {
+//       output_tensor_width: 256
+//       output_tensor_height: 256
+//       keep_aspect_ratio: true
+//     }
+//   }
+// }
+//
+class RoiToTensorCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Warps `roi` of `image`, mirrored when `flip`, into `destination`, which
+  // holds width * height * 3 floats, and fills in its padding and matrix.
+  void WarpRoi(const cv::Mat& image, const NormalizedRect& roi, bool flip,
+               float* destination, std::array<float, 4>* padding,
+               std::array<float, 16>* matrix);
+
+  ::mediapipe::RoiToTensorCalculatorOptions options_;
+  // Tensor-sized scratch buffers, reused across ROIs and frames.
+  cv::Mat warped_;
+  cv::Mat rgb_;
+};
+
+REGISTER_CALCULATOR(RoiToTensorCalculator);
+
+absl::Status RoiToTensorCalculator::GetContract(CalculatorContract* cc) {
+  RET_CHECK(!(cc->Inputs().HasTag(kNormRectTag) &&
+              cc->Inputs().HasTag(kNormRectsTag)))
+      << "Connect NORM_RECT or NORM_RECTS, not both.";
+  RET_CHECK(cc->Inputs().HasTag(kImageTag) != cc->Inputs().HasTag(kPyramidTag))
+      << "Connect IMAGE or PYRAMID.";
+  const bool batched = cc->Inputs().HasTag(kNormRectsTag);
+
+  if (cc->Inputs().HasTag(kImageTag)) {
+    cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
+  } else {
+    cc->Inputs().Tag(kPyramidTag).Set<prebuilt::ImagePyramid>();
+  }
+  if (cc->Inputs().HasTag(kNormRectTag)) {
+    cc->Inputs().Tag(kNormRectTag).Set<NormalizedRect>();
+  }
+  if (batched) {
+    cc->Inputs().Tag(kNormRectsTag).Set<std::vector<NormalizedRect>>();
+  }
+
+  cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  if (cc->Outputs().HasTag(kLetterboxPaddingTag)) {
+    if (batched) {
+      cc->Outputs()
+          .Tag(kLetterboxPaddingTag)
+          .Set<std::vector<std::array<float, 4>>>();
+    } else {
+      cc->Outputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
+    }
+  }
+  if (cc->Outputs().HasTag(kMatrixTag)) {
+    if (batched) {
+      cc->Outputs().Tag(kMatrixTag).Set<std::vector<std::array<float, 16>>>();
+    } else {
+      cc->Outputs().Tag(kMatrixTag).Set<std::array<float, 16>>();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RoiToTensorCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ = cc->Options<::mediapipe::RoiToTensorCalculatorOptions>();
+  RET_CHECK_GT(options_.output_tensor_width(), 0);
+  RET_CHECK_GT(options_.output_tensor_height(), 0);
+  RET_CHECK_LT(options_.output_tensor_float_min(),
+               options_.output_tensor_float_max());
+  return absl::OkStatus();
+}
+
+void RoiToTensorCalculator::WarpRoi(const cv::Mat& image,
+                                    const NormalizedRect& roi, bool flip,
+                                    float* destination,
+                                    std::array<float, 4>* padding,
+                                    std::array<float, 16>* matrix) {
+  const int output_width = options_.output_tensor_width();
+  const int output_height = options_.output_tensor_height();
+
+  // ROI in pixels.
+  const float center_x = roi.x_center() * image.cols;
+  const float center_y = roi.y_center() * image.rows;
+  float width = roi.width() * image.cols;
+  float height = roi.height() * image.rows;
+
+  padding->fill(0.f);
+  if (options_.keep_aspect_ratio()) {
+    const float tensor_aspect =
+        static_cast<float>(output_height) / output_width;
+    if (height / width > tensor_aspect) {
+      const float padded_width = height / tensor_aspect;
+      (*padding)[0] = (*padding)[2] = (1.f - width / padded_width) / 2.f;
+      width = padded_width;
+    } else {
+      const float padded_height = width * tensor_aspect;
+      (*padding)[1] = (*padding)[3] = (1.f - height / padded_height) / 2.f;
+      height = padded_height;
+    }
+  }
+  // A negative width walks the ROI right to left; the padding is symmetric.
+  if (flip) width = -width;
+
+  // Rotation is clockwise in image coordinates, where y points down.
+  const float cos_r = std::cos(roi.rotation());
+  const float sin_r = std::sin(roi.rotation());
+
+  // Maps output pixel centers to source pixel centers.
+  const float scale_x = width / output_width;
+  const float scale_y = height / output_height;
+  const float offset_x = 0.5f * scale_x - 0.5f * width;
+  const float offset_y = 0.5f * scale_y - 0.5f * height;
+  cv::Matx23f warp(
+      cos_r * scale_x, -sin_r * scale_y,
+      center_x + cos_r * offset_x - sin_r * offset_y - 0.5f,
+      sin_r * scale_x, cos_r * scale_y,
+      center_y + sin_r * offset_x + cos_r * offset_y - 0.5f);
+
+  cv::warpAffine(image, warped_, warp, cv::Size(output_width, output_height),
+                 cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                 options_.border_mode() ==
+                         RoiToTensorCalculatorOptions::BORDER_ZERO
+                     ? cv::BORDER_CONSTANT
+                     : cv::BORDER_REPLICATE);
+  cv::Mat source = warped_;
+  if (source.channels() == 4) {
+    cv::cvtColor(source, rgb_, cv::COLOR_RGBA2RGB);
+    source = rgb_;
+  }
+
+  const float min = options_.output_tensor_float_min();
+  const float max = options_.output_tensor_float_max();
+  cv::Mat tensor_mat(output_height, output_width, CV_32FC3, destination);
+  source.convertTo(tensor_mat, CV_32F, (max - min) / 255.0, min);
+
+  // Same matrix as ImageToTensorCalculator: normalized tensor coordinates to
+  // normalized image coordinates.
+  *matrix = {cos_r * width / image.cols,
+             -sin_r * height / image.cols,
+             0.f,
+             (center_x - 0.5f * cos_r * width + 0.5f * sin_r * height) /
+                 image.cols,
+             sin_r * width / image.rows,
+             cos_r * height / image.rows,
+             0.f,
+             (center_y - 0.5f * sin_r * width - 0.5f * cos_r * height) /
+                 image.rows,
+             0.f,
+             0.f,
+             1.f,
+             0.f,
+             0.f,
+             0.f,
+             0.f,
+             1.f};
+}
+
+absl::Status RoiToTensorCalculator::Process(CalculatorContext* cc) {
+  const bool use_pyramid = cc->Inputs().HasTag(kPyramidTag);
+  if (cc->Inputs().Tag(use_pyramid ? kPyramidTag : kImageTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const bool batched = cc->Inputs().HasTag(kNormRectsTag);
+
+  std::vector<NormalizedRect> rois;
+  if (batched) {
+    if (cc->Inputs().Tag(kNormRectsTag).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    rois = cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
+    if (rois.empty()) {
+      return absl::OkStatus();
+    }
+  } else if (cc->Inputs().HasTag(kNormRectTag)) {
+    if (cc->Inputs().Tag(kNormRectTag).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    rois.push_back(cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>());
+  } else {
+    NormalizedRect whole_image;
+    whole_image.set_x_center(0.5f);
+    whole_image.set_y_center(0.5f);
+    whole_image.set_width(1.f);
+    whole_image.set_height(1.f);
+    rois.push_back(whole_image);
+  }
+
+  const prebuilt::ImagePyramid* pyramid = nullptr;
+  cv::Mat image;
+  if (use_pyramid) {
+    pyramid = &cc->Inputs().Tag(kPyramidTag).Get<prebuilt::ImagePyramid>();
+  } else {
+    const auto& input_frame = cc->Inputs().Tag(kImageTag).Get<ImageFrame>();
+    image = formats::MatView(&input_frame);
+    RET_CHECK(image.channels() == 3 || image.channels() == 4)
+        << "Only SRGB and SRGBA images are supported.";
+  }
+
+  const int num_rois = rois.size();
+  const int roi_size =
+      options_.output_tensor_width() * options_.output_tensor_height() * 3;
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(
+      Tensor::ElementType::kFloat32,
+      Tensor::Shape{num_rois, options_.output_tensor_height(),
+                    options_.output_tensor_width(), 3});
+  std::vector<std::array<float, 4>> paddings(num_rois);
+  std::vector<std::array<float, 16>> matrices(num_rois);
+  {
+    auto view = tensors->back().GetCpuWriteView();
+    float* buffer = view.buffer<float>();
+    for (int i = 0; i < num_rois; ++i) {
+      // ROIs are normalized, so any level serves; only the detail differs.
+      const cv::Mat& source =
+          pyramid ? pyramid->Level(pyramid->LevelFor(
+                        rois[i].width() * pyramid->width(),
+                        rois[i].height() * pyramid->height(),
+                        options_.output_tensor_width(),
+                        options_.output_tensor_height()))
+                  : image;
+      const bool flip = i < options_.flip_horizontally_size() &&
+                        options_.flip_horizontally(i);
+      WarpRoi(source, rois[i], flip, buffer + i * roi_size, &paddings[i],
+              &matrices[i]);
+    }
+  }
+
+  const Timestamp timestamp = cc->InputTimestamp();
+  cc->Outputs().Tag(kTensorsTag).Add(tensors.release(), timestamp);
+  if (cc->Outputs().HasTag(kLetterboxPaddingTag)) {
+    if (batched) {
+      cc->Outputs().Tag(kLetterboxPaddingTag).AddPacket(
+          MakePacket<std::vector<std::array<float, 4>>>(std::move(paddings))
+              .At(timestamp));
+    } else {
+      cc->Outputs().Tag(kLetterboxPaddingTag).AddPacket(
+          MakePacket<std::array<float, 4>>(paddings[0]).At(timestamp));
+    }
+  }
+  if (cc->Outputs().HasTag(kMatrixTag)) {
+    if (batched) {
+      cc->Outputs().Tag(kMatrixTag).AddPacket(
+          MakePacket<std::vector<std::array<float, 16>>>(std::move(matrices))
+              .At(timestamp));
+    } else {
+      cc->Outputs().Tag(kMatrixTag).AddPacket(
+          MakePacket<std::array<float, 16>>(matrices[0]).At(timestamp));
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,436 @@
+// "common/prebuilt/calculators/ssd_decode_nms_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/common/prebuilt/calculators/ssd_decode_nms_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kAnchorsTag[] = "ANCHORS";
+constexpr char kDetectionsTag[] = "DETECTIONS";
+
+// Appends to `indices` the boxes whose clipped logit reaches `threshold`, in
+// anchor order. Scores are compared before the sigmoid, which is monotonic, so
+// it only runs on the boxes that pass.
+void SelectCandidates(const float* logits, int num_boxes, float clip,
+                      float threshold, std::vector<int>* indices) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128 low = _mm_set1_ps(-clip);
+  const __m128 high = _mm_set1_ps(clip);
+  const __m128 bound = _mm_set1_ps(threshold);
+  for (; i + 4 <= num_boxes; i += 4) {
+    const __m128 logit =
+        _mm_min_ps(_mm_max_ps(_mm_loadu_ps(logits + i), low), high);
+    int mask = _mm_movemask_ps(_mm_cmpge_ps(logit, bound));
+    while (mask != 0) {
+      const int lane = __builtin_ctz(mask);
+      indices->push_back(i + lane);
+      mask &= mask - 1;
+    }
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t low = vdupq_n_f32(-clip);
+  const float32x4_t high = vdupq_n_f32(clip);
+  const float32x4_t bound = vdupq_n_f32(threshold);
+  for (; i + 4 <= num_boxes; i += 4) {
+    const float32x4_t logit =
+        vminq_f32(vmaxq_f32(vld1q_f32(logits + i), low), high);
+    const uint32x4_t pass = vcgeq_f32(logit, bound);
+    const uint32x2_t any =
+        vorr_u32(vget_low_u32(pass), vget_high_u32(pass));
+    if (vget_lane_u32(vpmax_u32(any, any), 0) == 0) continue;
+    uint32_t lanes[4];
+    vst1q_u32(lanes, pass);
+    for (int lane = 0; lane < 4; ++lane) {
+      if (lanes[lane] != 0) indices->push_back(i + lane);
+    }
+  }
+#endif
+  for (; i < num_boxes; ++i) {
+    const float logit = std::min(std::max(logits[i], -clip), clip);
+    if (logit >= threshold) indices->push_back(i);
+  }
+}
+
+}  // namespace
+
+namespace mediapipe {
+
+// Decodes SSD model output into detections and suppresses overlapping ones
+// with weighted non-max suppression, in one node.
+//
+// Fused CPU alternative to TensorsToDetectionsCalculator followed by
+// NonMaxSuppressionCalculator with algorithm WEIGHTED. The two-node chain
+// decodes every anchor, builds a Detection proto for each box above the score
+// threshold and then reads the protos back for suppression. Here the scores
+// are thresholded with SIMD in logit space, only the boxes that pass are
+// decoded, into a flat structure-of-arrays buffer that is reused across
+// frames, and suppression runs on that buffer. Detection protos are only built
+// for the detections that are output.
+//
+// Decoding matches TensorsToDetectionsCalculator for single-class models,
+// including max_results keeping the first boxes in anchor order. Suppression
+// matches NonMaxSuppressionCalculator with algorithm WEIGHTED, except that
+// ties in score keep anchor order.
+//
+// Inputs:
+//   TENSORS: Vector of two kFloat32 Tensors, the raw boxes of num_boxes *
+//            num_coords values and the num_boxes raw scores.
+//
+// Input side packets:
+//   ANCHORS: std::vector<Anchor>, as output by SsdAnchorsCalculator.
+//
+// Outputs:
+//   DETECTIONS: std::vector<Detection> with relative bounding boxes and
+//               keypoints. No packet when nothing is detected, unless
+//               return_empty_detections is set.
+//
+// Usage example:
+// node {
+//   calculator: "SsdDecodeNmsCalculator"
+//   input_stream: "TENSORS:detection_tensors"
+//   input_side_packet: "ANCHORS:anchors"
+//   output_stream: "DETECTIONS:filtered_detections"
+//   options: {
+//     [mediapipe.SsdDecodeNmsCalculatorOptions.ext] {
+//       num_boxes: 2254
+//       num_coords: 12
+//       keypoint_coord_offset: 4
+//       num_keypoints: 4
+//       sigmoid_score: true
+//       score_clipping_thresh: 100.0
+//       reverse_output_order: true
+//       x_scale: 224.0
+//       y_scale: 224.0
+//       h_scale: 224.0
+//       w_scale: 224.0
+//       min_score_thresh: 0.15
+//       max_results: 50
+//       min_suppression_threshold: 0.35
+//       max_num_detections: 2
+//     }
+//   }
+// }
+//
+class SsdDecodeNmsCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Decodes the boxes in candidate_indices_ into the candidate buffers,
+  // dropping those with a negative or NaN extent, up to max_results boxes.
+  void DecodeCandidates(const float* raw_boxes, const float* logits);
+
+  // Runs weighted suppression over the candidates and appends the surviving
+  // detections to `detections`.
+  void SuppressCandidates(std::vector<Detection>* detections);
+
+  float Overlap(int candidate, int reference) const;
+
+  ::mediapipe::SsdDecodeNmsCalculatorOptions options_;
+  float score_clip_ = std::numeric_limits<float>::infinity();
+  float logit_threshold_ = 0;
+
+  // Anchors as structure of arrays, copied once from the side packet.
+  std::vector<float> anchor_x_;
+  std::vector<float> anchor_y_;
+  std::vector<float> anchor_w_;
+  std::vector<float> anchor_h_;
+
+  // Candidate buffers, reused across frames. Keypoints are interleaved x, y.
+  std::vector<int> candidate_indices_;
+  std::vector<float> score_;
+  std::vector<float> xmin_;
+  std::vector<float> ymin_;
+  std::vector<float> xmax_;
+  std::vector<float> ymax_;
+  std::vector<float> keypoints_;
+  std::vector<int> remaining_;
+  std::vector<int> next_remaining_;
+};
+
+REGISTER_CALCULATOR(SsdDecodeNmsCalculator);
+
+absl::Status SsdDecodeNmsCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  cc->InputSidePackets().Tag(kAnchorsTag).Set<std::vector<Anchor>>();
+  cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+  return absl::OkStatus();
+}
+
+absl::Status SsdDecodeNmsCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ = cc->Options<::mediapipe::SsdDecodeNmsCalculatorOptions>();
+  RET_CHECK_GT(options_.num_boxes(), 0);
+  RET_CHECK_GE(options_.box_coord_offset(), 0);
+  RET_CHECK_LE(options_.box_coord_offset() + 4, options_.num_coords());
+  RET_CHECK_GE(options_.num_values_per_keypoint(), 2);
+  RET_CHECK_LE(options_.keypoint_coord_offset() +
+                   options_.num_keypoints() *
+                       options_.num_values_per_keypoint(),
+               options_.num_coords());
+  RET_CHECK_NE(options_.overlap_type(),
+               ::mediapipe::SsdDecodeNmsCalculatorOptions::
+                   UNSPECIFIED_OVERLAP_TYPE);
+
+  const auto& anchors =
+      cc->InputSidePackets().Tag(kAnchorsTag).Get<std::vector<Anchor>>();
+  RET_CHECK_EQ(anchors.size(), options_.num_boxes());
+  anchor_x_.resize(anchors.size());
+  anchor_y_.resize(anchors.size());
+  anchor_w_.resize(anchors.size());
+  anchor_h_.resize(anchors.size());
+  for (size_t i = 0; i < anchors.size(); ++i) {
+    anchor_x_[i] = anchors[i].x_center();
+    anchor_y_[i] = anchors[i].y_center();
+    anchor_w_[i] = anchors[i].w();
+    anchor_h_[i] = anchors[i].h();
+  }
+
+  if (options_.has_score_clipping_thresh()) {
+    score_clip_ = options_.score_clipping_thresh();
+  }
+  // The score threshold, moved before the sigmoid. Without one every box
+  // passes, as in TensorsToDetectionsCalculator.
+  const float min_score = options_.min_score_thresh();
+  if (!options_.has_min_score_thresh()) {
+    logit_threshold_ = -std::numeric_limits<float>::infinity();
+  } else if (!options_.sigmoid_score()) {
+    logit_threshold_ = min_score;
+  } else if (min_score <= 0) {
+    logit_threshold_ = -std::numeric_limits<float>::infinity();
+  } else if (min_score >= 1) {
+    logit_threshold_ = std::numeric_limits<float>::infinity();
+  } else {
+    logit_threshold_ = std::log(min_score / (1 - min_score));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SsdDecodeNmsCalculator::Process(CalculatorContext* cc) {
+  const auto& tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+  RET_CHECK_GE(tensors.size(), 2);
+  const Tensor& raw_boxes = tensors[0];
+  const Tensor& raw_scores = tensors[1];
+  RET_CHECK(raw_boxes.element_type() == Tensor::ElementType::kFloat32);
+  RET_CHECK(raw_scores.element_type() == Tensor::ElementType::kFloat32);
+  RET_CHECK_EQ(raw_boxes.shape().num_elements(),
+               options_.num_boxes() * options_.num_coords());
+  RET_CHECK_EQ(raw_scores.shape().num_elements(), options_.num_boxes())
+      << "Only single-class models are supported.";
+
+  auto boxes_view = raw_boxes.GetCpuReadView();
+  auto scores_view = raw_scores.GetCpuReadView();
+  const float* logits = scores_view.buffer<float>();
+
+  candidate_indices_.clear();
+  SelectCandidates(logits, options_.num_boxes(), score_clip_,
+                   logit_threshold_, &candidate_indices_);
+  DecodeCandidates(boxes_view.buffer<float>(), logits);
+
+  auto detections = absl::make_unique<std::vector<Detection>>();
+  SuppressCandidates(detections.get());
+  if (detections->empty() && !options_.return_empty_detections()) {
+    return absl::OkStatus();
+  }
+  cc->Outputs()
+      .Tag(kDetectionsTag)
+      .Add(detections.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+void SsdDecodeNmsCalculator::DecodeCandidates(const float* raw_boxes,
+                                              const float* logits) {
+  const int num_coords = options_.num_coords();
+  const int num_keypoints = options_.num_keypoints();
+  const bool reverse = options_.reverse_output_order();
+  score_.clear();
+  xmin_.clear();
+  ymin_.clear();
+  xmax_.clear();
+  ymax_.clear();
+  keypoints_.clear();
+  for (const int i : candidate_indices_) {
+    if (options_.max_results() > 0 &&
+        static_cast<int>(score_.size()) == options_.max_results()) {
+      break;
+    }
+    const float* box = raw_boxes + i * num_coords;
+    const float* coords = box + options_.box_coord_offset();
+    float x_center = reverse ? coords[0] : coords[1];
+    float y_center = reverse ? coords[1] : coords[0];
+    float w = reverse ? coords[2] : coords[3];
+    float h = reverse ? coords[3] : coords[2];
+
+    x_center = x_center / options_.x_scale() * anchor_w_[i] + anchor_x_[i];
+    y_center = y_center / options_.y_scale() * anchor_h_[i] + anchor_y_[i];
+    if (options_.apply_exponential_on_box_size()) {
+      h = std::exp(h / options_.h_scale()) * anchor_h_[i];
+      w = std::exp(w / options_.w_scale()) * anchor_w_[i];
+    } else {
+      h = h / options_.h_scale() * anchor_h_[i];
+      w = w / options_.w_scale() * anchor_w_[i];
+    }
+    // Boxes the model predicts with a negative extent are dropped, as
+    // TensorsToDetectionsCalculator does.
+    if (!(w >= 0) || !(h >= 0)) continue;
+
+    const float logit =
+        std::min(std::max(logits[i], -score_clip_), score_clip_);
+    score_.push_back(options_.sigmoid_score()
+                         ? 1.0f / (1.0f + std::exp(-logit))
+                         : logit);
+    xmin_.push_back(x_center - w / 2);
+    ymin_.push_back(y_center - h / 2);
+    xmax_.push_back(x_center + w / 2);
+    ymax_.push_back(y_center + h / 2);
+    for (int k = 0; k < num_keypoints; ++k) {
+      const float* keypoint = box + options_.keypoint_coord_offset() +
+                              k * options_.num_values_per_keypoint();
+      const float keypoint_x = reverse ? keypoint[0] : keypoint[1];
+      const float keypoint_y = reverse ? keypoint[1] : keypoint[0];
+      keypoints_.push_back(keypoint_x / options_.x_scale() * anchor_w_[i] +
+                           anchor_x_[i]);
+      keypoints_.push_back(keypoint_y / options_.y_scale() * anchor_h_[i] +
+                           anchor_y_[i]);
+    }
+  }
+}
+
+float SsdDecodeNmsCalculator::Overlap(int candidate, int reference) const {
+  const float intersection_width =
+      std::min(xmax_[candidate], xmax_[reference]) -
+      std::max(xmin_[candidate], xmin_[reference]);
+  const float intersection_height =
+      std::min(ymax_[candidate], ymax_[reference]) -
+      std::max(ymin_[candidate], ymin_[reference]);
+  if (intersection_width < 0 || intersection_height < 0) return 0;
+  const float intersection = intersection_width * intersection_height;
+  float normalization = 0;
+  switch (options_.overlap_type()) {
+    case ::mediapipe::SsdDecodeNmsCalculatorOptions::JACCARD:
+      // The box enclosing both, as Rectangle_f::Union() computes it.
+      normalization = (std::max(xmax_[candidate], xmax_[reference]) -
+                       std::min(xmin_[candidate], xmin_[reference])) *
+                      (std::max(ymax_[candidate], ymax_[reference]) -
+                       std::min(ymin_[candidate], ymin_[reference]));
+      break;
+    case ::mediapipe::SsdDecodeNmsCalculatorOptions::MODIFIED_JACCARD:
+      normalization = (xmax_[reference] - xmin_[reference]) *
+                      (ymax_[reference] - ymin_[reference]);
+      break;
+    case ::mediapipe::SsdDecodeNmsCalculatorOptions::INTERSECTION_OVER_UNION:
+      normalization = (xmax_[candidate] - xmin_[candidate]) *
+                          (ymax_[candidate] - ymin_[candidate]) +
+                      (xmax_[reference] - xmin_[reference]) *
+                          (ymax_[reference] - ymin_[reference]) -
+                      intersection;
+      break;
+    default:
+      // Rejected in Open().
+      break;
+  }
+  return normalization > 0 ? intersection / normalization : 0;
+}
+
+void SsdDecodeNmsCalculator::SuppressCandidates(
+    std::vector<Detection>* detections) {
+  const int num_candidates = score_.size();
+  remaining_.resize(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) remaining_[i] = i;
+  std::stable_sort(remaining_.begin(), remaining_.end(),
+                   [this](int a, int b) { return score_[a] > score_[b]; });
+
+  const int num_keypoints = options_.num_keypoints();
+  const int max_detections = options_.max_num_detections() < 0
+                                 ? num_candidates
+                                 : options_.max_num_detections();
+  std::vector<float> weighted_keypoints(num_keypoints * 2);
+  while (!remaining_.empty() &&
+         static_cast<int>(detections->size()) < max_detections) {
+    const int top = remaining_[0];
+    next_remaining_.clear();
+    float total_score = 0;
+    float weighted_xmin = 0;
+    float weighted_ymin = 0;
+    float weighted_xmax = 0;
+    float weighted_ymax = 0;
+    std::fill(weighted_keypoints.begin(), weighted_keypoints.end(), 0.0f);
+    // The top box overlaps itself, so it is among the boxes averaged.
+    for (const int candidate : remaining_) {
+      if (Overlap(candidate, top) <= options_.min_suppression_threshold()) {
+        next_remaining_.push_back(candidate);
+        continue;
+      }
+      const float score = score_[candidate];
+      total_score += score;
+      weighted_xmin += xmin_[candidate] * score;
+      weighted_ymin += ymin_[candidate] * score;
+      weighted_xmax += xmax_[candidate] * score;
+      weighted_ymax += ymax_[candidate] * score;
+      const float* keypoints = &keypoints_[candidate * num_keypoints * 2];
+      for (int k = 0; k < num_keypoints * 2; ++k) {
+        weighted_keypoints[k] += keypoints[k] * score;
+      }
+    }
+
+    Detection& detection = detections->emplace_back();
+    detection.add_score(score_[top]);
+    detection.add_label_id(0);
+    LocationData* location_data = detection.mutable_location_data();
+    location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+    LocationData::RelativeBoundingBox* box =
+        location_data->mutable_relative_bounding_box();
+    if (total_score > 0) {
+      box->set_xmin(weighted_xmin / total_score);
+      box->set_ymin(weighted_ymin / total_score);
+      box->set_width(weighted_xmax / total_score - box->xmin());
+      box->set_height(weighted_ymax / total_score - box->ymin());
+      for (int k = 0; k < num_keypoints; ++k) {
+        auto* keypoint = location_data->add_relative_keypoints();
+        keypoint->set_x(weighted_keypoints[k * 2] / total_score);
+        keypoint->set_y(weighted_keypoints[k * 2 + 1] / total_score);
+      }
+    } else {
+      box->set_xmin(xmin_[top]);
+      box->set_ymin(ymin_[top]);
+      box->set_width(xmax_[top] - xmin_[top]);
+      box->set_height(ymax_[top] - ymin_[top]);
+      for (int k = 0; k < num_keypoints; ++k) {
+        auto* keypoint = location_data->add_relative_keypoints();
+        keypoint->set_x(keypoints_[(top * num_keypoints + k) * 2]);
+        keypoint->set_y(keypoints_[(top * num_keypoints + k) * 2 + 1]);
+      }
+    }
+
+    // A top box that overlaps nothing, not even itself, would never leave.
+    if (next_remaining_.size() == remaining_.size()) break;
+    remaining_.swap(next_remaining_);
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,152 @@
+// "common/prebuilt/calculators/tensors_to_image_frame_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/tflite_tensors_to_image_frame_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/util/image_tensor_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kImageTag[] = "IMAGE";
+
+}  // namespace
+
+namespace mediapipe {
+
+// Converts the output of an image-to-image model, as mediapipe::Tensor, to an
+// image.
+//
+// Counterpart of TfLiteTensorsToImageFrameCalculator for graphs that run the
+// model with InferenceCalculator instead of TfLiteInferenceCalculator. Takes
+// the same options. The input is read through a CPU read view, without copying
+// the tensor, and the tensor dimensions come from its shape; the dimensions in
+// the options are only checked when set.
+//
+// Inputs:
+//   TENSORS: Vector of Tensor of type kFloat32, shaped [1, height, width,
+//            channels] with 1 or 3 channels and values in [-1, 1].
+// Output:
+//   IMAGE: An ImageFrame output image, SRGBA.
+//   And/or:
+//   TENSORS: Vector holding one kFloat32 Tensor of shape [1,
+//            output_tensor_height, output_tensor_width, channels], resized and
+//            normalized for the next model.
+//
+// Usage example:
+// node {
+//   calculator: "TensorsToImageFrameCalculator"
+//   input_stream: "TENSORS:bitmap_tensor"
+//   output_stream: "IMAGE:output_video"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.TfLiteTensorsToImageFrameCalculatorOptions] {
+//       tensor_width: 224
+//       tensor_height: 224
+//       tensor_channels: 3
+//     }
+//   }
+// }
+//
+class TensorsToImageFrameCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  ::mediapipe::TfLiteTensorsToImageFrameCalculatorOptions options_;
+};
+
+REGISTER_CALCULATOR(TensorsToImageFrameCalculator);
+
+absl::Status TensorsToImageFrameCalculator::GetContract(
+    CalculatorContract* cc) {
+  RET_CHECK(cc->Outputs().HasTag(kImageTag) ||
+            cc->Outputs().HasTag(kTensorsTag));
+  cc->Inputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  if (cc->Outputs().HasTag(kImageTag)) {
+    cc->Outputs().Tag(kImageTag).Set<ImageFrame>();
+  }
+  if (cc->Outputs().HasTag(kTensorsTag)) {
+    cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TensorsToImageFrameCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ =
+      cc->Options<::mediapipe::TfLiteTensorsToImageFrameCalculatorOptions>();
+  return absl::OkStatus();
+}
+
+absl::Status TensorsToImageFrameCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kTensorsTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  const auto& input_tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+  RET_CHECK_EQ(input_tensors.size(), 1)
+      << "The size of std::vector<Tensor> should be 1.";
+  const Tensor& tensor = input_tensors[0];
+  RET_CHECK(tensor.element_type() == Tensor::ElementType::kFloat32);
+
+  const std::vector<int>& dims = tensor.shape().dims;
+  RET_CHECK_GE(dims.size(), 3);
+  const int height = dims[dims.size() - 3];
+  const int width = dims[dims.size() - 2];
+  const int channels = dims[dims.size() - 1];
+  RET_CHECK(channels == 1 || channels == 3)
+      << "Only 1 or 3 channel bitmap tensor currently supported";
+  if (options_.has_tensor_width()) {
+    RET_CHECK_EQ(width, options_.tensor_width());
+  }
+  if (options_.has_tensor_height()) {
+    RET_CHECK_EQ(height, options_.tensor_height());
+  }
+  if (options_.has_tensor_channels()) {
+    RET_CHECK_EQ(channels, options_.tensor_channels());
+  }
+
+  auto read_view = tensor.GetCpuReadView();
+  const float* pixels = read_view.buffer<float>();
+
+  if (cc->Outputs().HasTag(kTensorsTag)) {
+    const int output_width = options_.output_tensor_width() > 0
+                                 ? options_.output_tensor_width()
+                                 : width;
+    const int output_height = options_.output_tensor_height() > 0
+                                  ? options_.output_tensor_height()
+                                  : height;
+    auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+    output_tensors->emplace_back(
+        Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, output_height, output_width, channels});
+    {
+      auto write_view = output_tensors->back().GetCpuWriteView();
+      prebuilt::ResizeAndNormalizePixels(
+          pixels, width, height, channels, output_width, output_height,
+          options_.output_zero_center(), write_view.buffer<float>());
+    }
+    cc->Outputs()
+        .Tag(kTensorsTag)
+        .Add(output_tensors.release(), cc->InputTimestamp());
+  }
+
+  if (cc->Outputs().HasTag(kImageTag)) {
+    auto output = prebuilt::FloatPixelsToImageFrame(
+        pixels, width, height, channels, options_.flip_vertically());
+    cc->Outputs().Tag(kImageTag).Add(output.release(), cc->InputTimestamp());
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
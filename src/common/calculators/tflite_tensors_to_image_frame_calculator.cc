@@ -1,11 +1,12 @@
-// "desktop/prebuilt/cartoon/graphs/calculators/tflite_tensors_to_image_frame_calculator.cc"
-// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/cartoon
+// "common/prebuilt/calculators/tflite_tensors_to_image_frame_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
 
 #include <string>
 #include <vector>
 
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/examples/common/prebuilt/util/image_tensor_util.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -27,7 +28,7 @@
 #include "tensorflow/lite/delegates/gpu/gl_delegate.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
-#include "mediapipe/examples/desktop/prebuilt/cartoon/graphs/calculators/tflite_tensors_to_image_frame_calculator.pb.h"
+#include "mediapipe/examples/common/prebuilt/calculators/tflite_tensors_to_image_frame_calculator.pb.h"
 
 namespace {
 constexpr int kWorkgroupSize = 8;  // Block size for GPU shader.
@@ -61,6 +62,9 @@ using ::tflite::gpu::gl::GlShader;
 // Converts TFLite tensors from a tflite model to an image.
 //
 // Produces result as an RGBA image, with the pixel data in R or RGB channels.
+// On CPU the result can also be emitted as a float tensor, so that a model
+// consuming the output skips the uint8 round trip through an ImageFrame and
+// TfLiteConverterCalculator.
 //
 // Inputs:
 //   One of the following TENSORS tags:
@@ -71,6 +75,10 @@ using ::tflite::gpu::gl::GlShader;
 //   One of the following IMAGE tags:
 //   IMAGE: An ImageFrame output image, RGBA.
 //   IMAGE_GPU: A GpuBuffer output image, RGBA.
+//   And/or, with CPU input:
+//   TENSORS: Vector holding one kTfLiteFloat32 TfLiteTensor of shape
+//            [output_tensor_height, output_tensor_width, tensor_channels],
+//            resized and normalized for the next model.
 //
 // Options:
 //   See tflite_tensors_to_image_frame_calculator.proto
@@ -89,6 +97,23 @@ using ::tflite::gpu::gl::GlShader;
 //   }
 // }
 //
+// Feeding a 256x256 model that expects [0, 1] input:
+// node {
+//   calculator: "TfLiteTensorsToImageFrameCalculator"
+//   input_stream: "TENSORS:tensors"
+//   output_stream: "TENSORS:next_model_input"
+//   node_options: {
+//     [mediapipe.TfLiteTensorsToImageFrameCalculatorOptions] {
+//       tensor_width: 224
+//       tensor_height: 224
+//       tensor_channels: 3
+//       output_tensor_width: 256
+//       output_tensor_height: 256
+//       output_zero_center: false
+//     }
+//   }
+// }
+//
 class TfLiteTensorsToImageFrameCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
@@ -102,6 +127,9 @@ class TfLiteTensorsToImageFrameCalculator : public CalculatorBase {
   absl::Status InitGpu(CalculatorContext* cc);
   absl::Status ProcessGpu(CalculatorContext* cc);
   absl::Status ProcessCpu(CalculatorContext* cc);
+  absl::Status InitTensorOutput();
+  absl::Status OutputTensorCpu(const TfLiteTensor& input,
+                               CalculatorContext* cc);
   void GlRender();
 
   ::mediapipe::TfLiteTensorsToImageFrameCalculatorOptions options_;
@@ -111,6 +139,10 @@ class TfLiteTensorsToImageFrameCalculator : public CalculatorBase {
   int tensor_channels_ = 0;
   float scale_factor_ = 1;
 
+  // Owns the TENSORS output, the same way TfLiteConverterCalculator provides
+  // its CPU tensors.
+  std::unique_ptr<tflite::Interpreter> output_interpreter_;
+
   bool use_gpu_ = false;
 #if !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
   mediapipe::GlCalculatorHelper gpu_helper_;
@@ -146,6 +178,11 @@ absl::Status TfLiteTensorsToImageFrameCalculator::GetContract(
   if (cc->Outputs().HasTag(kImageTag)) {
     cc->Outputs().Tag(kImageTag).Set<ImageFrame>();
   }
+  if (cc->Outputs().HasTag(kTensorsTag)) {
+    RET_CHECK(cc->Inputs().HasTag(kTensorsTag))
+        << "TENSORS output requires CPU input.";
+    cc->Outputs().Tag(kTensorsTag).Set<std::vector<TfLiteTensor>>();
+  }
 #if !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
   if (cc->Outputs().HasTag(kImageGpuTag)) {
     cc->Outputs().Tag(kImageGpuTag).Set<mediapipe::GpuBuffer>();
@@ -174,6 +211,10 @@ absl::Status TfLiteTensorsToImageFrameCalculator::Open(
 
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
+  if (cc->Outputs().HasTag(kTensorsTag)) {
+    MP_RETURN_IF_ERROR(InitTensorOutput());
+  }
+
   if (use_gpu_) {
 #if !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
     MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, cc]() -> absl::Status {
@@ -231,42 +272,57 @@ absl::Status TfLiteTensorsToImageFrameCalculator::ProcessCpu(
   RET_CHECK_EQ(input_tensors.size(), 1)
       << "The size of std::vector<TfLiteTensor> should be 1.";
 
-  const TfLiteTensor tensor = input_tensors[0];
-  const float* raw_input_data = tensor.data.f;
-  
-  const int output_width = tensor_width_, output_height = tensor_height_;
-  const int depth = 4;
-  const int total_size = output_height * output_width * depth;
-  const auto format = ImageFormat::SRGBA;
-
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[total_size]);
-  
-  // Convert [-1.0, 1.0] float values to [0.0, 255.0].
-  auto scale_and_clamp = [](const auto a) {
-    float b = 127.5 * (a + 1);
-    if (b < 0) b = 0;
-    if (b > 255) b = 255;
-    return b;
-  };
-
-  size_t pos = 0;
+  const TfLiteTensor& tensor = input_tensors[0];
+  RET_CHECK_EQ(tensor.type, kTfLiteFloat32);
+  RET_CHECK_EQ(tensor.bytes, tensor_width_ * tensor_height_ *
+                                 tensor_channels_ * sizeof(float))
+      << "Input tensor does not match the tensor dimensions in options.";
 
-  // Map three channel (RGB) float data to four channel (RGBA) uint8 data.
-  for (int i = 0; i < total_size; i += 4) {
-    buffer[i + 0] = static_cast<uchar>(scale_and_clamp(raw_input_data[pos++]));
-    buffer[i + 1] = static_cast<uchar>(scale_and_clamp(raw_input_data[pos++]));
-    buffer[i + 2] = static_cast<uchar>(scale_and_clamp(raw_input_data[pos++]));
-    buffer[i + 3] = static_cast<uchar>(scale_and_clamp(1)); // Set alpha to max
+  if (cc->Outputs().HasTag(kTensorsTag)) {
+    MP_RETURN_IF_ERROR(OutputTensorCpu(tensor, cc));
+  }
+  if (cc->Outputs().HasTag(kImageTag)) {
+    auto output = prebuilt::FloatPixelsToImageFrame(
+        tensor.data.f, tensor_width_, tensor_height_, tensor_channels_,
+        options_.flip_vertically());
+    cc->Outputs().Tag(kImageTag).Add(output.release(), cc->InputTimestamp());
   }
 
-  ::std::unique_ptr<const ImageFrame> output;
-  
-  output = ::absl::make_unique<ImageFrame>(
-      format, output_width, output_height, output_width * depth, buffer.release(),
-      [total_size](uint8* ptr) { ::operator delete[](ptr, total_size); });
+  return absl::OkStatus();
+}
 
-  cc->Outputs().Tag(kImageTag).Add(output.release(), cc->InputTimestamp());
+absl::Status TfLiteTensorsToImageFrameCalculator::InitTensorOutput() {
+  const int width = options_.output_tensor_width() > 0
+                        ? options_.output_tensor_width()
+                        : tensor_width_;
+  const int height = options_.output_tensor_height() > 0
+                         ? options_.output_tensor_height()
+                         : tensor_height_;
+
+  output_interpreter_ = absl::make_unique<tflite::Interpreter>();
+  output_interpreter_->AddTensors(1);
+  output_interpreter_->SetInputs({0});
+  output_interpreter_->SetTensorParametersReadWrite(
+      0, kTfLiteFloat32, "", {height, width, tensor_channels_},
+      TfLiteQuantization());
+  RET_CHECK_EQ(output_interpreter_->AllocateTensors(), kTfLiteOk);
+  return absl::OkStatus();
+}
 
+absl::Status TfLiteTensorsToImageFrameCalculator::OutputTensorCpu(
+    const TfLiteTensor& input, CalculatorContext* cc) {
+  TfLiteTensor* output =
+      output_interpreter_->tensor(output_interpreter_->inputs()[0]);
+  prebuilt::ResizeAndNormalizePixels(
+      input.data.f, tensor_width_, tensor_height_, tensor_channels_,
+      output->dims->data[1], output->dims->data[0],
+      options_.output_zero_center(), output->data.f);
+
+  auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
+  output_tensors->emplace_back(*output);
+  cc->Outputs()
+      .Tag(kTensorsTag)
+      .Add(output_tensors.release(), cc->InputTimestamp());
   return absl::OkStatus();
 }
 
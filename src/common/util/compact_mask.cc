@@ -0,0 +1,233 @@
+// "common/prebuilt/util/compact_mask.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/compact_mask.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+using Affine = std::array<float, 6>;
+
+bool InvertAffine(const Affine& m, Affine* inverse) {
+  const float det = m[0] * m[4] - m[1] * m[3];
+  if (std::abs(det) < 1e-12f) return false;
+  *inverse = {m[4] / det,
+              -m[1] / det,
+              (m[1] * m[5] - m[4] * m[2]) / det,
+              -m[3] / det,
+              m[0] / det,
+              (m[3] * m[2] - m[0] * m[5]) / det};
+  return true;
+}
+
+// The map that applies `second` after `first`.
+Affine Compose(const Affine& second, const Affine& first) {
+  return {second[0] * first[0] + second[1] * first[3],
+          second[0] * first[1] + second[1] * first[4],
+          second[0] * first[2] + second[1] * first[5] + second[2],
+          second[3] * first[0] + second[4] * first[3],
+          second[3] * first[1] + second[4] * first[4],
+          second[3] * first[2] + second[4] * first[5] + second[5]};
+}
+
+// Narrows [*begin, *end) to the steps t at which start + step * t lies in
+// [low, high].
+void ClipSpan(float start, float step, float low, float high, int* begin,
+              int* end) {
+  if (std::abs(step) < 1e-9f) {
+    if (start < low || start > high) *end = *begin;
+    return;
+  }
+  float first = (low - start) / step;
+  float last = (high - start) / step;
+  if (first > last) std::swap(first, last);
+  // Clamped before the conversion, which overflows on far-off spans.
+  first = std::max(first, *begin - 1.0f);
+  last = std::min(last, *end + 1.0f);
+  *begin = std::max(*begin, static_cast<int>(std::ceil(first)));
+  *end = std::min(*end, static_cast<int>(std::floor(last)) + 1);
+}
+
+// Bilinear sample at pixel-center coordinates (x, y), clamped to the edge
+// pixels, in 8-bit fixed point.
+inline int Sample(const uint8_t* values, int width, int height, float x,
+                  float y) {
+  x = std::min(std::max(x, 0.0f), width - 1.0f);
+  y = std::min(std::max(y, 0.0f), height - 1.0f);
+  const int x0 = static_cast<int>(x);
+  const int y0 = static_cast<int>(y);
+  const int x1 = std::min(x0 + 1, width - 1);
+  const int y1 = std::min(y0 + 1, height - 1);
+  const int wx = static_cast<int>((x - x0) * 256);
+  const int wy = static_cast<int>((y - y0) * 256);
+  const uint8_t* top = values + y0 * width;
+  const uint8_t* bottom = values + y1 * width;
+  const int upper = top[x0] * (256 - wx) + top[x1] * wx;
+  const int lower = bottom[x0] * (256 - wx) + bottom[x1] * wx;
+  return (upper * (256 - wy) + lower * wy + (1 << 15)) >> 16;
+}
+
+// Calls `pixel(i, value)` for the pixels of a row of `count` pixels whose
+// sample coordinates in `mask` start at (x, y) and advance by (dx, dy), for
+// those the mask covers.
+template <typename PixelFn>
+void SampleRow(const CompactMask& mask, float x, float y, float dx, float dy,
+               int count, PixelFn pixel) {
+  int begin = 0;
+  int end = count;
+  ClipSpan(x, dx, -0.5f, mask.width - 0.5f, &begin, &end);
+  ClipSpan(y, dy, -0.5f, mask.height - 0.5f, &begin, &end);
+  const uint8_t* values = mask.values.data();
+  for (int i = begin; i < end; ++i) {
+    pixel(i, Sample(values, mask.width, mask.height, x + dx * i, y + dy * i));
+  }
+}
+
+inline uint8_t QuantizeValue(float value) {
+  // NaN becomes 0.
+  const float clamped = value > 0 ? (value < 1 ? value : 1) : 0;
+  return static_cast<uint8_t>(clamped * 255 + 0.5f);
+}
+
+}  // namespace
+
+bool SetMaskPlacement(const NormalizedRect& roi,
+                      const std::array<float, 4>& letterbox_padding,
+                      int image_width, int image_height, CompactMask* mask) {
+  const float content_width = 1 - letterbox_padding[0] - letterbox_padding[2];
+  const float content_height = 1 - letterbox_padding[1] - letterbox_padding[3];
+  const float roi_width = roi.width() * image_width;
+  const float roi_height = roi.height() * image_height;
+  if (content_width <= 0 || content_height <= 0 || roi_width <= 0 ||
+      roi_height <= 0 || mask->width <= 0 || mask->height <= 0) {
+    return false;
+  }
+  // Mask coordinates to ROI pixels relative to its center, past the
+  // letterbox padding.
+  const float ax = roi_width / (mask->width * content_width);
+  const float bx = -roi_width * (letterbox_padding[0] / content_width + 0.5f);
+  const float ay = roi_height / (mask->height * content_height);
+  const float by = -roi_height * (letterbox_padding[1] / content_height + 0.5f);
+  // Then rotated by the ROI rotation, as the landmarks are projected.
+  const float cosine = std::cos(roi.rotation());
+  const float sine = std::sin(roi.rotation());
+  const float center_x = roi.x_center() * image_width;
+  const float center_y = roi.y_center() * image_height;
+  mask->image_width = image_width;
+  mask->image_height = image_height;
+  mask->mask_to_image = {cosine * ax,
+                         -sine * ay,
+                         cosine * bx - sine * by + center_x,
+                         sine * ax,
+                         cosine * ay,
+                         sine * bx + cosine * by + center_y};
+  return InvertAffine(mask->mask_to_image, &mask->image_to_mask);
+}
+
+void QuantizeMask(const float* src, int src_step, int width, int height,
+                  uint8_t* dst) {
+  for (int y = 0; y < height; ++y) {
+    const float* row = src + y * src_step;
+    uint8_t* out = dst + y * width;
+    int x = 0;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    // max returns its second operand for NaN, so NaN becomes 0.
+    auto convert = [&](const float* values) {
+      const __m128 clamped =
+          _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values), zero), one);
+      return _mm_cvtps_epi32(_mm_mul_ps(clamped, scale));
+    };
+    for (; x + 16 <= width; x += 16) {
+      const __m128i low =
+          _mm_packs_epi32(convert(row + x), convert(row + x + 4));
+      const __m128i high =
+          _mm_packs_epi32(convert(row + x + 8), convert(row + x + 12));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x),
+                       _mm_packus_epi16(low, high));
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    // NaN survives the clamp and converts to 0.
+    auto convert = [&](const float* values) {
+      const float32x4_t clamped =
+          vminq_f32(vmaxq_f32(vld1q_f32(values), zero), one);
+      return vmovn_u32(vcvtq_u32_f32(vmlaq_f32(half, clamped, scale)));
+    };
+    for (; x + 16 <= width; x += 16) {
+      const uint16x8_t low =
+          vcombine_u16(convert(row + x), convert(row + x + 4));
+      const uint16x8_t high =
+          vcombine_u16(convert(row + x + 8), convert(row + x + 12));
+      vst1q_u8(out + x, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#endif
+    for (; x < width; ++x) out[x] = QuantizeValue(row[x]);
+  }
+}
+
+std::array<float, 2> MaskCenter(const CompactMask& mask) {
+  const auto& m = mask.mask_to_image;
+  const float x = mask.width * 0.5f;
+  const float y = mask.height * 0.5f;
+  return {m[0] * x + m[1] * y + m[2], m[3] * x + m[4] * y + m[5]};
+}
+
+float MaskSize(const CompactMask& mask) {
+  const auto& m = mask.mask_to_image;
+  return std::sqrt(std::abs(m[0] * m[4] - m[1] * m[3]) * mask.width *
+                   mask.height);
+}
+
+void BlendWithPrevious(const CompactMask& previous, float previous_weight,
+                       CompactMask* mask) {
+  const int weight = static_cast<int>(
+      std::min(std::max(previous_weight, 0.0f), 1.0f) * 256 + 0.5f);
+  if (weight == 0 || previous.values.empty()) return;
+  // Pixels of `mask` to pixels of `previous`.
+  const Affine m = Compose(previous.image_to_mask, mask->mask_to_image);
+  for (int y = 0; y < mask->height; ++y) {
+    uint8_t* row = mask->values.data() + y * mask->width;
+    const float py = y + 0.5f;
+    SampleRow(previous, m[0] * 0.5f + m[1] * py + m[2] - 0.5f,
+              m[3] * 0.5f + m[4] * py + m[5] - 0.5f, m[0], m[3], mask->width,
+              [row, weight](int x, int value) {
+                row[x] = (row[x] * (256 - weight) + value * weight + 128) >> 8;
+              });
+  }
+}
+
+void UpsampleMask(const CompactMask& mask, int x, int y, int width, int height,
+                  uint8_t* dst, int dst_step) {
+  if (mask.values.empty()) return;
+  const auto& m = mask.image_to_mask;
+  const float px = x + 0.5f;
+  for (int row = 0; row < height; ++row) {
+    uint8_t* out = dst + row * dst_step;
+    const float py = y + row + 0.5f;
+    SampleRow(mask, m[0] * px + m[1] * py + m[2] - 0.5f,
+              m[3] * px + m[4] * py + m[5] - 0.5f, m[0], m[3], width,
+              [out](int i, int value) {
+                if (value > out[i]) out[i] = value;
+              });
+  }
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,71 @@
+// "common/prebuilt/util/compact_mask.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_COMPACT_MASK_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_COMPACT_MASK_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/framework/formats/rect.pb.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// A segmentation mask kept at the resolution the model produced it in, one
+// byte per pixel, together with where it lies in the frame. A 256x256 mask
+// is 64 KB, where the same mask warped into a 1080p float frame is 8 MB.
+//
+// Both affine maps take continuous coordinates, in which pixel (i, j) covers
+// [i, i + 1) x [j, j + 1):
+//   x' = m[0] * x + m[1] * y + m[2]
+//   y' = m[3] * x + m[4] * y + m[5]
+struct CompactMask {
+  int width = 0;
+  int height = 0;
+  // Row-major, 0 for background to 255 for the person.
+  std::vector<uint8_t> values;
+
+  int image_width = 0;
+  int image_height = 0;
+  std::array<float, 6> mask_to_image = {1, 0, 0, 0, 1, 0};
+  std::array<float, 6> image_to_mask = {1, 0, 0, 0, 1, 0};
+};
+
+// Sets the maps of a `mask` cropped from `roi` of an image_width x
+// image_height frame the way ImageToTensorCalculator crops, with
+// `letterbox_padding` (left, top, right, bottom, normalized) around the
+// crop. The mask size must be set. Returns false when the crop is empty.
+bool SetMaskPlacement(const NormalizedRect& roi,
+                      const std::array<float, 4>& letterbox_padding,
+                      int image_width, int image_height, CompactMask* mask);
+
+// Converts probabilities in [0, 1] to mask values, with SSE2 or NEON where
+// available. `src_step` is in floats.
+void QuantizeMask(const float* src, int src_step, int width, int height,
+                  uint8_t* dst);
+
+// Where the center of `mask` lies in the frame, and the square root of the
+// frame area it covers, in pixels.
+std::array<float, 2> MaskCenter(const CompactMask& mask);
+float MaskSize(const CompactMask& mask);
+
+// Blends `previous`, resampled onto the pixels of `mask`, into `mask` with
+// weight `previous_weight` in [0, 1]. Pixels `previous` does not cover keep
+// their values. Both masks must belong to frames of the same size.
+void BlendWithPrevious(const CompactMask& previous, float previous_weight,
+                       CompactMask* mask);
+
+// Bilinearly upsamples `mask` into the frame region of `width` x `height`
+// pixels at (`x`, `y`), whose pixels start at `dst`. Each pixel the mask
+// covers becomes the larger of its value and the mask's, so that the masks
+// of several people can go into one cleared buffer. Rows and columns the
+// mask does not reach are not touched.
+void UpsampleMask(const CompactMask& mask, int x, int y, int width, int height,
+                  uint8_t* dst, int dst_step);
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_COMPACT_MASK_H_
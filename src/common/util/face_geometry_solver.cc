@@ -0,0 +1,243 @@
+// "common/prebuilt/util/face_geometry_solver.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/face_geometry_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/SVD"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+// Canonical mesh vertices are x, y, z, u, v.
+constexpr int kVertexSize = 5;
+// Faces whose screen landmarks all lie within this distance of their center
+// are skipped, as in GeometryPipeline; the fit is unstable on them.
+constexpr float kMinLandmarkSpread = 1e-3f;
+constexpr float kDegreesToRadians = 3.14159265358979323846f / 180.f;
+
+bool IsTooCompact(const NormalizedLandmarkList& landmarks) {
+  float mean_x = 0.f;
+  float mean_y = 0.f;
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    mean_x += (landmarks.landmark(i).x() - mean_x) / (i + 1);
+    mean_y += (landmarks.landmark(i).y() - mean_y) / (i + 1);
+  }
+  float max_distance2 = 0.f;
+  for (const auto& landmark : landmarks.landmark()) {
+    const float dx = landmark.x() - mean_x;
+    const float dy = landmark.y() - mean_y;
+    max_distance2 = std::max(max_distance2, dx * dx + dy * dy);
+  }
+  return std::sqrt(max_distance2) <= kMinLandmarkSpread;
+}
+
+// Moves z so that the landmarks sit around the near plane and divides it by
+// the face scale found so far.
+void MoveAndRescaleZ(float depth_offset, float near, float scale,
+                     Eigen::Matrix3Xf* landmarks) {
+  landmarks->row(2) =
+      (landmarks->row(2).array() - depth_offset + near) / scale;
+}
+
+// Turns x and y on the near plane into camera space coordinates at the
+// landmarks' depth.
+void UnprojectXY(float near, Eigen::Matrix3Xf* landmarks) {
+  landmarks->row(0) = landmarks->row(0).cwiseProduct(landmarks->row(2)) / near;
+  landmarks->row(1) = landmarks->row(1).cwiseProduct(landmarks->row(2)) / near;
+}
+
+void ChangeHandedness(Eigen::Matrix3Xf* landmarks) {
+  landmarks->row(2) *= -1.f;
+}
+
+}  // namespace
+
+absl::StatusOr<FaceGeometrySolver> FaceGeometrySolver::Create(
+    const face_geometry::Environment& environment,
+    const face_geometry::GeometryPipelineMetadata& metadata) {
+  const auto& camera = environment.perspective_camera();
+  RET_CHECK(camera.vertical_fov_degrees() > 0.f &&
+            camera.vertical_fov_degrees() < 180.f)
+      << "Vertical field of view must be within (0, 180) degrees.";
+  RET_CHECK_GT(camera.near(), 0.f) << "Near plane must be positive.";
+
+  const auto& mesh = metadata.canonical_mesh();
+  RET_CHECK_EQ(mesh.vertex_type(), face_geometry::Mesh3d::VERTEX_PT)
+      << "Only VERTEX_PT canonical meshes are supported.";
+  RET_CHECK_EQ(mesh.vertex_buffer_size() % kVertexSize, 0)
+      << "Canonical mesh vertex buffer has a partial vertex.";
+
+  FaceGeometrySolver solver;
+  solver.origin_top_left_ = environment.origin_point_location() ==
+                            face_geometry::OriginPointLocation::TOP_LEFT_CORNER;
+  solver.vertical_fov_degrees_ = camera.vertical_fov_degrees();
+  solver.near_ = camera.near();
+  solver.num_landmarks_ = mesh.vertex_buffer_size() / kVertexSize;
+  RET_CHECK_GT(solver.num_landmarks_, 0) << "Canonical mesh is empty.";
+
+  for (const auto& ref : metadata.procrustes_landmark_basis()) {
+    RET_CHECK_LT(static_cast<int>(ref.landmark_id()), solver.num_landmarks_)
+        << "Procrustes basis refers to a missing landmark.";
+    RET_CHECK_GE(ref.weight(), 0.f) << "Procrustes weights can't be negative.";
+    if (ref.weight() == 0.f) continue;
+    solver.basis_ids_.push_back(ref.landmark_id());
+    solver.basis_weights_.push_back(ref.weight());
+    solver.total_weight_ += ref.weight();
+  }
+  RET_CHECK_GT(solver.total_weight_, 1e-6f)
+      << "Procrustes basis has no weight.";
+
+  // The canonical side of the fit never changes.
+  const int basis_size = solver.basis_ids_.size();
+  auto canonical = [&mesh](int id) {
+    return Eigen::Vector3f(mesh.vertex_buffer(id * kVertexSize),
+                           mesh.vertex_buffer(id * kVertexSize + 1),
+                           mesh.vertex_buffer(id * kVertexSize + 2));
+  };
+  solver.source_center_.setZero();
+  for (int k = 0; k < basis_size; ++k) {
+    solver.source_center_ +=
+        solver.basis_weights_[k] * canonical(solver.basis_ids_[k]);
+  }
+  solver.source_center_ /= solver.total_weight_;
+  solver.weighted_centered_sources_.resize(3, basis_size);
+  for (int k = 0; k < basis_size; ++k) {
+    const Eigen::Vector3f source = canonical(solver.basis_ids_[k]);
+    solver.weighted_centered_sources_.col(k) =
+        solver.basis_weights_[k] * (source - solver.source_center_);
+    solver.scale_denominator_ +=
+        solver.weighted_centered_sources_.col(k).dot(source);
+  }
+  RET_CHECK_GT(solver.scale_denominator_, 0.f)
+      << "Procrustes basis landmarks are degenerate.";
+
+  solver.screen_.resize(3, solver.num_landmarks_);
+  solver.scratch_.resize(3, solver.num_landmarks_);
+  solver.Reserve(1);
+  return solver;
+}
+
+void FaceGeometrySolver::Reserve(int num_faces) {
+  const int old_size = faces_.size();
+  if (num_faces <= old_size) return;
+  faces_.resize(num_faces);
+  for (int i = old_size; i < num_faces; ++i) {
+    faces_[i].metric_landmarks.resize(3, num_landmarks_);
+  }
+}
+
+absl::Status FaceGeometrySolver::Solve(
+    const std::vector<NormalizedLandmarkList>& multi_face_landmarks,
+    int frame_width, int frame_height) {
+  RET_CHECK(frame_width > 0 && frame_height > 0) << "Invalid frame size.";
+  Frustum frustum;
+  const float height_at_near =
+      2.f * near_ * std::tan(0.5f * kDegreesToRadians * vertical_fov_degrees_);
+  const float width_at_near = frame_width * height_at_near / frame_height;
+  frustum.left = -0.5f * width_at_near;
+  frustum.right = 0.5f * width_at_near;
+  frustum.bottom = -0.5f * height_at_near;
+  frustum.top = 0.5f * height_at_near;
+  frustum.near = near_;
+
+  Reserve(multi_face_landmarks.size());
+  num_faces_ = 0;
+  for (int i = 0; i < static_cast<int>(multi_face_landmarks.size()); ++i) {
+    const auto& landmarks = multi_face_landmarks[i];
+    RET_CHECK_EQ(landmarks.landmark_size(), num_landmarks_)
+        << "Face landmarks don't match the canonical mesh.";
+    if (IsTooCompact(landmarks)) continue;
+    Face* face = &faces_[num_faces_++];
+    face->index = i;
+    SolveFace(landmarks, frustum, face);
+  }
+  return absl::OkStatus();
+}
+
+void FaceGeometrySolver::SolvePose(const Eigen::Matrix3Xf& targets,
+                                   Eigen::Matrix3f* rotation, float* scale,
+                                   Eigen::Vector3f* translation) const {
+  // With the canonical side folded into weighted_centered_sources_, the
+  // design matrix is sum(target * weighted_centered_source^T) over the basis.
+  Eigen::Matrix3f design = Eigen::Matrix3f::Zero();
+  Eigen::Vector3f target_center = Eigen::Vector3f::Zero();
+  for (int k = 0; k < static_cast<int>(basis_ids_.size()); ++k) {
+    const auto target = targets.col(basis_ids_[k]);
+    design.noalias() += target * weighted_centered_sources_.col(k).transpose();
+    target_center += basis_weights_[k] * target;
+  }
+  target_center /= total_weight_;
+
+  const Eigen::JacobiSVD<Eigen::Matrix3f> svd(
+      design, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Eigen::Matrix3f postrotation = svd.matrixU();
+  const Eigen::Matrix3f prerotation = svd.matrixV().transpose();
+  // Keeps the result a rotation rather than a reflection.
+  if (postrotation.determinant() * prerotation.determinant() < 0.f) {
+    postrotation.col(2) *= -1.f;
+  }
+  *rotation = postrotation * prerotation;
+  *scale = rotation->cwiseProduct(design).sum() / scale_denominator_;
+  *translation = target_center - *scale * *rotation * source_center_;
+}
+
+void FaceGeometrySolver::SolveFace(const NormalizedLandmarkList& landmarks,
+                                   const Frustum& frustum, Face* face) {
+  for (int i = 0; i < num_landmarks_; ++i) {
+    const auto& landmark = landmarks.landmark(i);
+    screen_.col(i) << landmark.x(), landmark.y(), landmark.z();
+  }
+
+  // Onto the near plane of the camera.
+  if (origin_top_left_) {
+    screen_.row(1) = 1.f - screen_.row(1).array();
+  }
+  const float x_scale = frustum.right - frustum.left;
+  const float y_scale = frustum.top - frustum.bottom;
+  screen_.array().colwise() *= Eigen::Array3f(x_scale, y_scale, x_scale);
+  screen_.colwise() += Eigen::Vector3f(frustum.left, frustum.bottom, 0.f);
+  const float depth_offset = screen_.row(2).mean();
+
+  Eigen::Matrix3f rotation;
+  float scale;
+  Eigen::Vector3f translation;
+
+  // The relative z makes unprojecting unsafe before the face scale is known,
+  // so the first pass fits the projected landmarks as they are.
+  scratch_ = screen_;
+  ChangeHandedness(&scratch_);
+  SolvePose(scratch_, &rotation, &scale, &translation);
+  const float first_scale = std::abs(scale);
+
+  // The second pass unprojects with the first scale and refines it.
+  scratch_ = screen_;
+  MoveAndRescaleZ(depth_offset, frustum.near, first_scale, &scratch_);
+  UnprojectXY(frustum.near, &scratch_);
+  ChangeHandedness(&scratch_);
+  SolvePose(scratch_, &rotation, &scale, &translation);
+  const float total_scale = first_scale * std::abs(scale);
+
+  // The metric landmarks, and the pose of the canonical face within them.
+  MoveAndRescaleZ(depth_offset, frustum.near, total_scale, &screen_);
+  UnprojectXY(frustum.near, &screen_);
+  ChangeHandedness(&screen_);
+  SolvePose(screen_, &rotation, &scale, &translation);
+
+  face->pose_transform.setIdentity();
+  face->pose_transform.topLeftCorner<3, 3>() = scale * rotation;
+  face->pose_transform.topRightCorner<3, 1>() = translation;
+
+  // The inverse pose aligns the landmarks with the canonical face.
+  const Eigen::Matrix3f inverse_rotation = rotation.transpose() / scale;
+  face->metric_landmarks.noalias() = inverse_rotation * screen_;
+  face->metric_landmarks.colwise() -= inverse_rotation * translation;
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
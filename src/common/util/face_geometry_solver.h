@@ -0,0 +1,109 @@
+// "common/prebuilt/util/face_geometry_solver.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_FACE_GEOMETRY_SOLVER_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_FACE_GEOMETRY_SOLVER_H_
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/StdVector"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/modules/face_geometry/protos/environment.pb.h"
+#include "mediapipe/modules/face_geometry/protos/geometry_pipeline_metadata.pb.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Estimates the metric landmarks and the pose transform of every face in a
+// frame, with the same math as the GeometryPipeline behind
+// FaceGeometryPipelineCalculator: the screen landmarks are unprojected through
+// the environment's perspective camera in two scale refinement passes, then a
+// weighted orthogonal Procrustes fit against the canonical face gives the
+// pose.
+//
+// Everything that only depends on the canonical face is computed once: the
+// weighted and centered canonical basis, and the denominator of the optimal
+// scale. A fit then reduces to accumulating a 3x3 design matrix over the
+// basis landmarks and a fixed-size 3x3 SVD. The per-landmark passes run on
+// workspaces owned by the solver, so solving allocates nothing once the
+// solver has seen as many faces as a frame holds; Reserve() sizes it up
+// front.
+//
+// Only metadata for the face landmark pipeline with VERTEX_PT meshes is
+// supported. Not thread-safe.
+class FaceGeometrySolver {
+ public:
+  static absl::StatusOr<FaceGeometrySolver> Create(
+      const face_geometry::Environment& environment,
+      const face_geometry::GeometryPipelineMetadata& metadata);
+
+  // Preallocates the workspace for `num_faces` faces.
+  void Reserve(int num_faces);
+
+  // Solves every face of `multi_face_landmarks` for a frame of the given
+  // size. Faces whose landmarks are too compact to fit are skipped, as in
+  // GeometryPipeline; face(i) refers to the i-th solved face.
+  absl::Status Solve(
+      const std::vector<NormalizedLandmarkList>& multi_face_landmarks,
+      int frame_width, int frame_height);
+
+  struct Face {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    // Index of the face in the solved landmark lists.
+    int index = 0;
+    // Maps the canonical face into the camera space.
+    Eigen::Matrix4f pose_transform;
+    // The landmarks in the canonical face space, one per column.
+    Eigen::Matrix3Xf metric_landmarks;
+  };
+
+  int num_faces() const { return num_faces_; }
+  const Face& face(int i) const { return faces_[i]; }
+
+  int num_landmarks() const { return num_landmarks_; }
+
+ private:
+  // Frustum of the perspective camera at the near plane.
+  struct Frustum {
+    float left, right, bottom, top, near;
+  };
+
+  FaceGeometrySolver() = default;
+
+  // Fits scale * rotation and translation that map the canonical face onto
+  // `targets`.
+  void SolvePose(const Eigen::Matrix3Xf& targets, Eigen::Matrix3f* rotation,
+                 float* scale, Eigen::Vector3f* translation) const;
+  // Solves a single face into `face`, using `screen_` and `scratch_`.
+  void SolveFace(const NormalizedLandmarkList& landmarks,
+                 const Frustum& frustum, Face* face);
+
+  bool origin_top_left_ = true;
+  float vertical_fov_degrees_ = 0;
+  float near_ = 0;
+  int num_landmarks_ = 0;
+
+  // Canonical basis landmarks and their Procrustes weights.
+  std::vector<int> basis_ids_;
+  std::vector<float> basis_weights_;
+  float total_weight_ = 0;
+  // weight * (canonical - weighted canonical center), one column per basis
+  // landmark.
+  Eigen::Matrix3Xf weighted_centered_sources_;
+  Eigen::Vector3f source_center_;
+  // Sum of weight * (canonical - center) . canonical over the basis.
+  float scale_denominator_ = 0;
+
+  Eigen::Matrix3Xf screen_;
+  Eigen::Matrix3Xf scratch_;
+  std::vector<Face, Eigen::aligned_allocator<Face>> faces_;
+  int num_faces_ = 0;
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_FACE_GEOMETRY_SOLVER_H_
@@ -0,0 +1,188 @@
+// "common/prebuilt/util/graph_session.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/graph_session.h"
+
+#include <cmath>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+constexpr char kBinaryGraphExtension[] = ".binarypb";
+
+}  // namespace
+
+absl::StatusOr<CalculatorGraphConfig> GraphSession::ParseConfig(
+    absl::string_view data, bool binary) {
+  CalculatorGraphConfig config;
+  if (binary) {
+    RET_CHECK(config.ParseFromArray(data.data(), data.size()))
+        << "Failed to parse binary graph config.";
+  } else {
+    RET_CHECK(ParseTextProto<CalculatorGraphConfig>(std::string(data),
+                                                    &config))
+        << "Failed to parse text graph config.";
+  }
+  return config;
+}
+
+absl::StatusOr<CalculatorGraphConfig> GraphSession::LoadConfig(
+    const std::string& path) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  return ParseConfig(contents, absl::EndsWith(path, kBinaryGraphExtension));
+}
+
+absl::StatusOr<std::unique_ptr<GraphSession>> GraphSession::Create(
+    CalculatorGraphConfig config, Options options) {
+  RET_CHECK_GE(options.max_frames_in_flight, 0);
+  auto session = absl::WrapUnique(new GraphSession(std::move(options)));
+  MP_RETURN_IF_ERROR(session->graph_.Initialize(std::move(config)));
+  return session;
+}
+
+GraphSession::GraphSession(Options options) : options_(std::move(options)) {}
+
+GraphSession::~GraphSession() {
+  if (started_ && !stopped_) Cancel();
+}
+
+absl::Status GraphSession::SetSidePacket(const std::string& name,
+                                         Packet packet) {
+  RET_CHECK(!started_) << "Side packets must be set before Start().";
+  side_packets_[name] = std::move(packet);
+  return absl::OkStatus();
+}
+
+absl::Status GraphSession::ObservePackets(const std::string& stream,
+                                          PacketCallback callback) {
+  RET_CHECK(!started_) << "Outputs must be observed before Start().";
+  callbacks_[stream].push_back(std::move(callback));
+  return absl::OkStatus();
+}
+
+absl::Status GraphSession::Start() {
+  RET_CHECK(!started_) << "The session was already started.";
+  // The frame output stream needs an observer of its own for the in-flight
+  // count even when nobody asked for its packets.
+  if (options_.max_frames_in_flight > 0) {
+    callbacks_[options_.frame_output_stream];
+  }
+  // One observer per stream. The callback lists are not touched again once
+  // the graph runs, so the observers read them without locking.
+  for (const auto& stream_callbacks : callbacks_) {
+    const std::string& stream = stream_callbacks.first;
+    const std::vector<PacketCallback>* callbacks = &stream_callbacks.second;
+    // Timestamp bound updates arrive as empty packets and settle the frames
+    // that produced no output.
+    const bool finishes_frames = options_.max_frames_in_flight > 0 &&
+                                 stream == options_.frame_output_stream;
+    MP_RETURN_IF_ERROR(graph_.ObserveOutputStream(
+        stream,
+        [this, callbacks, finishes_frames](const Packet& packet) {
+          if (!packet.IsEmpty()) {
+            for (const auto& callback : *callbacks) callback(packet);
+          }
+          if (finishes_frames) OnFrameOutput(packet.Timestamp());
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/finishes_frames));
+  }
+  MP_RETURN_IF_ERROR(graph_.StartRun(side_packets_));
+  started_ = true;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> GraphSession::SendFrame(Packet frame, double seconds) {
+  RET_CHECK(started_ && !stopped_) << "The session is not running.";
+  absl::MutexLock send_lock(&send_mutex_);
+  int64_t timestamp = static_cast<int64_t>(
+      std::llround(Timestamp::kTimestampUnitsPerSecond * seconds));
+  if (has_sent_ && timestamp <= last_timestamp_) {
+    timestamp = last_timestamp_ + 1;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!HasFrameSlot()) {
+      ++stats_.frames_dropped;
+      return false;
+    }
+    if (options_.max_frames_in_flight > 0) {
+      frames_in_flight_.push_back(timestamp);
+    }
+    ++stats_.frames_sent;
+  }
+  last_timestamp_ = timestamp;
+  has_sent_ = true;
+
+  absl::Status status = graph_.AddPacketToInputStream(
+      options_.input_stream, std::move(frame).At(Timestamp(timestamp)));
+  if (!status.ok()) {
+    absl::MutexLock lock(&mutex_);
+    if (!frames_in_flight_.empty() && frames_in_flight_.back() == timestamp) {
+      frames_in_flight_.pop_back();
+    }
+    --stats_.frames_sent;
+    return status;
+  }
+  return true;
+}
+
+void GraphSession::WaitForFrameSlot() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &GraphSession::HasFrameSlot));
+}
+
+void GraphSession::WaitUntilIdle() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &GraphSession::IsIdle));
+}
+
+absl::Status GraphSession::Stop() {
+  RET_CHECK(started_) << "The session was never started.";
+  if (stopped_) return absl::OkStatus();
+  stopped_ = true;
+  MP_RETURN_IF_ERROR(graph_.CloseAllInputStreams());
+  return graph_.WaitUntilDone();
+}
+
+void GraphSession::Cancel() {
+  if (!started_ || stopped_) return;
+  stopped_ = true;
+  graph_.Cancel();
+  // Cancelling makes the run end with a cancelled status; nothing to report.
+  graph_.WaitUntilDone().IgnoreError();
+}
+
+GraphSession::Stats GraphSession::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void GraphSession::OnFrameOutput(Timestamp timestamp) {
+  absl::MutexLock lock(&mutex_);
+  while (!frames_in_flight_.empty() &&
+         frames_in_flight_.front() <= timestamp.Value()) {
+    frames_in_flight_.pop_front();
+    ++stats_.frames_finished;
+  }
+}
+
+bool GraphSession::HasFrameSlot() const {
+  return options_.max_frames_in_flight == 0 ||
+         static_cast<int>(frames_in_flight_.size()) <
+             options_.max_frames_in_flight;
+}
+
+bool GraphSession::IsIdle() const { return frames_in_flight_.empty(); }
+
+}  // namespace prebuilt
+}  // namespace mediapipe
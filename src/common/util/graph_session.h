@@ -0,0 +1,159 @@
+// "common/prebuilt/util/graph_session.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_GRAPH_SESSION_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_GRAPH_SESSION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Runs one graph for a frame-driven client: the iOS wrappers and the desktop
+// GraphSession benchmarks share it, so everything up to the CVPixelBufferRef
+// boundary builds and runs on Linux.
+//
+// The session mirrors what MPPGraph does for the wrappers. It stamps frames
+// from seconds with strictly increasing timestamps, drops frames while
+// `max_frames_in_flight` frames are unfinished, and hands output packets to
+// callbacks on the graph's worker threads. A frame is finished once the
+// timestamp bound of `frame_output_stream` passes it, so frames the graph's
+// FlowLimiterCalculator drops do not stay in flight forever.
+//
+//   ASSIGN_OR_RETURN(auto config, GraphSession::LoadConfig(path));
+//   ASSIGN_OR_RETURN(auto session, GraphSession::Create(std::move(config)));
+//   MP_RETURN_IF_ERROR(session->ObserveOutput<NormalizedLandmarkList>(
+//       "pose_landmarks",
+//       [](const NormalizedLandmarkList& landmarks, Timestamp timestamp) {}));
+//   MP_RETURN_IF_ERROR(session->Start());
+//   ASSIGN_OR_RETURN(bool sent, session->SendFrame(frame, seconds));
+//   MP_RETURN_IF_ERROR(session->Stop());
+class GraphSession {
+ public:
+  struct Options {
+    // Stream the frames passed to SendFrame go into.
+    std::string input_stream = "input_video";
+    // Stream whose packets mark a frame as done. Usually the stream feeding
+    // the FINISHED back edge of the graph's FlowLimiterCalculator.
+    std::string frame_output_stream = "output_video";
+    // Frames sent while this many are still in flight are dropped. 0 sends
+    // every frame and leaves throttling to the graph.
+    int max_frames_in_flight = 2;
+  };
+
+  using PacketCallback = std::function<void(const Packet&)>;
+
+  // Parses a graph config, as produced by mediapipe_binary_graph when
+  // `binary`, otherwise as a text proto.
+  static absl::StatusOr<CalculatorGraphConfig> ParseConfig(
+      absl::string_view data, bool binary);
+
+  // Reads the graph config at `path`. Files ending in ".binarypb" are parsed
+  // as binary protos, everything else as text protos.
+  static absl::StatusOr<CalculatorGraphConfig> LoadConfig(
+      const std::string& path);
+
+  static absl::StatusOr<std::unique_ptr<GraphSession>> Create(
+      CalculatorGraphConfig config, Options options = Options());
+
+  // Cancels the graph if it is still running.
+  ~GraphSession();
+
+  // Side packets, output callbacks and everything else that has to be in
+  // place before the run may only change before Start().
+  absl::Status SetSidePacket(const std::string& name, Packet packet);
+
+  // Calls `callback` with every non-empty packet on `stream`, on a graph
+  // worker thread.
+  absl::Status ObservePackets(const std::string& stream,
+                              PacketCallback callback);
+
+  // Typed variant of ObservePackets(). Packets on `stream` must hold a T.
+  template <typename T>
+  absl::Status ObserveOutput(
+      const std::string& stream,
+      std::function<void(const T&, Timestamp)> callback) {
+    return ObservePackets(
+        stream, [callback = std::move(callback)](const Packet& packet) {
+          if (packet.IsEmpty()) return;
+          callback(packet.Get<T>(), packet.Timestamp());
+        });
+  }
+
+  absl::Status Start();
+
+  // Sends `frame` into the input stream at `seconds`, e.g. the
+  // CMTimeGetSeconds() of a camera frame. A timestamp that does not increase
+  // on the previous one is bumped to the next free microsecond. Returns false
+  // when the frame was dropped because too many frames are in flight.
+  //
+  // Meant to be called from one thread, such as the camera's video queue.
+  absl::StatusOr<bool> SendFrame(Packet frame, double seconds);
+
+  // Blocks until SendFrame() would not drop a frame, for clients that produce
+  // frames on demand rather than at a camera's pace.
+  void WaitForFrameSlot();
+
+  // Blocks until every frame sent so far is finished. Returns at once when
+  // max_frames_in_flight is 0, as frames are not tracked then.
+  void WaitUntilIdle();
+
+  // Closes the input streams and waits for the graph to finish.
+  absl::Status Stop();
+
+  // Stops the graph without draining the frames in flight.
+  void Cancel();
+
+  struct Stats {
+    int64_t frames_sent = 0;
+    int64_t frames_dropped = 0;
+    // Only tracked when max_frames_in_flight is set.
+    int64_t frames_finished = 0;
+  };
+  Stats GetStats() const;
+
+ private:
+  explicit GraphSession(Options options);
+
+  // Settles the frames at or before `timestamp`.
+  void OnFrameOutput(Timestamp timestamp);
+  bool HasFrameSlot() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool IsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  CalculatorGraph graph_;
+  std::map<std::string, Packet> side_packets_;
+  std::map<std::string, std::vector<PacketCallback>> callbacks_;
+  // Read by SendFrame() on the client's frame thread.
+  std::atomic<bool> started_{false};
+  std::atomic<bool> stopped_{false};
+
+  // Serializes SendFrame(). Kept apart from `mutex_` because adding a packet
+  // may block until the graph drains, which needs OnFrameOutput().
+  absl::Mutex send_mutex_;
+  int64_t last_timestamp_ ABSL_GUARDED_BY(send_mutex_) = 0;
+  bool has_sent_ ABSL_GUARDED_BY(send_mutex_) = false;
+
+  mutable absl::Mutex mutex_;
+  // Timestamps of the unfinished frames, oldest first.
+  std::deque<int64_t> frames_in_flight_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_GRAPH_SESSION_H_
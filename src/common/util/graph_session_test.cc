@@ -0,0 +1,215 @@
+// "common/prebuilt/util/graph_session_test.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/graph_session.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace prebuilt {
+namespace {
+
+constexpr char kReleaseTag[] = "RELEASE";
+
+// Holds every frame until the RELEASE side packet is notified, then passes it
+// through.
+class HoldFramesCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->InputSidePackets()
+        .Tag(kReleaseTag)
+        .Set<std::shared_ptr<absl::Notification>>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->InputSidePackets()
+        .Tag(kReleaseTag)
+        .Get<std::shared_ptr<absl::Notification>>()
+        ->WaitForNotification();
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(HoldFramesCalculator);
+
+// Outputs nothing. Its timestamp offset still moves the output bound past
+// every input frame.
+class SwallowFramesCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SwallowFramesCalculator);
+
+CalculatorGraphConfig PassThroughGraph(const std::string& calculator) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "input_video"
+    output_stream: "output_video"
+    node { input_stream: "input_video" output_stream: "output_video" }
+  )pb");
+  config.mutable_node(0)->set_calculator(calculator);
+  return config;
+}
+
+// Collects the timestamps of the packets on output_video.
+class OutputTimestamps {
+ public:
+  absl::Status Observe(GraphSession* session) {
+    return session->ObserveOutput<int>(
+        "output_video", [this](const int&, Timestamp timestamp) {
+          absl::MutexLock lock(&mutex_);
+          timestamps_.push_back(timestamp.Value());
+        });
+  }
+
+  std::vector<int64_t> Get() {
+    absl::MutexLock lock(&mutex_);
+    return timestamps_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<int64_t> timestamps_ ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(GraphSessionTest, BumpsTimestampsThatDoNotIncrease) {
+  GraphSession::Options options;
+  options.max_frames_in_flight = 0;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto session,
+      GraphSession::Create(PassThroughGraph("PassThroughCalculator"),
+                           options));
+  OutputTimestamps outputs;
+  MP_ASSERT_OK(outputs.Observe(session.get()));
+  MP_ASSERT_OK(session->Start());
+
+  for (const double seconds : {1.0, 1.0, 0.5, 2.0}) {
+    MP_ASSERT_OK_AND_ASSIGN(bool sent,
+                            session->SendFrame(MakePacket<int>(0), seconds));
+    EXPECT_TRUE(sent);
+  }
+  MP_ASSERT_OK(session->Stop());
+
+  EXPECT_EQ(outputs.Get(),
+            std::vector<int64_t>({1000000, 1000001, 1000002, 2000000}));
+  EXPECT_EQ(session->GetStats().frames_sent, 4);
+  EXPECT_EQ(session->GetStats().frames_dropped, 0);
+}
+
+TEST(GraphSessionTest, DropsFramesWhileMaxFramesAreInFlight) {
+  GraphSession::Options options;
+  options.max_frames_in_flight = 2;
+  CalculatorGraphConfig config = PassThroughGraph("HoldFramesCalculator");
+  config.mutable_node(0)->add_input_side_packet("RELEASE:release");
+  MP_ASSERT_OK_AND_ASSIGN(auto session,
+                          GraphSession::Create(std::move(config), options));
+  auto release = std::make_shared<absl::Notification>();
+  MP_ASSERT_OK(session->SetSidePacket(
+      "release",
+      MakePacket<std::shared_ptr<absl::Notification>>(release)));
+  OutputTimestamps outputs;
+  MP_ASSERT_OK(outputs.Observe(session.get()));
+  MP_ASSERT_OK(session->Start());
+
+  std::vector<bool> sent;
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(bool frame_sent,
+                            session->SendFrame(MakePacket<int>(i), i));
+    sent.push_back(frame_sent);
+  }
+  EXPECT_EQ(sent, std::vector<bool>({true, true, false}));
+
+  release->Notify();
+  session->WaitUntilIdle();
+  MP_ASSERT_OK_AND_ASSIGN(bool frame_sent,
+                          session->SendFrame(MakePacket<int>(3), 3));
+  EXPECT_TRUE(frame_sent);
+  MP_ASSERT_OK(session->Stop());
+
+  EXPECT_EQ(outputs.Get(), std::vector<int64_t>({0, 1000000, 3000000}));
+  const GraphSession::Stats stats = session->GetStats();
+  EXPECT_EQ(stats.frames_sent, 3);
+  EXPECT_EQ(stats.frames_dropped, 1);
+  EXPECT_EQ(stats.frames_finished, 3);
+}
+
+TEST(GraphSessionTest, SettlesFramesOnOutputs) {
+  GraphSession::Options options;
+  options.max_frames_in_flight = 1;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto session,
+      GraphSession::Create(PassThroughGraph("PassThroughCalculator"),
+                           options));
+  MP_ASSERT_OK(session->Start());
+
+  for (int i = 0; i < 5; ++i) {
+    session->WaitForFrameSlot();
+    MP_ASSERT_OK_AND_ASSIGN(bool sent,
+                            session->SendFrame(MakePacket<int>(i), i));
+    EXPECT_TRUE(sent);
+  }
+  session->WaitUntilIdle();
+  EXPECT_EQ(session->GetStats().frames_finished, 5);
+  MP_ASSERT_OK(session->Stop());
+  EXPECT_EQ(session->GetStats().frames_dropped, 0);
+}
+
+TEST(GraphSessionTest, SettlesFramesOnTimestampBoundUpdates) {
+  GraphSession::Options options;
+  options.max_frames_in_flight = 1;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto session,
+      GraphSession::Create(PassThroughGraph("SwallowFramesCalculator"),
+                           options));
+  OutputTimestamps outputs;
+  MP_ASSERT_OK(outputs.Observe(session.get()));
+  MP_ASSERT_OK(session->Start());
+
+  for (int i = 0; i < 5; ++i) {
+    session->WaitForFrameSlot();
+    MP_ASSERT_OK_AND_ASSIGN(bool sent,
+                            session->SendFrame(MakePacket<int>(i), i));
+    EXPECT_TRUE(sent);
+  }
+  session->WaitUntilIdle();
+  EXPECT_EQ(session->GetStats().frames_finished, 5);
+  MP_ASSERT_OK(session->Stop());
+
+  // Bound updates settle frames but are not handed to output callbacks.
+  EXPECT_TRUE(outputs.Get().empty());
+}
+
+}  // namespace
+}  // namespace prebuilt
+}  // namespace mediapipe
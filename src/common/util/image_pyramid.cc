@@ -0,0 +1,63 @@
+// "common/prebuilt/util/image_pyramid.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/image_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+ImagePyramid::ImagePyramid(cv::Mat base, std::shared_ptr<const void> owner,
+                           int min_level_size)
+    : base_(std::move(base)), owner_(std::move(owner)) {
+  min_level_size = std::max(min_level_size, 1);
+  while (std::min(base_.cols >> num_levels_, base_.rows >> num_levels_) >=
+         min_level_size) {
+    ++num_levels_;
+  }
+  absl::MutexLock lock(&mutex_);
+  levels_.resize(num_levels_ - 1);
+}
+
+int ImagePyramid::LevelFor(float region_width, float region_height,
+                           int output_width, int output_height) const {
+  // Level pixels per output pixel along the denser axis.
+  const float step = std::min(region_width / std::max(output_width, 1),
+                              region_height / std::max(output_height, 1));
+  if (!(step >= 2)) return 0;
+  return std::min(static_cast<int>(std::log2(step)), num_levels_ - 1);
+}
+
+const cv::Mat& ImagePyramid::Level(int index) const {
+  index = std::min(std::max(index, 0), num_levels_ - 1);
+  if (index == 0) return base_;
+  absl::MutexLock lock(&mutex_);
+  for (int i = 1; i <= index; ++i) {
+    if (levels_[i - 1]) continue;
+    const cv::Mat& above = i == 1 ? base_ : *levels_[i - 2];
+    auto level = absl::make_unique<cv::Mat>();
+    // Exact halving takes the 2x2 averaging fast path of INTER_AREA.
+    cv::resize(above, *level, cv::Size(base_.cols >> i, base_.rows >> i), 0,
+               0, cv::INTER_AREA);
+    levels_[i - 1] = std::move(level);
+  }
+  return *levels_[index - 1];
+}
+
+int64_t ImagePyramid::built_pixels() const {
+  absl::MutexLock lock(&mutex_);
+  int64_t pixels = 0;
+  for (const auto& level : levels_) {
+    if (level) pixels += static_cast<int64_t>(level->cols) * level->rows;
+  }
+  return pixels;
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,69 @@
+// "common/prebuilt/util/image_pyramid.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_PYRAMID_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_PYRAMID_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Halved copies of one RGB frame, shared by every model that takes its input
+// from the frame, so that the frame is converted once and each model crops
+// from the smallest copy that still has the detail its input needs.
+//
+// Level 0 is the frame itself, level i + 1 is level i averaged over 2x2
+// pixels, down to the last level whose sides are both at least
+// `min_level_size`. A level is built the first time it is asked for, from
+// the level above, and kept; levels no model needs are never built. Safe to
+// use from several threads.
+class ImagePyramid {
+ public:
+  // `base` is an 8-bit RGB image used as level 0 without a copy; `owner`
+  // keeps its pixels alive.
+  ImagePyramid(cv::Mat base, std::shared_ptr<const void> owner,
+               int min_level_size);
+
+  ImagePyramid(const ImagePyramid&) = delete;
+  ImagePyramid& operator=(const ImagePyramid&) = delete;
+
+  int width() const { return base_.cols; }
+  int height() const { return base_.rows; }
+  int num_levels() const { return num_levels_; }
+
+  // The level to sample a region of `region_width` x `region_height` level
+  // 0 pixels from into `output_width` x `output_height` pixels: the smallest
+  // level with at least as many pixels across the region as the output, so
+  // that bilinear sampling neither blurs nor skips pixels.
+  int LevelFor(float region_width, float region_height, int output_width,
+               int output_height) const;
+
+  // The image of level `index`, built if needed. Level i is (width() >> i) x
+  // (height() >> i) pixels and covers the same area as level 0; a pixel that
+  // falls off odd sizes is dropped.
+  const cv::Mat& Level(int index) const;
+
+  // Pixels of the levels built so far beyond level 0.
+  int64_t built_pixels() const;
+
+ private:
+  const cv::Mat base_;
+  const std::shared_ptr<const void> owner_;
+  int num_levels_ = 1;
+
+  mutable absl::Mutex mutex_;
+  // Levels 1 and up; empty until built. Built levels do not move.
+  mutable std::vector<std::unique_ptr<cv::Mat>> levels_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_PYRAMID_H_
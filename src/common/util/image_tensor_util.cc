@@ -0,0 +1,76 @@
+// "common/prebuilt/util/image_tensor_util.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/image_tensor_util.h"
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+float Clamp(float value, float min, float max) {
+  return std::min(std::max(value, min), max);
+}
+
+// Maps [-1.0, 1.0] to [0, 255].
+uint8 ToUint8(float value) {
+  return static_cast<uint8>(127.5f * (Clamp(value, -1.f, 1.f) + 1.f));
+}
+
+}  // namespace
+
+std::unique_ptr<ImageFrame> FloatPixelsToImageFrame(const float* pixels,
+                                                    int width, int height,
+                                                    int channels,
+                                                    bool flip_vertically) {
+  auto frame = absl::make_unique<ImageFrame>(
+      ImageFormat::SRGBA, width, height,
+      ImageFrame::kDefaultAlignmentBoundary);
+  for (int y = 0; y < height; ++y) {
+    const int row = flip_vertically ? height - 1 - y : y;
+    uint8* destination = frame->MutablePixelData() + row * frame->WidthStep();
+    const float* source = pixels + y * width * channels;
+    for (int x = 0; x < width; ++x) {
+      const float* pixel = source + x * channels;
+      destination[0] = ToUint8(pixel[0]);
+      destination[1] = ToUint8(pixel[channels == 1 ? 0 : 1]);
+      destination[2] = ToUint8(pixel[channels == 1 ? 0 : 2]);
+      destination[3] = 255;
+      destination += 4;
+    }
+  }
+  return frame;
+}
+
+void ResizeAndNormalizePixels(const float* pixels, int width, int height,
+                              int channels, int output_width,
+                              int output_height, bool zero_center,
+                              float* output) {
+  // Resizes straight into `output`, then normalizes it in place.
+  const float* source = pixels;
+  if (output_width != width || output_height != height) {
+    const cv::Mat input_mat(height, width, CV_32FC(channels),
+                            const_cast<float*>(pixels));
+    cv::Mat output_mat(output_height, output_width, CV_32FC(channels), output);
+    cv::resize(input_mat, output_mat, output_mat.size(), 0, 0,
+               cv::INTER_LINEAR);
+    source = output;
+  }
+
+  const int size = output_width * output_height * channels;
+  if (zero_center) {
+    for (int i = 0; i < size; ++i) output[i] = Clamp(source[i], -1.f, 1.f);
+  } else {
+    for (int i = 0; i < size; ++i) {
+      output[i] = 0.5f * (Clamp(source[i], -1.f, 1.f) + 1.f);
+    }
+  }
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
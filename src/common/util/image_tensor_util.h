@@ -0,0 +1,35 @@
+// "common/prebuilt/util/image_tensor_util.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_TENSOR_UTIL_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_TENSOR_UTIL_H_
+
+#include <memory>
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Converts an image-to-image model output, float pixels in [-1, 1] laid out
+// as [height, width, channels] with 1 or 3 channels, into an SRGBA
+// ImageFrame. Single channel pixels are replicated to RGB, alpha is opaque.
+std::unique_ptr<ImageFrame> FloatPixelsToImageFrame(const float* pixels,
+                                                    int width, int height,
+                                                    int channels,
+                                                    bool flip_vertically);
+
+// Prepares an image-to-image model output as the input of another model.
+// Pixels are resized from `width` x `height` to `output_width` x
+// `output_height`, clamped to [-1, 1] and, unless `zero_center` is set,
+// mapped to [0, 1]. `output` must hold output_width * output_height *
+// channels floats.
+void ResizeAndNormalizePixels(const float* pixels, int width, int height,
+                              int channels, int output_width,
+                              int output_height, bool zero_center,
+                              float* output);
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_IMAGE_TENSOR_UTIL_H_
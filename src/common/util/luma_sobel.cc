@@ -0,0 +1,264 @@
+// "common/prebuilt/util/luma_sobel.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/luma_sobel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+// Rows filtered together. With the two context rows, 8 rows of 1080p
+// luminance are ~38 KB.
+constexpr int kTileRows = 8;
+
+// The luminance weights of LuminanceCalculator, 0.2125, 0.7154 and 0.0721, in
+// 1/256 steps that add up to 256 so that white stays 255.
+constexpr int kWeightR = 54;
+constexpr int kWeightG = 183;
+constexpr int kWeightB = 19;
+
+inline int16_t Luma(const uint8_t* pixel) {
+  return (kWeightR * pixel[0] + kWeightG * pixel[1] + kWeightB * pixel[2] +
+          128) >>
+         8;
+}
+
+void LumaRow(const uint8_t* src, int width, int channels, int16_t* luma) {
+  int x = 0;
+#if defined(__SSE2__)
+  // Deinterleaving RGB takes byte shuffles SSE2 lacks; RGB rows stay scalar.
+  if (channels == 4) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(kWeightR, kWeightG, kWeightB, 0,
+                                           kWeightR, kWeightG, kWeightB, 0);
+    const __m128i round = _mm_set1_epi32(128);
+    // Luminance of 4 RGBA pixels as 32-bit lanes.
+    auto luma4 = [&](__m128i pixels) {
+      const __m128 lo = _mm_castsi128_ps(
+          _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights));
+      const __m128 hi = _mm_castsi128_ps(
+          _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights));
+      // madd leaves r * wr + g * wg and b * wb of each pixel side by side.
+      const __m128i rg =
+          _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+      const __m128i b =
+          _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+      return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(rg, b), round), 8);
+    };
+    for (; x + 8 <= width; x += 8) {
+      const uint8_t* pixels = src + x * 4;
+      const __m128i first = luma4(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels)));
+      const __m128i second = luma4(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 16)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + x),
+                       _mm_packs_epi32(first, second));
+    }
+  }
+#elif defined(__ARM_NEON)
+  const uint8x8_t weight_r = vdup_n_u8(kWeightR);
+  const uint8x8_t weight_g = vdup_n_u8(kWeightG);
+  const uint8x8_t weight_b = vdup_n_u8(kWeightB);
+  for (; x + 8 <= width; x += 8) {
+    uint8x8_t r, g, b;
+    if (channels == 4) {
+      const uint8x8x4_t pixels = vld4_u8(src + x * 4);
+      r = pixels.val[0];
+      g = pixels.val[1];
+      b = pixels.val[2];
+    } else {
+      const uint8x8x3_t pixels = vld3_u8(src + x * 3);
+      r = pixels.val[0];
+      g = pixels.val[1];
+      b = pixels.val[2];
+    }
+    uint16x8_t sum = vmull_u8(r, weight_r);
+    sum = vmlal_u8(sum, g, weight_g);
+    sum = vmlal_u8(sum, b, weight_b);
+    vst1q_s16(luma + x, vreinterpretq_s16_u16(vrshrq_n_u16(sum, 8)));
+  }
+#endif
+  for (; x < width; ++x) {
+    luma[x] = Luma(src + x * channels);
+  }
+}
+
+// Gradient magnitudes of the center row. Each row has a valid pixel at -1 and
+// at `width`.
+void SobelRow(const int16_t* above, const int16_t* center,
+              const int16_t* below, int width, uint8_t* magnitude) {
+  int x = 0;
+#if defined(__SSE2__)
+  for (; x + 8 <= width; x += 8) {
+    auto load = [x](const int16_t* row, int offset) {
+      return _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(row + x + offset));
+    };
+    const __m128i above_left = load(above, -1);
+    const __m128i above_right = load(above, 1);
+    const __m128i below_left = load(below, -1);
+    const __m128i below_right = load(below, 1);
+    const __m128i left = _mm_add_epi16(
+        _mm_add_epi16(above_left, below_left),
+        _mm_slli_epi16(load(center, -1), 1));
+    const __m128i right = _mm_add_epi16(
+        _mm_add_epi16(above_right, below_right),
+        _mm_slli_epi16(load(center, 1), 1));
+    const __m128i top = _mm_add_epi16(
+        _mm_add_epi16(above_left, above_right),
+        _mm_slli_epi16(load(above, 0), 1));
+    const __m128i bottom = _mm_add_epi16(
+        _mm_add_epi16(below_left, below_right),
+        _mm_slli_epi16(load(below, 0), 1));
+    const __m128i horizontal = _mm_sub_epi16(right, left);
+    const __m128i vertical = _mm_sub_epi16(top, bottom);
+    // h * h + v * v in 32 bits, at most 2 * 1020^2.
+    const __m128i lo = _mm_unpacklo_epi16(horizontal, vertical);
+    const __m128i hi = _mm_unpackhi_epi16(horizontal, vertical);
+    const __m128i length_lo = _mm_cvtps_epi32(
+        _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo))));
+    const __m128i length_hi = _mm_cvtps_epi32(
+        _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi))));
+    const __m128i length = _mm_packs_epi32(length_lo, length_hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(magnitude + x),
+                     _mm_packus_epi16(length, length));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  // vsqrtq_f32 and vcvtnq_s32_f32 are AArch64 only.
+  for (; x + 8 <= width; x += 8) {
+    const int16x8_t above_left = vld1q_s16(above + x - 1);
+    const int16x8_t above_right = vld1q_s16(above + x + 1);
+    const int16x8_t below_left = vld1q_s16(below + x - 1);
+    const int16x8_t below_right = vld1q_s16(below + x + 1);
+    const int16x8_t left =
+        vaddq_s16(vaddq_s16(above_left, below_left),
+                  vshlq_n_s16(vld1q_s16(center + x - 1), 1));
+    const int16x8_t right =
+        vaddq_s16(vaddq_s16(above_right, below_right),
+                  vshlq_n_s16(vld1q_s16(center + x + 1), 1));
+    const int16x8_t top = vaddq_s16(vaddq_s16(above_left, above_right),
+                                    vshlq_n_s16(vld1q_s16(above + x), 1));
+    const int16x8_t bottom = vaddq_s16(vaddq_s16(below_left, below_right),
+                                       vshlq_n_s16(vld1q_s16(below + x), 1));
+    const int16x8_t horizontal = vsubq_s16(right, left);
+    const int16x8_t vertical = vsubq_s16(top, bottom);
+    int32x4_t lo = vmull_s16(vget_low_s16(horizontal),
+                             vget_low_s16(horizontal));
+    lo = vmlal_s16(lo, vget_low_s16(vertical), vget_low_s16(vertical));
+    int32x4_t hi = vmull_s16(vget_high_s16(horizontal),
+                             vget_high_s16(horizontal));
+    hi = vmlal_s16(hi, vget_high_s16(vertical), vget_high_s16(vertical));
+    const int32x4_t length_lo =
+        vcvtnq_s32_f32(vsqrtq_f32(vcvtq_f32_s32(lo)));
+    const int32x4_t length_hi =
+        vcvtnq_s32_f32(vsqrtq_f32(vcvtq_f32_s32(hi)));
+    const int16x8_t length =
+        vcombine_s16(vqmovn_s32(length_lo), vqmovn_s32(length_hi));
+    vst1_u8(magnitude + x, vqmovun_s16(length));
+  }
+#endif
+  for (; x < width; ++x) {
+    const int horizontal = (above[x + 1] + 2 * center[x + 1] + below[x + 1]) -
+                           (above[x - 1] + 2 * center[x - 1] + below[x - 1]);
+    const int vertical = (above[x - 1] + 2 * above[x] + above[x + 1]) -
+                         (below[x - 1] + 2 * below[x] + below[x + 1]);
+    const float length =
+        std::sqrt(static_cast<float>(horizontal * horizontal +
+                                     vertical * vertical));
+    magnitude[x] = std::min(255L, std::lround(length));
+  }
+}
+
+// Writes `magnitude` to the color channels of a row, with opaque alpha.
+void ExpandRow(const uint8_t* magnitude, int width, int channels,
+               uint8_t* dst) {
+  int x = 0;
+#if defined(__SSE2__)
+  if (channels == 4) {
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for (; x + 8 <= width; x += 8) {
+      const __m128i values = _mm_loadl_epi64(
+          reinterpret_cast<const __m128i*>(magnitude + x));
+      const __m128i pairs = _mm_unpacklo_epi8(values, values);
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dst + x * 4),
+          _mm_or_si128(_mm_unpacklo_epi16(pairs, pairs), alpha));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dst + x * 4 + 16),
+          _mm_or_si128(_mm_unpackhi_epi16(pairs, pairs), alpha));
+    }
+  }
+#elif defined(__ARM_NEON)
+  const uint8x8_t alpha = vdup_n_u8(255);
+  for (; x + 8 <= width; x += 8) {
+    const uint8x8_t values = vld1_u8(magnitude + x);
+    if (channels == 4) {
+      const uint8x8x4_t pixels = {{values, values, values, alpha}};
+      vst4_u8(dst + x * 4, pixels);
+    } else {
+      const uint8x8x3_t pixels = {{values, values, values}};
+      vst3_u8(dst + x * 3, pixels);
+    }
+  }
+#endif
+  for (; x < width; ++x) {
+    uint8_t* pixel = dst + x * channels;
+    pixel[0] = pixel[1] = pixel[2] = magnitude[x];
+    if (channels == 4) pixel[3] = 255;
+  }
+}
+
+}  // namespace
+
+void LumaSobelFilter::Apply(const uint8_t* src, int src_step,
+                            int src_channels, int width, int height,
+                            uint8_t* dst, int dst_step, int dst_channels) {
+  if (width <= 0 || height <= 0) return;
+  const int stride = width + 2;
+  // Slot 0 holds the row above the tile, the next kTileRows slots the tile
+  // and the last one the row below.
+  luma_.resize((kTileRows + 2) * stride);
+  magnitude_.resize(width);
+  auto slot = [this, stride](int index) {
+    return luma_.data() + index * stride + 1;
+  };
+  auto convert = [&](int y, int index) {
+    int16_t* row = slot(index);
+    LumaRow(src + std::min(y, height - 1) * src_step, width, src_channels,
+            row);
+    row[-1] = row[0];
+    row[width] = row[width - 1];
+  };
+
+  // Above the first row is the first row again.
+  convert(0, 1);
+  std::memcpy(slot(0) - 1, slot(1) - 1, stride * sizeof(int16_t));
+  for (int top = 0; top < height; top += kTileRows) {
+    const int rows = std::min(kTileRows, height - top);
+    // Slots 0 and 1 already hold rows top - 1 and top.
+    for (int i = 1; i <= rows; ++i) {
+      convert(top + i, i + 1);
+    }
+    for (int i = 0; i < rows; ++i) {
+      SobelRow(slot(i), slot(i + 1), slot(i + 2), width, magnitude_.data());
+      ExpandRow(magnitude_.data(), width, dst_channels,
+                dst + (top + i) * dst_step);
+    }
+    // The last two rows are the context of the next tile.
+    std::memmove(slot(0) - 1, slot(rows) - 1, 2 * stride * sizeof(int16_t));
+  }
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,42 @@
+// "common/prebuilt/util/luma_sobel.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_LUMA_SOBEL_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_LUMA_SOBEL_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Computes the Sobel gradient magnitude of the luminance of an interleaved
+// 8-bit RGB or RGBA image, as LuminanceCalculator followed by
+// SobelEdgesCalculator do on GPU, without a luminance frame in between.
+//
+// The image is walked in tiles of rows. The luminance of a tile, plus one row
+// of context above and below, goes into a buffer of a few rows that stays in
+// cache while the 3x3 Sobel runs over the tile; the context rows carry over
+// to the next tile. Luminance, gradients and magnitudes are computed eight
+// pixels at a time with SSE2 or NEON, and in plain C++ elsewhere. Borders
+// repeat the edge pixels, like a clamped texture.
+//
+// The magnitude is written to every color channel of `dst`, clamped to 255;
+// alpha is set to 255. Keeps its buffers between calls. Not thread-safe.
+class LumaSobelFilter {
+ public:
+  // `src_channels` and `dst_channels` are 3 or 4. `src` and `dst` must not
+  // overlap.
+  void Apply(const uint8_t* src, int src_step, int src_channels, int width,
+             int height, uint8_t* dst, int dst_step, int dst_channels);
+
+ private:
+  // Luminance rows padded by one pixel on both sides.
+  std::vector<int16_t> luma_;
+  std::vector<uint8_t> magnitude_;
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_LUMA_SOBEL_H_
@@ -0,0 +1,144 @@
+// "common/prebuilt/util/model_registry.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/model_registry.h"
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/tflite/cpu_op_resolver.h"
+#include "tensorflow/lite/kernels/register.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+// Interpreters keep pointers into the resolver they were built with. Pooled
+// interpreters outlive the graph that created them, so the resolvers live for
+// the whole process instead of coming from a graph side packet.
+const tflite::OpResolver& GetOpResolver(bool use_mediapipe_custom_ops) {
+  static const auto* builtin_resolver =
+      new tflite::ops::builtin::BuiltinOpResolver();
+  static const auto* custom_resolver = new CpuOpResolver();
+  if (use_mediapipe_custom_ops) return *custom_resolver;
+  return *builtin_resolver;
+}
+
+}  // namespace
+
+InterpreterLease& InterpreterLease::operator=(InterpreterLease&& other) {
+  if (this != &other) {
+    if (interpreter_) {
+      registry_->ReleaseInterpreter(key_, std::move(interpreter_));
+    }
+    registry_ = other.registry_;
+    key_ = std::move(other.key_);
+    model_ = std::move(other.model_);
+    interpreter_ = std::move(other.interpreter_);
+  }
+  return *this;
+}
+
+InterpreterLease::~InterpreterLease() {
+  if (interpreter_) {
+    registry_->ReleaseInterpreter(key_, std::move(interpreter_));
+  }
+}
+
+ModelRegistry& ModelRegistry::GetInstance() {
+  static ModelRegistry* registry = new ModelRegistry();
+  return *registry;
+}
+
+absl::StatusOr<std::shared_ptr<tflite::FlatBufferModel>>
+ModelRegistry::GetModel(const std::string& path) {
+  absl::MutexLock lock(&mutex_);
+  auto it = models_.find(path);
+  if (it != models_.end()) {
+    ++stats_.model_hits;
+    return it->second;
+  }
+
+  ++stats_.model_misses;
+  // BuildFromFile variants memory map the file rather than reading it.
+  std::shared_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::VerifyAndBuildFromFile(path.c_str());
+  RET_CHECK(model) << "Failed to load TfLite model from " << path;
+  models_[path] = model;
+  return model;
+}
+
+absl::StatusOr<InterpreterLease> ModelRegistry::AcquireInterpreter(
+    const InterpreterKey& key) {
+  InterpreterLease lease;
+  lease.registry_ = this;
+  lease.key_ = key;
+  ASSIGN_OR_RETURN(lease.model_, GetModel(key.model_path));
+
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& pool = idle_interpreters_[key];
+    if (!pool.empty()) {
+      ++stats_.interpreter_hits;
+      lease.interpreter_ = std::move(pool.back());
+      pool.pop_back();
+      return std::move(lease);
+    }
+    ++stats_.interpreter_misses;
+  }
+
+  tflite::InterpreterBuilder builder(
+      *lease.model_, GetOpResolver(key.use_mediapipe_custom_ops));
+  RET_CHECK_EQ(builder(&lease.interpreter_), kTfLiteOk);
+  RET_CHECK(lease.interpreter_);
+  if (key.num_threads > 0) {
+    lease.interpreter_->SetNumThreads(key.num_threads);
+  }
+  if (key.batch_size > 0) {
+    for (const int input : lease.interpreter_->inputs()) {
+      const TfLiteIntArray* dims = lease.interpreter_->tensor(input)->dims;
+      RET_CHECK_GT(dims->size, 0);
+      std::vector<int> shape(dims->data, dims->data + dims->size);
+      shape[0] = key.batch_size;
+      RET_CHECK_EQ(lease.interpreter_->ResizeInputTensor(input, shape),
+                   kTfLiteOk);
+    }
+  }
+  // Fails for a batch size the model's ops cannot take, e.g. a reshape to a
+  // constant batch of 1.
+  RET_CHECK_EQ(lease.interpreter_->AllocateTensors(), kTfLiteOk)
+      << "Failed to allocate tensors for " << key.model_path
+      << " with batch size " << key.batch_size;
+  return std::move(lease);
+}
+
+void ModelRegistry::ReleaseInterpreter(
+    const InterpreterKey& key,
+    std::unique_ptr<tflite::Interpreter> interpreter) {
+  absl::MutexLock lock(&mutex_);
+  idle_interpreters_[key].push_back(std::move(interpreter));
+}
+
+void ModelRegistry::EvictUnused() {
+  absl::MutexLock lock(&mutex_);
+  // Leased interpreters hold their own model reference, so only idle ones have
+  // to go before the models can be unmapped.
+  idle_interpreters_.clear();
+  for (auto it = models_.begin(); it != models_.end();) {
+    if (it->second.use_count() == 1) {
+      it = models_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+ModelRegistry::Stats ModelRegistry::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,114 @@
+// "common/prebuilt/util/model_registry.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_MODEL_REGISTRY_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_MODEL_REGISTRY_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/status.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Identifies a prepared interpreter. Interpreters built from the same model
+// with the same settings are interchangeable.
+struct InterpreterKey {
+  std::string model_path;
+  int num_threads = -1;
+  // Resolve MediaPipe custom ops (e.g. Convolution2DTransposeBias) in addition
+  // to the TFLite builtins.
+  bool use_mediapipe_custom_ops = false;
+  // Batch dimension the inputs are resized to before allocation, for running
+  // several inputs in one Invoke. 0 keeps the shapes of the model.
+  int batch_size = 0;
+
+  bool operator<(const InterpreterKey& other) const {
+    return std::tie(model_path, num_threads, use_mediapipe_custom_ops,
+                    batch_size) <
+           std::tie(other.model_path, other.num_threads,
+                    other.use_mediapipe_custom_ops, other.batch_size);
+  }
+};
+
+class ModelRegistry;
+
+// Exclusive handle on a prepared interpreter. The interpreter goes back to the
+// registry's pool when the lease is destroyed, so the next graph asking for the
+// same key skips InterpreterBuilder and AllocateTensors.
+class InterpreterLease {
+ public:
+  InterpreterLease() = default;
+  InterpreterLease(InterpreterLease&& other) = default;
+  InterpreterLease& operator=(InterpreterLease&& other);
+  ~InterpreterLease();
+
+  tflite::Interpreter* get() const { return interpreter_.get(); }
+  tflite::Interpreter* operator->() const { return interpreter_.get(); }
+
+ private:
+  friend class ModelRegistry;
+
+  ModelRegistry* registry_ = nullptr;
+  InterpreterKey key_;
+  // Keeps the mapped model alive for as long as the interpreter is in use.
+  std::shared_ptr<tflite::FlatBufferModel> model_;
+  std::unique_ptr<tflite::Interpreter> interpreter_;
+};
+
+// Process-wide cache of .tflite models and prepared interpreters.
+//
+// Models are memory mapped and verified once per process, then shared by
+// reference count between every graph, wrapper instance and graph restart that
+// asks for the same path. Entries stay mapped after the last user goes away so
+// that a restarted graph starts warm; call EvictUnused() to drop them.
+class ModelRegistry {
+ public:
+  static ModelRegistry& GetInstance();
+
+  // Returns the mapped model at `path`, loading and verifying it on first use.
+  absl::StatusOr<std::shared_ptr<tflite::FlatBufferModel>> GetModel(
+      const std::string& path);
+
+  // Leases an interpreter with tensors already allocated, building one only
+  // when the pool for `key` is empty.
+  absl::StatusOr<InterpreterLease> AcquireInterpreter(
+      const InterpreterKey& key);
+
+  // Unmaps models and frees pooled interpreters nobody currently holds.
+  void EvictUnused();
+
+  struct Stats {
+    int model_hits = 0;
+    int model_misses = 0;
+    int interpreter_hits = 0;
+    int interpreter_misses = 0;
+  };
+  Stats GetStats() const;
+
+ private:
+  ModelRegistry() = default;
+
+  friend class InterpreterLease;
+  void ReleaseInterpreter(const InterpreterKey& key,
+                          std::unique_ptr<tflite::Interpreter> interpreter);
+
+  mutable absl::Mutex mutex_;
+  std::map<std::string, std::shared_ptr<tflite::FlatBufferModel>> models_
+      ABSL_GUARDED_BY(mutex_);
+  std::map<InterpreterKey, std::vector<std::unique_ptr<tflite::Interpreter>>>
+      idle_interpreters_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_MODEL_REGISTRY_H_
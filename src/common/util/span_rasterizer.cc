@@ -0,0 +1,398 @@
+// "common/prebuilt/util/span_rasterizer.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/span_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+// Rows drawn together. 16 rows of a 1080p RGB frame are ~90 KB, which stays
+// in L2 while every shape crossing the band is drawn.
+constexpr int kBandRows = 16;
+
+// Coverage is blended in 1/128 steps, so that (color - pixel) * alpha fits in
+// a signed 16-bit lane.
+constexpr float kAlphaScale = 128.0f;
+constexpr int kAlphaShift = 7;
+
+inline float Min(float a, float b) { return a < b ? a : b; }
+inline float Max(float a, float b) { return a > b ? a : b; }
+inline float Clamp01(float value) { return Min(Max(value, 0.0f), 1.0f); }
+
+template <typename T>
+T Splat(float value);
+template <>
+inline float Splat<float>(float value) {
+  return value;
+}
+
+// GCC does not vectorize the span loops at -O2, so they are written against
+// SSE2 or NEON directly. The scalar versions handle the tail of each span and
+// other targets.
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define PREBUILT_SPAN_RASTERIZER_SIMD 1
+#endif
+
+#if defined(__SSE2__)
+struct Float4 {
+  __m128 v;
+};
+template <>
+inline Float4 Splat<Float4>(float value) {
+  return {_mm_set1_ps(value)};
+}
+inline Float4 Ramp4(float first) {
+  return {_mm_setr_ps(first, first + 1, first + 2, first + 3)};
+}
+inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Float4 Min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline Float4 Max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+
+// Stores the coverage of 4 pixels once per channel byte: c0 c0 c0 c1 ...
+inline void StoreRgb(float* out, Float4 c) {
+  _mm_storeu_ps(out, _mm_shuffle_ps(c.v, c.v, _MM_SHUFFLE(1, 0, 0, 0)));
+  _mm_storeu_ps(out + 4, _mm_shuffle_ps(c.v, c.v, _MM_SHUFFLE(2, 2, 1, 1)));
+  _mm_storeu_ps(out + 8, _mm_shuffle_ps(c.v, c.v, _MM_SHUFFLE(3, 3, 3, 2)));
+}
+
+// Like StoreRgb, with zero coverage for the alpha bytes: c0 c0 c0 0 c1 ...
+inline void StoreRgba(float* out, Float4 c) {
+  const __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+  _mm_storeu_ps(out, _mm_and_ps(
+                         _mm_shuffle_ps(c.v, c.v, _MM_SHUFFLE(0, 0, 0, 0)),
+                         rgb));
+  _mm_storeu_ps(out + 4, _mm_and_ps(_mm_shuffle_ps(c.v, c.v,
+                                                   _MM_SHUFFLE(1, 1, 1, 1)),
+                                    rgb));
+  _mm_storeu_ps(out + 8, _mm_and_ps(_mm_shuffle_ps(c.v, c.v,
+                                                   _MM_SHUFFLE(2, 2, 2, 2)),
+                                    rgb));
+  _mm_storeu_ps(out + 12, _mm_and_ps(_mm_shuffle_ps(c.v, c.v,
+                                                    _MM_SHUFFLE(3, 3, 3, 3)),
+                                     rgb));
+}
+
+// Blends 8 channel bytes toward `color` by `coverage`.
+inline void Blend8(const int16_t* color, const float* coverage,
+                   uint8_t* pixels) {
+  const __m128 scale = _mm_set1_ps(kAlphaScale);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128i alpha = _mm_packs_epi32(
+      _mm_cvttps_epi32(
+          _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(coverage), scale), half)),
+      _mm_cvttps_epi32(
+          _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(coverage + 4), scale), half)));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i pixel = _mm_unpacklo_epi8(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels)), zero);
+  const __m128i target =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(color));
+  __m128i delta = _mm_mullo_epi16(_mm_sub_epi16(target, pixel), alpha);
+  delta = _mm_srai_epi16(
+      _mm_add_epi16(delta, _mm_set1_epi16(1 << (kAlphaShift - 1))),
+      kAlphaShift);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(pixels),
+                   _mm_packus_epi16(_mm_add_epi16(pixel, delta), zero));
+}
+#elif defined(__ARM_NEON)
+struct Float4 {
+  float32x4_t v;
+};
+template <>
+inline Float4 Splat<Float4>(float value) {
+  return {vdupq_n_f32(value)};
+}
+inline Float4 Ramp4(float first) {
+  const float lanes[4] = {first, first + 1, first + 2, first + 3};
+  return {vld1q_f32(lanes)};
+}
+inline Float4 operator+(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+inline Float4 Min(Float4 a, Float4 b) { return {vminq_f32(a.v, b.v)}; }
+inline Float4 Max(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+
+inline void StoreRgb(float* out, Float4 c) {
+  float32x4x3_t lanes;
+  lanes.val[0] = lanes.val[1] = lanes.val[2] = c.v;
+  vst3q_f32(out, lanes);
+}
+
+inline void StoreRgba(float* out, Float4 c) {
+  float32x4x4_t lanes;
+  lanes.val[0] = lanes.val[1] = lanes.val[2] = c.v;
+  lanes.val[3] = vdupq_n_f32(0.0f);
+  vst4q_f32(out, lanes);
+}
+
+inline void Blend8(const int16_t* color, const float* coverage,
+                   uint8_t* pixels) {
+  const float32x4_t scale = vdupq_n_f32(kAlphaScale);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const int16x8_t alpha = vcombine_s16(
+      vmovn_s32(vcvtq_s32_f32(vmlaq_f32(half, vld1q_f32(coverage), scale))),
+      vmovn_s32(
+          vcvtq_s32_f32(vmlaq_f32(half, vld1q_f32(coverage + 4), scale))));
+  const int16x8_t pixel = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(pixels)));
+  const int16x8_t delta = vrshrq_n_s16(
+      vmulq_s16(vsubq_s16(vld1q_s16(color), pixel), alpha), kAlphaShift);
+  vst1_u8(pixels, vqmovun_s16(vaddq_s16(pixel, delta)));
+}
+#endif
+
+#if defined(PREBUILT_SPAN_RASTERIZER_SIMD)
+inline Float4 Clamp01(Float4 value) {
+  return Min(Max(value, Splat<Float4>(0.0f)), Splat<Float4>(1.0f));
+}
+#endif
+
+// Coverage of pixels whose centers are `ax` right of and `ay` below the
+// segment start. Distance to the segment is ramped off across one pixel at
+// the edge; working on squared distances keeps sqrt out of the loop.
+template <typename T>
+inline T CapsuleCoverage(T ax, T ay, T dx, T dy, T inv_length2, T reach2,
+                         T inv_ramp) {
+  const T t = Clamp01((ax * dx + ay * dy) * inv_length2);
+  const T ex = ax - t * dx;
+  const T ey = ay - t * dy;
+  return Clamp01((reach2 - (ex * ex + ey * ey)) * inv_ramp);
+}
+
+// Coverage of pixels whose centers are at `px` by a box spanning
+// [left, right], already scaled by the row's coverage `cover_y`.
+template <typename T>
+inline T BoxCoverage(T px, T left, T right, T cover_y) {
+  return Clamp01(Min(px - left, right - px) + Splat<T>(0.5f)) * cover_y;
+}
+
+// Writes `coverage(x)` for every channel byte of `count` pixels, x being the
+// pixel offset in the span. `coverage` takes float and, with SIMD, Float4.
+template <typename Coverage>
+void CoverBytes(const Coverage& coverage, int count, int channels,
+                float* out) {
+  int i = 0;
+#if defined(PREBUILT_SPAN_RASTERIZER_SIMD)
+  const Float4 step = Splat<Float4>(4.0f);
+  Float4 x = Ramp4(0.0f);
+  if (channels == 4) {
+    for (; i + 4 <= count; i += 4, x = x + step) {
+      StoreRgba(out + i * 4, coverage(x));
+    }
+  } else {
+    for (; i + 4 <= count; i += 4, x = x + step) {
+      StoreRgb(out + i * 3, coverage(x));
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    float* bytes = out + i * channels;
+    bytes[0] = bytes[1] = bytes[2] = coverage(static_cast<float>(i));
+    if (channels == 4) bytes[3] = 0.0f;
+  }
+}
+
+void BlendBytes(const int16_t* color_pattern, const float* coverage,
+                int bytes, int channels, uint8_t* pixels) {
+  int j = 0;
+#if defined(PREBUILT_SPAN_RASTERIZER_SIMD)
+  for (; j + 8 <= bytes; j += 8) {
+    Blend8(color_pattern + j % channels, coverage + j, pixels + j);
+  }
+#endif
+  for (; j < bytes; ++j) {
+    const int alpha = static_cast<int>(coverage[j] * kAlphaScale + 0.5f);
+    const int pixel = pixels[j];
+    pixels[j] = pixel + (((color_pattern[j % channels] - pixel) * alpha +
+                          (1 << (kAlphaShift - 1))) >>
+                         kAlphaShift);
+  }
+}
+
+}  // namespace
+
+void SpanRasterizer::AddLine(float x0, float y0, float x1, float y1,
+                             float thickness, Color color) {
+  const float radius = Max(thickness, 1.0f) * 0.5f;
+  const float inner = Max(radius - 0.5f, 0.0f);
+  Shape shape = {};
+  shape.kind = Shape::kCapsule;
+  shape.x0 = x0;
+  shape.y0 = y0;
+  shape.x1 = x1;
+  shape.y1 = y1;
+  shape.dx = x1 - x0;
+  shape.dy = y1 - y0;
+  const float length2 = shape.dx * shape.dx + shape.dy * shape.dy;
+  shape.inv_length2 = length2 > 1e-6f ? 1.0f / length2 : 0.0f;
+  shape.inv_dy = std::abs(shape.dy) > 1e-6f ? 1.0f / shape.dy : 0.0f;
+  shape.reach = radius + 0.5f;
+  shape.reach2 = shape.reach * shape.reach;
+  shape.inv_ramp = 1.0f / (shape.reach2 - inner * inner);
+  shape.color = color;
+  shape.min_row = std::floor(Min(y0, y1) - shape.reach);
+  shape.max_row = std::ceil(Max(y0, y1) + shape.reach);
+  shapes_.push_back(shape);
+}
+
+void SpanRasterizer::AddDisc(float x, float y, float radius, Color color) {
+  AddLine(x, y, x, y, radius * 2.0f, color);
+}
+
+void SpanRasterizer::AddRect(float left, float top, float right, float bottom,
+                             float rotation, float thickness, Color color) {
+  const float center_x = (left + right) * 0.5f;
+  const float center_y = (top + bottom) * 0.5f;
+  const float half_w = (right - left) * 0.5f;
+  const float half_h = (bottom - top) * 0.5f;
+  const float cos_r = std::cos(rotation), sin_r = std::sin(rotation);
+  float corner_x[4], corner_y[4];
+  const float signs[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+  for (int i = 0; i < 4; ++i) {
+    const float dx = signs[i][0] * half_w, dy = signs[i][1] * half_h;
+    corner_x[i] = center_x + dx * cos_r - dy * sin_r;
+    corner_y[i] = center_y + dx * sin_r + dy * cos_r;
+  }
+  for (int i = 0; i < 4; ++i) {
+    const int next = (i + 1) % 4;
+    AddLine(corner_x[i], corner_y[i], corner_x[next], corner_y[next],
+            thickness, color);
+  }
+}
+
+void SpanRasterizer::AddFilledRect(float left, float top, float right,
+                                   float bottom, Color color) {
+  Shape shape = {};
+  shape.kind = Shape::kBox;
+  shape.x0 = Min(left, right);
+  shape.y0 = Min(top, bottom);
+  shape.x1 = Max(left, right);
+  shape.y1 = Max(top, bottom);
+  shape.color = color;
+  shape.min_row = std::floor(shape.y0) - 1;
+  shape.max_row = std::ceil(shape.y1) + 1;
+  shapes_.push_back(shape);
+}
+
+bool SpanRasterizer::SpanOf(const Shape& shape, int row, int width,
+                            int* begin, int* end) const {
+  const float py = row + 0.5f;
+  float left, right;
+  if (shape.kind == Shape::kBox) {
+    if (py <= shape.y0 - 0.5f || py >= shape.y1 + 0.5f) return false;
+    left = shape.x0 - 1.0f;
+    right = shape.x1 + 1.0f;
+  } else {
+    // Only the part of the segment within `reach` of the row can cover it.
+    float t0 = 0, t1 = 1;
+    if (shape.inv_dy != 0) {
+      t0 = Clamp01((py - shape.reach - shape.y0) * shape.inv_dy);
+      t1 = Clamp01((py + shape.reach - shape.y0) * shape.inv_dy);
+    }
+    const float xa = shape.x0 + t0 * shape.dx;
+    const float xb = shape.x0 + t1 * shape.dx;
+    left = Min(xa, xb) - shape.reach;
+    right = Max(xa, xb) + shape.reach;
+  }
+  // Truncation stands in for floor and ceil once clamped to the image; the
+  // span may grow by a pixel of zero coverage.
+  *begin = left > 0 ? static_cast<int>(left) : 0;
+  *end = right < width - 1 ? static_cast<int>(right) + 2 : width;
+  return *begin < *end;
+}
+
+void SpanRasterizer::Cover(const Shape& shape, int row, int begin, int end,
+                           int channels) {
+  const float py = row + 0.5f;
+  const float px0 = begin + 0.5f;
+
+  if (shape.kind == Shape::kBox) {
+    const float cover_y = Clamp01(Min(py - shape.y0, shape.y1 - py) + 0.5f);
+    CoverBytes(
+        [&](auto x) {
+          using T = decltype(x);
+          return BoxCoverage(Splat<T>(px0) + x, Splat<T>(shape.x0),
+                             Splat<T>(shape.x1), Splat<T>(cover_y));
+        },
+        end - begin, channels, coverage_.data());
+    return;
+  }
+
+  const float ay = py - shape.y0;
+  const float ax0 = px0 - shape.x0;
+  CoverBytes(
+      [&](auto x) {
+        using T = decltype(x);
+        return CapsuleCoverage(Splat<T>(ax0) + x, Splat<T>(ay),
+                               Splat<T>(shape.dx), Splat<T>(shape.dy),
+                               Splat<T>(shape.inv_length2),
+                               Splat<T>(shape.reach2),
+                               Splat<T>(shape.inv_ramp));
+      },
+      end - begin, channels, coverage_.data());
+}
+
+void SpanRasterizer::Draw(uint8_t* pixels, int width, int height,
+                          int width_step, int channels) {
+  if (shapes_.empty()) return;
+  const int num_shapes = shapes_.size();
+  order_.resize(num_shapes);
+  for (int i = 0; i < num_shapes; ++i) {
+    order_[i] = i;
+    Shape& shape = shapes_[i];
+    const int16_t rgba[4] = {shape.color.r, shape.color.g, shape.color.b, 0};
+    for (int k = 0; k < 16; ++k) shape.color_pattern[k] = rgba[k % channels];
+  }
+  std::stable_sort(order_.begin(), order_.end(), [this](int a, int b) {
+    return shapes_[a].min_row < shapes_[b].min_row;
+  });
+  coverage_.resize(width * channels);
+  active_.clear();
+
+  int next = 0;
+  for (int band_top = 0; band_top < height; band_top += kBandRows) {
+    const int band_bottom = std::min(band_top + kBandRows, height) - 1;
+    bool added = false;
+    while (next < num_shapes &&
+           shapes_[order_[next]].min_row <= band_bottom) {
+      active_.push_back(order_[next++]);
+      added = true;
+    }
+    active_.erase(std::remove_if(active_.begin(), active_.end(),
+                                 [this, band_top](int i) {
+                                   return shapes_[i].max_row < band_top;
+                                 }),
+                  active_.end());
+    // Shapes are drawn in insertion order so that later ones end up on top.
+    if (added) std::sort(active_.begin(), active_.end());
+    if (active_.empty()) continue;
+
+    for (int row = band_top; row <= band_bottom; ++row) {
+      uint8_t* row_pixels = pixels + row * width_step;
+      for (const int index : active_) {
+        const Shape& shape = shapes_[index];
+        int begin, end;
+        if (!SpanOf(shape, row, width, &begin, &end)) continue;
+        Cover(shape, row, begin, end, channels);
+        BlendBytes(shape.color_pattern, coverage_.data(),
+                   (end - begin) * channels, channels,
+                   row_pixels + begin * channels);
+      }
+    }
+  }
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,86 @@
+// "common/prebuilt/util/span_rasterizer.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SPAN_RASTERIZER_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SPAN_RASTERIZER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Collects anti-aliased lines, discs and boxes and draws them all onto an
+// interleaved 8-bit RGB or RGBA image in a single top to bottom pass.
+//
+// The image is walked in bands of rows that stay in cache while every shape
+// crossing the band is drawn into it. Each shape covers one horizontal span
+// per row; coverage and blending for a span run four and eight channel bytes
+// at a time with SSE2 or NEON, and in plain C++ elsewhere. Shapes are drawn
+// in the order they were added.
+//
+// Coordinates are in pixels, with pixel centers at +0.5.
+class SpanRasterizer {
+ public:
+  struct Color {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+  };
+
+  // A line of the given thickness with round caps.
+  void AddLine(float x0, float y0, float x1, float y1, float thickness,
+               Color color);
+  // A filled disc.
+  void AddDisc(float x, float y, float radius, Color color);
+  // The outline of a rectangle rotated by `rotation` radians about its center.
+  void AddRect(float left, float top, float right, float bottom,
+               float rotation, float thickness, Color color);
+  // A filled axis-aligned box.
+  void AddFilledRect(float left, float top, float right, float bottom,
+                     Color color);
+
+  void Clear() { shapes_.clear(); }
+  bool empty() const { return shapes_.empty(); }
+  int size() const { return shapes_.size(); }
+
+  // Draws every shape onto `pixels`. `channels` is 3 or 4; alpha is kept.
+  void Draw(uint8_t* pixels, int width, int height, int width_step,
+            int channels);
+
+ private:
+  struct Shape {
+    enum Kind { kCapsule, kBox } kind;
+    // Capsule: segment end points. Box: left, top, right, bottom.
+    float x0, y0, x1, y1;
+    // Capsule terms that stay fixed across rows: the segment vector, its
+    // inverse squared length and inverse dy (0 when degenerate), how far
+    // coverage reaches from the segment, and the anti-aliasing ramp.
+    float dx, dy, inv_length2, inv_dy;
+    float reach, reach2, inv_ramp;
+    Color color;
+    // The color repeated over interleaved channels, filled in by Draw.
+    int16_t color_pattern[16];
+    // Rows covered, inclusive, before clipping to the image.
+    int min_row, max_row;
+  };
+
+  // Finds the pixels [begin, end) of `row` that `shape` may cover. Returns
+  // false when the shape misses the row.
+  bool SpanOf(const Shape& shape, int row, int width, int* begin,
+              int* end) const;
+  // Writes the coverage of `shape` over every channel byte of pixels
+  // [begin, end) of `row` to coverage_, starting at 0. Alpha bytes get none.
+  void Cover(const Shape& shape, int row, int begin, int end, int channels);
+
+  std::vector<Shape> shapes_;
+  // Per draw scratch, kept to avoid reallocating every frame.
+  std::vector<int> order_;
+  std::vector<int> active_;
+  std::vector<float> coverage_;
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SPAN_RASTERIZER_H_
@@ -0,0 +1,304 @@
+// "common/prebuilt/util/swappable_graph_session.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#include "mediapipe/examples/common/prebuilt/util/swappable_graph_session.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+// Adds the counts of `stats` past `baseline` to `total`.
+void AddStats(const GraphSession::Stats& stats,
+              const GraphSession::Stats& baseline,
+              GraphSession::Stats* total) {
+  total->frames_sent += stats.frames_sent - baseline.frames_sent;
+  total->frames_dropped += stats.frames_dropped - baseline.frames_dropped;
+  total->frames_finished += stats.frames_finished - baseline.frames_finished;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<SwappableGraphSession>>
+SwappableGraphSession::Create(CalculatorGraphConfig config, Options options) {
+  RET_CHECK(options.warmup_frame.IsEmpty() ||
+            options.session.max_frames_in_flight > 0)
+      << "Warm-up needs max_frames_in_flight to tell when it is done.";
+  RET_CHECK_GE(options.warmup_frames, 0);
+  auto session =
+      absl::WrapUnique(new SwappableGraphSession(std::move(options)));
+  session->initial_config_ = std::move(config);
+  return session;
+}
+
+SwappableGraphSession::SwappableGraphSession(Options options)
+    : options_(std::move(options)) {}
+
+SwappableGraphSession::~SwappableGraphSession() {
+  if (started_) Stop().IgnoreError();
+}
+
+absl::Status SwappableGraphSession::SetSidePacket(const std::string& name,
+                                                  Packet packet) {
+  RET_CHECK(!started_) << "Side packets must be set before Start().";
+  side_packets_[name] = std::move(packet);
+  return absl::OkStatus();
+}
+
+absl::Status SwappableGraphSession::ObservePackets(
+    const std::string& stream, GraphSession::PacketCallback callback) {
+  RET_CHECK(!started_) << "Outputs must be observed before Start().";
+  callbacks_[stream].push_back(std::move(callback));
+  return absl::OkStatus();
+}
+
+absl::Status SwappableGraphSession::Start() {
+  RET_CHECK(!started_) << "The session was already started.";
+  int id;
+  {
+    absl::MutexLock lock(&mutex_);
+    id = next_id_++;
+    live_id_ = id;
+  }
+  ASSIGN_OR_RETURN(Generation generation,
+                   Prepare(std::move(initial_config_), side_packets_, id));
+  generation.gate->live.store(true);
+  absl::MutexLock send_lock(&send_mutex_);
+  active_ = std::move(generation);
+  started_ = true;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> SwappableGraphSession::SendFrame(Packet frame,
+                                                      double seconds) {
+  RET_CHECK(started_) << "The session is not running.";
+  absl::MutexLock send_lock(&send_mutex_);
+  MaybeSwitch();
+  if (pending_cutoff_) {
+    // As stamped by GraphSession, short of a bump past an earlier frame.
+    pending_cutoff_->cutoff.store(
+        std::llround(Timestamp::kTimestampUnitsPerSecond * seconds));
+    pending_cutoff_.reset();
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    ++frames_offered_;
+  }
+  return active_.session->SendFrame(std::move(frame), seconds);
+}
+
+void SwappableGraphSession::WaitForFrameSlot() {
+  // Holding the lock keeps a switch from happening mid-wait; SendFrame()
+  // waits for it anyway.
+  absl::MutexLock send_lock(&send_mutex_);
+  MaybeSwitch();
+  active_.session->WaitForFrameSlot();
+}
+
+absl::Status SwappableGraphSession::Swap(
+    CalculatorGraphConfig config, std::map<std::string, Packet> side_packets) {
+  RET_CHECK(started_) << "The session is not running.";
+  int id;
+  {
+    absl::MutexLock lock(&mutex_);
+    RET_CHECK(!stopping_) << "The session is stopping.";
+    RET_CHECK(!swap_pending_) << "Another swap is still pending.";
+    swap_pending_ = true;
+    swap_status_ = absl::OkStatus();
+    id = next_id_++;
+  }
+  // The previous swap is done once nothing is pending.
+  if (swap_thread_.joinable()) swap_thread_.join();
+  for (auto& side_packet : side_packets) {
+    side_packets_[side_packet.first] = std::move(side_packet.second);
+  }
+  swap_thread_ = std::thread(&SwappableGraphSession::RunSwap, this,
+                             std::move(config), side_packets_, id);
+  return absl::OkStatus();
+}
+
+absl::Status SwappableGraphSession::WaitForSwap() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &SwappableGraphSession::SwapSettled));
+  return swap_status_;
+}
+
+absl::Status SwappableGraphSession::Stop() {
+  RET_CHECK(started_) << "The session was never started.";
+  {
+    absl::MutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  // Drains the graph being swapped out, or stops the one waiting to be
+  // swapped in.
+  if (swap_thread_.joinable()) swap_thread_.join();
+  absl::MutexLock send_lock(&send_mutex_);
+  return active_.session->Stop();
+}
+
+GraphSession::Stats SwappableGraphSession::GetStats() const {
+  GraphSession::Stats stats;
+  {
+    absl::MutexLock send_lock(&send_mutex_);
+    if (active_.session) {
+      AddStats(active_.session->GetStats(), active_.warmup, &stats);
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  AddStats(retired_stats_, GraphSession::Stats(), &stats);
+  return stats;
+}
+
+SwappableGraphSession::SwapStats SwappableGraphSession::GetSwapStats() const {
+  absl::MutexLock lock(&mutex_);
+  return swap_stats_;
+}
+
+absl::StatusOr<SwappableGraphSession::Generation>
+SwappableGraphSession::Prepare(
+    CalculatorGraphConfig config,
+    const std::map<std::string, Packet>& side_packets, int id) {
+  Generation generation;
+  generation.id = id;
+  generation.gate = std::make_shared<Gate>();
+  ASSIGN_OR_RETURN(generation.session,
+                   GraphSession::Create(std::move(config), options_.session));
+  GraphSession* session = generation.session.get();
+  for (const auto& side_packet : side_packets) {
+    MP_RETURN_IF_ERROR(
+        session->SetSidePacket(side_packet.first, side_packet.second));
+  }
+  // One observer per stream, so that the timestamp check sees each packet
+  // once.
+  std::vector<std::string> streams;
+  for (const auto& stream_callbacks : callbacks_) {
+    streams.push_back(stream_callbacks.first);
+  }
+  if (!callbacks_.count(options_.session.frame_output_stream)) {
+    streams.push_back(options_.session.frame_output_stream);
+  }
+  std::shared_ptr<Gate> gate = generation.gate;
+  for (const std::string& stream : streams) {
+    MP_RETURN_IF_ERROR(session->ObservePackets(
+        stream, [this, gate, id, stream](const Packet& packet) {
+          Deliver(*gate, id, stream, packet);
+        }));
+  }
+  MP_RETURN_IF_ERROR(session->Start());
+
+  if (!options_.warmup_frame.IsEmpty()) {
+    // Stamped within the first microseconds, before any camera frame.
+    for (int i = 0; i < options_.warmup_frames; ++i) {
+      session->WaitForFrameSlot();
+      MP_RETURN_IF_ERROR(
+          session->SendFrame(options_.warmup_frame, i * 1e-6).status());
+    }
+    session->WaitUntilIdle();
+  }
+  generation.warmup = session->GetStats();
+  return generation;
+}
+
+void SwappableGraphSession::RunSwap(CalculatorGraphConfig config,
+                                    std::map<std::string, Packet> side_packets,
+                                    int id) {
+  const absl::Time start = absl::Now();
+  absl::StatusOr<Generation> prepared =
+      Prepare(std::move(config), side_packets, id);
+  const double prepare_ms = absl::ToDoubleMilliseconds(absl::Now() - start);
+
+  Generation retired;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!prepared.ok()) {
+      swap_status_ = prepared.status();
+      swap_pending_ = false;
+      return;
+    }
+    swap_stats_.prepare_ms = prepare_ms;
+    ready_ = std::move(prepared).value();
+    mutex_.Await(
+        absl::Condition(this, &SwappableGraphSession::ReadyTakenOrStopping));
+    // Stopping before the next frame leaves the new graph unused.
+    retired = ready_.session ? std::move(ready_) : std::move(retired_);
+  }
+
+  // Frames already in the old graph still come out; new ones go elsewhere.
+  const absl::Status status = retired.session->Stop();
+  absl::MutexLock lock(&mutex_);
+  AddStats(retired.session->GetStats(), retired.warmup, &retired_stats_);
+  if (!status.ok()) swap_status_ = status;
+  swap_pending_ = false;
+}
+
+void SwappableGraphSession::MaybeSwitch() {
+  absl::MutexLock lock(&mutex_);
+  if (!ready_.session || stopping_) return;
+  retired_ = std::move(active_);
+  active_ = std::move(ready_);
+  ready_ = Generation();
+  pending_cutoff_ = retired_.gate;
+  active_.gate->live.store(true);
+  live_id_ = active_.id;
+  awaiting_first_output_ = true;
+  switch_time_ = absl::Now();
+}
+
+void SwappableGraphSession::Deliver(const Gate& gate, int id,
+                                    const std::string& stream,
+                                    const Packet& packet) {
+  absl::MutexLock delivery_lock(&delivery_mutex_);
+  // Outputs of warm-up frames stay with the graph.
+  if (!gate.live) return;
+  // The new graph answers for these frames, or will.
+  if (packet.Timestamp().Value() >= gate.cutoff) return;
+  // The old graph's late outputs, behind what the new one already gave.
+  auto last = last_delivered_.find(stream);
+  if (last != last_delivered_.end() && packet.Timestamp() <= last->second) {
+    return;
+  }
+  last_delivered_[stream] = packet.Timestamp();
+  auto callbacks = callbacks_.find(stream);
+  if (callbacks != callbacks_.end()) {
+    for (const auto& callback : callbacks->second) callback(packet);
+  }
+  if (stream == options_.session.frame_output_stream) OnFrameOutput(id);
+}
+
+void SwappableGraphSession::OnFrameOutput(int id) {
+  const absl::Time now = absl::Now();
+  absl::MutexLock lock(&mutex_);
+  if (id == live_id_ && awaiting_first_output_) {
+    awaiting_first_output_ = false;
+    // Without any earlier output, the gap starts at the switch.
+    const absl::Time since = last_output_time_ == absl::InfinitePast()
+                                 ? switch_time_
+                                 : last_output_time_;
+    swap_stats_.gap_ms = absl::ToDoubleMilliseconds(now - since);
+    swap_stats_.gap_frames =
+        std::max<int64_t>(0, frames_offered_ - last_output_offered_ - 1);
+    ++swap_stats_.swaps;
+    LOG(INFO) << "Swapped to graph " << id << ": prepared in "
+              << swap_stats_.prepare_ms << " ms, output gap "
+              << swap_stats_.gap_ms << " ms, " << swap_stats_.gap_frames
+              << " frames without output.";
+  }
+  last_output_time_ = now;
+  last_output_offered_ = frames_offered_;
+}
+
+bool SwappableGraphSession::SwapSettled() const { return !swap_pending_; }
+
+bool SwappableGraphSession::ReadyTakenOrStopping() const {
+  return !ready_.session || stopping_;
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
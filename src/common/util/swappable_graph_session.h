@@ -0,0 +1,205 @@
+// "common/prebuilt/util/swappable_graph_session.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/common
+
+#ifndef MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SWAPPABLE_GRAPH_SESSION_H_
+#define MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SWAPPABLE_GRAPH_SESSION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/graph_session.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// A GraphSession whose graph can be replaced while frames keep coming, e.g.
+// to change a threshold, a side packet such as num_poses, or the model.
+//
+// Swap() builds the new graph on a thread of its own: it initializes and
+// starts it, and pushes `warmup_frames` copies of `warmup_frame` through it
+// so that models are loaded and interpreters allocated off the frame path.
+// The next SendFrame() after that switches to the new graph, so every frame
+// goes to exactly one graph. The old graph then drains the frames it has in
+// flight and stops, on the same background thread.
+//
+// Observers are registered once and follow every graph; outputs of warm-up
+// frames are not passed on. While the old graph drains, both graphs produce
+// outputs, so they are delivered one packet at a time and, per stream, in
+// increasing timestamps: late outputs of the old graph at or behind what was
+// already delivered are dropped, as are its outputs for the timestamps handed
+// to the new graph. For each swap the session measures the gap
+// between the old graph's last output and the new graph's first one, in
+// milliseconds and in frames offered meanwhile beyond the one expected.
+//
+//   ASSIGN_OR_RETURN(auto session, SwappableGraphSession::Create(config));
+//   MP_RETURN_IF_ERROR(session->ObservePackets("output_video", callback));
+//   MP_RETURN_IF_ERROR(session->Start());
+//   ASSIGN_OR_RETURN(bool sent, session->SendFrame(frame, seconds));
+//   MP_RETURN_IF_ERROR(session->Swap(new_config, {{"num_poses", packet}}));
+//   ...
+//   MP_RETURN_IF_ERROR(session->Stop());
+class SwappableGraphSession {
+ public:
+  struct Options {
+    // Options of every graph's session. max_frames_in_flight must be set
+    // for warm-up, which waits for the warm-up frames to finish.
+    GraphSession::Options session;
+    // Frame pushed through a new graph before it takes over, of the type
+    // the input stream expects. Empty skips the warm-up.
+    Packet warmup_frame;
+    int warmup_frames = 2;
+  };
+
+  struct SwapStats {
+    int64_t swaps = 0;
+    // Of the last swap: time to initialize, start and warm up the new graph.
+    double prepare_ms = 0;
+    // Between the old graph's last output and the new graph's first.
+    double gap_ms = 0;
+    // Frames offered during the gap beyond the one expected between two
+    // outputs, i.e. frames that produced no output because of the swap.
+    int64_t gap_frames = 0;
+  };
+
+  static absl::StatusOr<std::unique_ptr<SwappableGraphSession>> Create(
+      CalculatorGraphConfig config, Options options = Options());
+
+  // Stops the graphs if the session is still running.
+  ~SwappableGraphSession();
+
+  // As in GraphSession; only before Start(). Side packets carry over to the
+  // graphs swapped in, unless Swap() replaces them.
+  absl::Status SetSidePacket(const std::string& name, Packet packet);
+  absl::Status ObservePackets(const std::string& stream,
+                              GraphSession::PacketCallback callback);
+
+  template <typename T>
+  absl::Status ObserveOutput(
+      const std::string& stream,
+      std::function<void(const T&, Timestamp)> callback) {
+    return ObservePackets(
+        stream, [callback = std::move(callback)](const Packet& packet) {
+          if (packet.IsEmpty()) return;
+          callback(packet.Get<T>(), packet.Timestamp());
+        });
+  }
+
+  // Starts and warms up the first graph.
+  absl::Status Start();
+
+  // Sends a frame to the current graph, switching to a prepared one first.
+  // See GraphSession::SendFrame().
+  absl::StatusOr<bool> SendFrame(Packet frame, double seconds);
+  void WaitForFrameSlot();
+
+  // Swap(), WaitForSwap() and Stop() are meant for one control thread.
+  //
+  // Starts preparing `config` in the background, with `side_packets`
+  // overriding those set so far. Fails while an earlier swap is pending.
+  absl::Status Swap(CalculatorGraphConfig config,
+                    std::map<std::string, Packet> side_packets = {});
+
+  // Blocks until the pending swap, if any, is done: the new graph took over
+  // and the old one drained, or preparing the new graph failed.
+  absl::Status WaitForSwap();
+
+  // Stops the current graph and any graph being swapped in or out.
+  absl::Status Stop();
+
+  // Totals over every graph so far, warm-up frames left out.
+  GraphSession::Stats GetStats() const;
+  SwapStats GetSwapStats() const;
+
+ private:
+  // Which outputs of a graph are passed on to the observers.
+  struct Gate {
+    // Set once the graph takes over; warm-up outputs come before.
+    std::atomic<bool> live{false};
+    // Timestamp of the first frame sent to the graph that replaced it.
+    std::atomic<int64_t> cutoff{Timestamp::Max().Value()};
+  };
+
+  // A graph and the gate of its outputs.
+  struct Generation {
+    int id = 0;
+    std::unique_ptr<GraphSession> session;
+    std::shared_ptr<Gate> gate;
+    // Counts of the warm-up frames, left out of GetStats().
+    GraphSession::Stats warmup;
+  };
+
+  explicit SwappableGraphSession(Options options);
+
+  // Creates, starts and warms up a graph.
+  absl::StatusOr<Generation> Prepare(
+      CalculatorGraphConfig config,
+      const std::map<std::string, Packet>& side_packets, int id);
+  // Body of the background thread of a swap.
+  void RunSwap(CalculatorGraphConfig config,
+               std::map<std::string, Packet> side_packets, int id);
+  // Takes over a prepared graph, if there is one.
+  void MaybeSwitch() ABSL_EXCLUSIVE_LOCKS_REQUIRED(send_mutex_);
+  // Passes an output of generation `id` on to the observers of `stream`,
+  // unless its gate or an output delivered earlier rules it out.
+  void Deliver(const Gate& gate, int id, const std::string& stream,
+               const Packet& packet);
+  // Called for every frame output of generation `id` that is delivered.
+  void OnFrameOutput(int id);
+  bool SwapSettled() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  bool ReadyTakenOrStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  CalculatorGraphConfig initial_config_;
+  std::map<std::string, Packet> side_packets_;
+  std::map<std::string, std::vector<GraphSession::PacketCallback>> callbacks_;
+  bool started_ = false;
+
+  // Serializes SendFrame(), and with it the switch between graphs.
+  mutable absl::Mutex send_mutex_;
+  Generation active_ ABSL_GUARDED_BY(send_mutex_);
+  // Gate of the graph just replaced, until the first frame sent to the new
+  // one sets its cutoff.
+  std::shared_ptr<Gate> pending_cutoff_ ABSL_GUARDED_BY(send_mutex_);
+
+  // Serializes the observers across graphs. Taken before `mutex_`.
+  absl::Mutex delivery_mutex_;
+  std::map<std::string, Timestamp> last_delivered_
+      ABSL_GUARDED_BY(delivery_mutex_);
+
+  mutable absl::Mutex mutex_;
+  // A warmed-up graph waiting for the next frame, and the graph it replaced
+  // waiting to be drained.
+  Generation ready_ ABSL_GUARDED_BY(mutex_);
+  Generation retired_ ABSL_GUARDED_BY(mutex_);
+  bool swap_pending_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status swap_status_ ABSL_GUARDED_BY(mutex_);
+  int next_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::thread swap_thread_;
+
+  // Gap measurement.
+  int live_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool awaiting_first_output_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Time switch_time_ ABSL_GUARDED_BY(mutex_);
+  absl::Time last_output_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  int64_t last_output_offered_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t frames_offered_ ABSL_GUARDED_BY(mutex_) = 0;
+  SwapStats swap_stats_ ABSL_GUARDED_BY(mutex_);
+  // Stats of the graphs already swapped out.
+  GraphSession::Stats retired_stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_COMMON_PREBUILT_UTIL_SWAPPABLE_GRAPH_SESSION_H_
@@ -0,0 +1,320 @@
+// "desktop/prebuilt/calculators/async_video_encoder_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/calculators/async_video_encoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kFinishedTag[] = "FINISHED";
+constexpr char kOutputFilePathTag[] = "OUTPUT_FILE_PATH";
+
+bool IsNamedPipe(const std::string& path) {
+  struct stat path_stat;
+  return stat(path.c_str(), &path_stat) == 0 && S_ISFIFO(path_stat.st_mode);
+}
+
+}  // namespace
+
+namespace mediapipe {
+
+// Encodes ImageFrames into a video file or a named pipe on a thread of its
+// own, so that encoding does not hold up the graph.
+//
+// Frames are queued by reference and converted and encoded by the encoder
+// thread, with OpenCV's software encoders: cv::VideoWriter (FFmpeg, e.g. H.264
+// or MJPEG) for files, or back to back JPEG images for named pipes, which
+// cv::VideoWriter cannot open.
+//
+// The queue holds at most max_queued_frames. When it is full, Process waits
+// for room before emitting FINISHED, so a FlowLimiterCalculator that takes
+// FINISHED as its back edge drops input frames while the encoder catches up.
+// With drop_when_full, the frame is dropped here instead. Frames before
+// start_timestamp are skipped, with FINISHED, so that warm-up frames do not
+// end up in the video.
+//
+// On Close, the queue is drained and the number of frames encoded and
+// dropped is logged together with the sustained encode rate.
+//
+// Inputs:
+//   VIDEO: ImageFrame, SRGB or SRGBA, all of the same size.
+//
+// Input side packets:
+//   OUTPUT_FILE_PATH (optional): std::string, the file or named pipe to write
+//            to. Defaults to output_file_path in the options.
+//
+// Outputs:
+//   FINISHED (optional): bool, true once the frame is queued for encoding or
+//            skipped, false when it was dropped.
+//
+// Usage example:
+// node {
+//   calculator: "AsyncVideoEncoderCalculator"
+//   input_stream: "VIDEO:output_video"
+//   input_side_packet: "OUTPUT_FILE_PATH:output_video_path"
+//   output_stream: "FINISHED:encoded_video"
+//   node_options: {
+//     [type.googleapis.com/mediapipe.AsyncVideoEncoderCalculatorOptions] {
+//       codec: "avc1"
+//       fps: 30
+//       max_queued_frames: 4
+//     }
+//   }
+// }
+//
+class AsyncVideoEncoderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Body of the encoder thread: encodes queued frames until Close.
+  void EncodeFrames();
+  absl::Status EncodeFrame(const ImageFrame& frame);
+  absl::Status OpenOutput(const ImageFrame& first_frame);
+  absl::Status WriteAll(const std::vector<uchar>& bytes);
+
+  bool HasRoom() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return static_cast<int>(queue_.size()) < options_.max_queued_frames() ||
+           !status_.ok();
+  }
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queue_.empty() || closing_;
+  }
+
+  ::mediapipe::AsyncVideoEncoderCalculatorOptions options_;
+  std::string path_;
+  std::thread encoder_thread_;
+
+  absl::Mutex mutex_;
+  std::deque<Packet> queue_ ABSL_GUARDED_BY(mutex_);
+  bool closing_ ABSL_GUARDED_BY(mutex_) = false;
+  // First encoding error. Later frames are discarded.
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  int dropped_frames_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Owned by the encoder thread until it is joined.
+  bool mjpeg_stream_ = false;
+  cv::VideoWriter writer_;
+  int fd_ = -1;
+  cv::Mat bgr_;
+  std::vector<uchar> jpeg_;
+  int width_ = 0;
+  int height_ = 0;
+  int encoded_frames_ = 0;
+  absl::Duration encode_time_;
+  absl::Time first_frame_time_;
+  absl::Time last_frame_time_;
+};
+
+REGISTER_CALCULATOR(AsyncVideoEncoderCalculator);
+
+absl::Status AsyncVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Tag(kVideoTag).Set<ImageFrame>();
+  if (cc->InputSidePackets().HasTag(kOutputFilePathTag)) {
+    cc->InputSidePackets().Tag(kOutputFilePathTag).Set<std::string>();
+  }
+  if (cc->Outputs().HasTag(kFinishedTag)) {
+    cc->Outputs().Tag(kFinishedTag).Set<bool>();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AsyncVideoEncoderCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ = cc->Options<::mediapipe::AsyncVideoEncoderCalculatorOptions>();
+  RET_CHECK_GT(options_.max_queued_frames(), 0);
+  path_ = options_.output_file_path();
+  if (cc->InputSidePackets().HasTag(kOutputFilePathTag)) {
+    path_ = cc->InputSidePackets().Tag(kOutputFilePathTag).Get<std::string>();
+  }
+  RET_CHECK(!path_.empty()) << "No output file path.";
+
+  switch (options_.container()) {
+    case AsyncVideoEncoderCalculatorOptions::AUTO:
+      mjpeg_stream_ = IsNamedPipe(path_);
+      break;
+    case AsyncVideoEncoderCalculatorOptions::VIDEO_FILE:
+      mjpeg_stream_ = false;
+      break;
+    case AsyncVideoEncoderCalculatorOptions::MJPEG_STREAM:
+      mjpeg_stream_ = true;
+      break;
+  }
+  if (!mjpeg_stream_) {
+    RET_CHECK_EQ(options_.codec().size(), 4)
+        << "Codec must be a FourCC, e.g. \"avc1\".";
+  }
+
+  encoder_thread_ = std::thread([this] { EncodeFrames(); });
+  return absl::OkStatus();
+}
+
+absl::Status AsyncVideoEncoderCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kVideoTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  bool queued = true;
+  if (cc->InputTimestamp().Value() >= options_.start_timestamp()) {
+    absl::MutexLock lock(&mutex_);
+    if (!HasRoom() && options_.drop_when_full()) {
+      ++dropped_frames_;
+      queued = false;
+    } else {
+      mutex_.Await(
+          absl::Condition(this, &AsyncVideoEncoderCalculator::HasRoom));
+      MP_RETURN_IF_ERROR(status_);
+      queue_.push_back(cc->Inputs().Tag(kVideoTag).Value());
+    }
+  }
+
+  if (cc->Outputs().HasTag(kFinishedTag)) {
+    cc->Outputs().Tag(kFinishedTag).AddPacket(
+        MakePacket<bool>(queued).At(cc->InputTimestamp()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AsyncVideoEncoderCalculator::Close(CalculatorContext* cc) {
+  if (encoder_thread_.joinable()) {
+    {
+      absl::MutexLock lock(&mutex_);
+      closing_ = true;
+    }
+    encoder_thread_.join();
+  }
+  if (writer_.isOpened()) writer_.release();
+  if (fd_ >= 0) close(fd_);
+
+  absl::MutexLock lock(&mutex_);
+  if (encoded_frames_ > 0) {
+    const double seconds =
+        absl::ToDoubleSeconds(last_frame_time_ - first_frame_time_);
+    LOG(INFO) << "Encoded " << encoded_frames_ << " frames to " << path_
+              << " at " << (seconds > 0 ? encoded_frames_ / seconds : 0)
+              << " fps, "
+              << absl::ToDoubleMilliseconds(encode_time_) / encoded_frames_
+              << " ms per frame; dropped " << dropped_frames_
+              << " with the queue full.";
+  }
+  return status_;
+}
+
+void AsyncVideoEncoderCalculator::EncodeFrames() {
+  // A reader closing the pipe makes write fail with EPIPE rather than
+  // raising SIGPIPE on this thread.
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+
+  while (true) {
+    Packet packet;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &AsyncVideoEncoderCalculator::HasWork));
+      if (queue_.empty()) return;
+      packet = std::move(queue_.front());
+      queue_.pop_front();
+      if (!status_.ok()) continue;
+    }
+
+    const absl::Time start = absl::Now();
+    absl::Status status = EncodeFrame(packet.Get<ImageFrame>());
+    const absl::Time end = absl::Now();
+    if (!status.ok()) {
+      absl::MutexLock lock(&mutex_);
+      status_ = status;
+      continue;
+    }
+    if (encoded_frames_ == 0) first_frame_time_ = start;
+    last_frame_time_ = end;
+    encode_time_ += end - start;
+    ++encoded_frames_;
+  }
+}
+
+absl::Status AsyncVideoEncoderCalculator::OpenOutput(
+    const ImageFrame& first_frame) {
+  width_ = first_frame.Width();
+  height_ = first_frame.Height();
+  if (mjpeg_stream_) {
+    // Blocks until a reader opens the pipe.
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    RET_CHECK_GE(fd_, 0) << "Failed to open " << path_;
+    return absl::OkStatus();
+  }
+  const std::string& codec = options_.codec();
+  writer_.open(path_,
+               cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]),
+               options_.fps(), cv::Size(width_, height_));
+  RET_CHECK(writer_.isOpened())
+      << "Failed to open " << path_ << " for writing with codec " << codec;
+  return absl::OkStatus();
+}
+
+absl::Status AsyncVideoEncoderCalculator::EncodeFrame(const ImageFrame& frame) {
+  if (width_ == 0) {
+    MP_RETURN_IF_ERROR(OpenOutput(frame));
+  }
+  RET_CHECK(frame.Width() == width_ && frame.Height() == height_)
+      << "Frame size changed from " << width_ << "x" << height_ << " to "
+      << frame.Width() << "x" << frame.Height();
+
+  const cv::Mat rgb = formats::MatView(&frame);
+  RET_CHECK(rgb.channels() == 3 || rgb.channels() == 4)
+      << "Only SRGB and SRGBA images are supported.";
+  cv::cvtColor(rgb, bgr_,
+               rgb.channels() == 4 ? cv::COLOR_RGBA2BGR : cv::COLOR_RGB2BGR);
+
+  if (!mjpeg_stream_) {
+    writer_.write(bgr_);
+    return absl::OkStatus();
+  }
+  RET_CHECK(cv::imencode(".jpg", bgr_, jpeg_,
+                         {cv::IMWRITE_JPEG_QUALITY, options_.jpeg_quality()}))
+      << "Failed to encode a JPEG frame.";
+  return WriteAll(jpeg_);
+}
+
+absl::Status AsyncVideoEncoderCalculator::WriteAll(
+    const std::vector<uchar>& bytes) {
+  size_t written = 0;
+  while (written < bytes.size()) {
+    const ssize_t result =
+        write(fd_, bytes.data() + written, bytes.size() - written);
+    if (result < 0 && errno == EINTR) continue;
+    RET_CHECK_GT(result, 0) << "Failed to write to " << path_;
+    written += result;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
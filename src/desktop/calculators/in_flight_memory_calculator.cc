@@ -0,0 +1,86 @@
+// "desktop/prebuilt/calculators/in_flight_memory_calculator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include <memory>
+
+#include "mediapipe/examples/desktop/prebuilt/memory_accountant.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace {
+
+constexpr char kAccountantTag[] = "ACCOUNTANT";
+
+}  // namespace
+
+namespace mediapipe {
+
+using prebuilt::MemoryAccountant;
+
+// Reports every ImageFrame, Tensor and std::vector<Tensor> packet of its input
+// streams to a MemoryAccountant, which counts their bytes for as long as the
+// packets stay alive elsewhere in the graph.
+//
+// Packets are handled as they arrive, without waiting for the other inputs,
+// and are not held on to, so tapping a stream does not extend the life of its
+// packets. Packets of other types are ignored.
+//
+// Inputs:
+//   Any number of untagged streams of any type.
+//
+// Input side packets:
+//   ACCOUNTANT: std::shared_ptr<prebuilt::MemoryAccountant>.
+//
+// Usage example:
+// node {
+//   calculator: "InFlightMemoryCalculator"
+//   input_stream: "throttled_input_video"
+//   input_stream: "output_video"
+//   input_side_packet: "ACCOUNTANT:memory_accountant"
+// }
+//
+class InFlightMemoryCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  std::shared_ptr<MemoryAccountant> accountant_;
+};
+
+REGISTER_CALCULATOR(InFlightMemoryCalculator);
+
+absl::Status InFlightMemoryCalculator::GetContract(CalculatorContract* cc) {
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    cc->Inputs().Get(id).SetAny();
+  }
+  cc->InputSidePackets()
+      .Tag(kAccountantTag)
+      .Set<std::shared_ptr<MemoryAccountant>>();
+  cc->SetInputStreamHandler("ImmediateInputStreamHandler");
+  return absl::OkStatus();
+}
+
+absl::Status InFlightMemoryCalculator::Open(CalculatorContext* cc) {
+  accountant_ = cc->InputSidePackets()
+                    .Tag(kAccountantTag)
+                    .Get<std::shared_ptr<MemoryAccountant>>();
+  RET_CHECK(accountant_);
+  return absl::OkStatus();
+}
+
+absl::Status InFlightMemoryCalculator::Process(CalculatorContext* cc) {
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    const auto& input = cc->Inputs().Get(id);
+    if (input.IsEmpty()) continue;
+    const int64 bytes = MemoryAccountant::PayloadBytes(input.Value());
+    if (bytes > 0) accountant_->Track(input.Name(), input.Value(), bytes);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
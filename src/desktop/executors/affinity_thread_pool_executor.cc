@@ -0,0 +1,85 @@
+// "desktop/prebuilt/executors/affinity_thread_pool_executor.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "mediapipe/examples/desktop/prebuilt/executors/affinity_thread_pool_executor.pb.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/mediapipe_options.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/util/cpu_util.h"
+
+namespace mediapipe {
+
+// Thread pool executor whose workers are pinned to a set of CPUs.
+//
+// MediaPipe's ThreadPoolExecutor only takes a thread count. This one also
+// takes CPU affinity and a nice level, so that inference can be kept on its
+// own physical cores and I/O or pre/post-processing threads on others.
+//
+// Usage example:
+// executor {
+//   name: "inference"
+//   type: "AffinityThreadPoolExecutor"
+//   options {
+//     [mediapipe.AffinityThreadPoolExecutorOptions.ext] {
+//       num_threads: 2
+//       cpu: [2, 3]
+//     }
+//   }
+// }
+// node {
+//   calculator: "TfLiteInferenceCalculator"
+//   executor: "inference"
+//   ...
+// }
+//
+class AffinityThreadPoolExecutor : public Executor {
+ public:
+  static absl::StatusOr<Executor*> Create(
+      const MediaPipeOptions& extendable_options);
+
+  AffinityThreadPoolExecutor(const ThreadOptions& thread_options,
+                             const std::string& name_prefix, int num_threads)
+      : thread_pool_(thread_options, name_prefix, num_threads) {
+    thread_pool_.StartWorkers();
+  }
+
+  void Schedule(std::function<void()> task) override {
+    thread_pool_.Schedule(std::move(task));
+  }
+
+ private:
+  ThreadPool thread_pool_;
+};
+
+REGISTER_EXECUTOR(AffinityThreadPoolExecutor);
+
+absl::StatusOr<Executor*> AffinityThreadPoolExecutor::Create(
+    const MediaPipeOptions& extendable_options) {
+  const auto& options =
+      extendable_options.GetExtension(AffinityThreadPoolExecutorOptions::ext);
+  RET_CHECK_GE(options.num_threads(), 0);
+
+  const std::set<int> cpus(options.cpu().begin(), options.cpu().end());
+  int num_threads = options.num_threads();
+  if (num_threads == 0) {
+    num_threads = cpus.empty() ? NumCPUCores() : cpus.size();
+  }
+
+  ThreadOptions thread_options;
+  thread_options.set_cpu_set(cpus);
+  thread_options.set_nice_priority_level(options.nice_priority_level());
+  const std::string name_prefix = options.has_thread_name_prefix()
+                                      ? options.thread_name_prefix()
+                                      : "mediapipe_affinity";
+  return new AffinityThreadPoolExecutor(thread_options, name_prefix,
+                                        num_threads);
+}
+
+}  // namespace mediapipe
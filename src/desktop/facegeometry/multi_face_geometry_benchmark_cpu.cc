@@ -0,0 +1,273 @@
+// "desktop/prebuilt/facegeometry/multi_face_geometry_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/facegeometry
+//
+// Compares FaceGeometryPipelineCalculator against MultiFaceGeometryCalculator
+// on synthetic face landmarks, for each face count of --face_counts, and
+// checks that both estimate the same poses:
+//
+//   multi_face_geometry_benchmark_cpu --face_counts=1,4,8
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/substitute.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/modules/face_geometry/protos/environment.pb.h"
+#include "mediapipe/modules/face_geometry/protos/face_geometry.pb.h"
+#include "mediapipe/modules/face_geometry/protos/geometry_pipeline_metadata.pb.h"
+
+ABSL_FLAG(std::string, metadata_path,
+          "mediapipe/modules/face_geometry/data/"
+          "geometry_pipeline_metadata_landmarks.binarypb",
+          "Binary GeometryPipelineMetadata with the canonical face.");
+ABSL_FLAG(std::string, face_counts, "1,4,8",
+          "Comma-separated numbers of faces per frame to measure.");
+ABSL_FLAG(int, frames, 500, "Number of measured frames per graph.");
+ABSL_FLAG(int, warmup_frames, 20, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 1280, "Width of the synthetic frames.");
+ABSL_FLAG(int, frame_height, 720, "Height of the synthetic frames.");
+
+namespace {
+
+using ::mediapipe::face_geometry::FaceGeometry;
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+constexpr char kImageSize[] = "image_size";
+constexpr char kMultiFaceLandmarks[] = "multi_face_landmarks";
+constexpr char kMultiFaceGeometry[] = "multi_face_geometry";
+
+// Canonical mesh vertices are x, y, z, u, v.
+constexpr int kVertexSize = 5;
+// Distinct synthetic frames, cycled through.
+constexpr int kNumInputs = 16;
+
+constexpr char kPipelineNode[] = R"pb(
+  node {
+    calculator: "FaceGeometryPipelineCalculator"
+    input_side_packet: "ENVIRONMENT:environment"
+    input_stream: "IMAGE_SIZE:image_size"
+    input_stream: "MULTI_FACE_LANDMARKS:multi_face_landmarks"
+    output_stream: "MULTI_FACE_GEOMETRY:multi_face_geometry"
+    options: {
+      [mediapipe.FaceGeometryPipelineCalculatorOptions.ext] {
+        metadata_path: "$0"
+      }
+    }
+  }
+)pb";
+
+constexpr char kMultiFaceNode[] = R"pb(
+  node {
+    calculator: "MultiFaceGeometryCalculator"
+    input_side_packet: "ENVIRONMENT:environment"
+    input_stream: "IMAGE_SIZE:image_size"
+    input_stream: "MULTI_FACE_LANDMARKS:multi_face_landmarks"
+    output_stream: "MULTI_FACE_GEOMETRY:multi_face_geometry"
+    options: {
+      [mediapipe.MultiFaceGeometryCalculatorOptions.ext] {
+        metadata_path: "$0"
+      }
+    }
+  }
+)pb";
+
+// The environment of face_geometry_with_transform.pbtxt.
+mediapipe::face_geometry::Environment MakeEnvironment() {
+  mediapipe::face_geometry::Environment environment;
+  environment.set_origin_point_location(
+      mediapipe::face_geometry::OriginPointLocation::TOP_LEFT_CORNER);
+  auto* camera = environment.mutable_perspective_camera();
+  camera->set_vertical_fov_degrees(63.0);
+  camera->set_near(1.0);
+  camera->set_far(10000.0);
+  return environment;
+}
+
+// Screen landmarks of `num_faces` canonical faces side by side, each turned
+// a little and jittered like landmark model output.
+std::vector<mediapipe::NormalizedLandmarkList> MakeFaces(
+    const mediapipe::face_geometry::Mesh3d& mesh, int num_faces, int seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> angle(-0.3f, 0.3f);
+  std::uniform_real_distribution<float> jitter(-0.002f, 0.002f);
+  const int num_vertices = mesh.vertex_buffer_size() / kVertexSize;
+  const float aspect = static_cast<float>(absl::GetFlag(FLAGS_frame_width)) /
+                       absl::GetFlag(FLAGS_frame_height);
+  const int columns = std::ceil(std::sqrt(num_faces));
+  const int rows = (num_faces + columns - 1) / columns;
+  // Canonical units are centimeters; a face spans about 16 of them.
+  const float size = 0.6f / std::max(columns, rows) / 16.0f;
+
+  std::vector<mediapipe::NormalizedLandmarkList> faces(num_faces);
+  for (int f = 0; f < num_faces; ++f) {
+    const float center_x = (f % columns + 0.5f) / columns;
+    const float center_y = (f / columns + 0.5f) / rows;
+    const float yaw = angle(random);
+    const float pitch = angle(random);
+    for (int v = 0; v < num_vertices; ++v) {
+      const float x = mesh.vertex_buffer(v * kVertexSize);
+      const float y = mesh.vertex_buffer(v * kVertexSize + 1);
+      const float z = mesh.vertex_buffer(v * kVertexSize + 2);
+      // Yaw about y, then pitch about x.
+      const float yaw_x = x * std::cos(yaw) + z * std::sin(yaw);
+      const float yaw_z = -x * std::sin(yaw) + z * std::cos(yaw);
+      const float pitch_y = y * std::cos(pitch) - yaw_z * std::sin(pitch);
+      const float pitch_z = y * std::sin(pitch) + yaw_z * std::cos(pitch);
+      auto* landmark = faces[f].add_landmark();
+      landmark->set_x(center_x + yaw_x * size / aspect + jitter(random));
+      landmark->set_y(center_y - pitch_y * size + jitter(random));
+      landmark->set_z(-pitch_z * size / aspect);
+    }
+  }
+  return faces;
+}
+
+// Runs `node` over the inputs, logs its per-frame latency and returns the
+// geometry of each distinct input.
+absl::StatusOr<std::vector<std::vector<FaceGeometry>>> Benchmark(
+    const std::string& name, const char* node,
+    const std::vector<std::vector<mediapipe::NormalizedLandmarkList>>& inputs) {
+  auto config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          absl::Substitute(node, absl::GetFlag(FLAGS_metadata_path)));
+  config.add_input_stream(kImageSize);
+  config.add_input_stream(kMultiFaceLandmarks);
+  config.add_output_stream(kMultiFaceGeometry);
+
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller(kMultiFaceGeometry));
+  MP_RETURN_IF_ERROR(graph.StartRun(
+      {{"environment", mediapipe::MakePacket<
+                           mediapipe::face_geometry::Environment>(
+                           MakeEnvironment())}}));
+
+  const std::pair<int, int> image_size(absl::GetFlag(FLAGS_frame_width),
+                                       absl::GetFlag(FLAGS_frame_height));
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<std::vector<FaceGeometry>> results(inputs.size());
+  std::vector<double> latencies_us;
+  latencies_us.reserve(frames);
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    const int input = i % inputs.size();
+    const mediapipe::Timestamp timestamp(i);
+    mediapipe::Packet landmarks =
+        mediapipe::MakePacket<std::vector<mediapipe::NormalizedLandmarkList>>(
+            inputs[input])
+            .At(timestamp);
+
+    const absl::Time sent = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kImageSize,
+        mediapipe::MakePacket<std::pair<int, int>>(image_size).At(timestamp)));
+    MP_RETURN_IF_ERROR(
+        graph.AddPacketToInputStream(kMultiFaceLandmarks, landmarks));
+    mediapipe::Packet packet;
+    RET_CHECK(poller.Next(&packet)) << "Graph stopped producing output.";
+    if (i >= warmup_frames) {
+      latencies_us.push_back(absl::ToDoubleMicroseconds(absl::Now() - sent));
+    }
+    if (i < static_cast<int>(inputs.size())) {
+      results[input] = packet.Get<std::vector<FaceGeometry>>();
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  RET_CHECK(!latencies_us.empty()) << "No frames were measured.";
+  LOG(INFO) << name << " over " << latencies_us.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_us), "us");
+  return results;
+}
+
+// Largest difference between the pose transforms and mesh vertices of `a`
+// and `b`.
+absl::StatusOr<float> MaxDifference(const std::vector<FaceGeometry>& a,
+                                    const std::vector<FaceGeometry>& b) {
+  RET_CHECK_EQ(a.size(), b.size()) << "Different number of faces.";
+  float difference = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    const auto& matrix_a = a[i].pose_transform_matrix().packed_data();
+    const auto& matrix_b = b[i].pose_transform_matrix().packed_data();
+    RET_CHECK_EQ(matrix_a.size(), matrix_b.size());
+    for (int k = 0; k < matrix_a.size(); ++k) {
+      difference = std::max(difference, std::abs(matrix_a[k] - matrix_b[k]));
+    }
+    const auto& vertices_a = a[i].mesh().vertex_buffer();
+    const auto& vertices_b = b[i].mesh().vertex_buffer();
+    RET_CHECK_EQ(vertices_a.size(), vertices_b.size());
+    for (int k = 0; k < vertices_a.size(); ++k) {
+      difference =
+          std::max(difference, std::abs(vertices_a[k] - vertices_b[k]));
+    }
+  }
+  return difference;
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  std::string metadata_blob;
+  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
+      absl::GetFlag(FLAGS_metadata_path), &metadata_blob));
+  mediapipe::face_geometry::GeometryPipelineMetadata metadata;
+  RET_CHECK(metadata.ParseFromString(metadata_blob))
+      << "Failed to parse the geometry pipeline metadata.";
+
+  for (const absl::string_view count :
+       absl::StrSplit(absl::GetFlag(FLAGS_face_counts), ',')) {
+    int num_faces;
+    RET_CHECK(absl::SimpleAtoi(count, &num_faces) && num_faces > 0)
+        << "Invalid face count: " << count;
+    std::vector<std::vector<mediapipe::NormalizedLandmarkList>> inputs;
+    for (int seed = 0; seed < kNumInputs; ++seed) {
+      inputs.push_back(MakeFaces(metadata.canonical_mesh(), num_faces, seed));
+    }
+
+    LOG(INFO) << num_faces << " faces:";
+    ASSIGN_OR_RETURN(auto pipeline, Benchmark("FaceGeometryPipeline",
+                                              kPipelineNode, inputs));
+    ASSIGN_OR_RETURN(auto multi_face,
+                     Benchmark("MultiFaceGeometry", kMultiFaceNode, inputs));
+    float difference = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      ASSIGN_OR_RETURN(float input_difference,
+                       MaxDifference(pipeline[i], multi_face[i]));
+      difference = std::max(difference, input_difference);
+    }
+    LOG(INFO) << "Largest difference between the geometries: " << difference;
+  }
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
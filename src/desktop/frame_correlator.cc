@@ -0,0 +1,61 @@
+// "desktop/prebuilt/frame_correlator.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/frame_correlator.h"
+
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+void FrameCorrelator::AddInput(Timestamp timestamp, absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  if (inputs_ == 0) first_input_ = timestamp;
+  in_flight_.emplace_back(timestamp, time);
+  ++inputs_;
+}
+
+void FrameCorrelator::AddOutput(Timestamp timestamp, absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  if (inputs_ == 0 || timestamp < first_input_) return;
+
+  while (!in_flight_.empty() && in_flight_.front().first < timestamp) {
+    in_flight_.pop_front();
+    ++dropped_;
+  }
+  if (in_flight_.empty() || in_flight_.front().first != timestamp) {
+    ++unmatched_;
+    return;
+  }
+  latencies_ms_.push_back(
+      absl::ToDoubleMilliseconds(time - in_flight_.front().second));
+  in_flight_.pop_front();
+}
+
+int FrameCorrelator::outputs() const {
+  absl::MutexLock lock(&mutex_);
+  return latencies_ms_.size();
+}
+
+FrameCorrelator::Stats FrameCorrelator::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  Stats stats;
+  stats.inputs = inputs_;
+  stats.outputs = latencies_ms_.size();
+  stats.dropped = dropped_;
+  stats.pending = in_flight_.size();
+  stats.unmatched = unmatched_;
+  if (latencies_ms_.empty()) return stats;
+
+  stats.first_ms = latencies_ms_.front();
+  const LatencyStats latency = SummarizeLatencies(latencies_ms_);
+  stats.mean_ms = latency.mean;
+  stats.p50_ms = latency.p50;
+  stats.p90_ms = latency.p90;
+  stats.p99_ms = latency.p99;
+  stats.max_ms = latency.max;
+  return stats;
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,70 @@
+// "desktop/prebuilt/frame_correlator.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_FRAME_CORRELATOR_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_FRAME_CORRELATOR_H_
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Matches the output packets of a graph to the input packets they came from
+// by timestamp, for end-to-end latency and drop accounting when a flow
+// limiter may drop frames and inputs and outputs are no longer one to one.
+//
+// Inputs must be added in increasing timestamp order and outputs arrive in
+// that order too. An output settles every input stamped before it: those
+// without an output of their own were dropped. Outputs stamped before the
+// first input, such as those of warm-up frames, are ignored.
+//
+// Thread-safe, so outputs can be added from an output stream observer.
+class FrameCorrelator {
+ public:
+  struct Stats {
+    int inputs = 0;
+    int outputs = 0;
+    int dropped = 0;
+    // Inputs not yet settled by an output.
+    int pending = 0;
+    // Outputs matching no input.
+    int unmatched = 0;
+    // End-to-end latency of the matched outputs.
+    double first_ms = 0;
+    double mean_ms = 0;
+    double p50_ms = 0;
+    double p90_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+  };
+
+  // Records an input frame stamped `timestamp`, sent at `time`.
+  void AddInput(Timestamp timestamp, absl::Time time = absl::Now());
+  // Records an output stamped `timestamp`, received at `time`.
+  void AddOutput(Timestamp timestamp, absl::Time time = absl::Now());
+
+  int outputs() const;
+  Stats GetStats() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::deque<std::pair<Timestamp, absl::Time>> in_flight_
+      ABSL_GUARDED_BY(mutex_);
+  Timestamp first_input_ ABSL_GUARDED_BY(mutex_) = Timestamp::Unset();
+  std::vector<double> latencies_ms_ ABSL_GUARDED_BY(mutex_);
+  int inputs_ ABSL_GUARDED_BY(mutex_) = 0;
+  int dropped_ ABSL_GUARDED_BY(mutex_) = 0;
+  int unmatched_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_FRAME_CORRELATOR_H_
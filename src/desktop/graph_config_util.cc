@@ -0,0 +1,320 @@
+// "desktop/prebuilt/graph_config_util.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "mediapipe/examples/desktop/prebuilt/executors/affinity_thread_pool_executor.pb.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/tool/subgraph_expansion.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+constexpr char kBinaryGraphExtension[] = ".binarypb";
+constexpr char kFlowLimiterCalculator[] = "FlowLimiterCalculator";
+constexpr char kDeadlineAdmissionCalculator[] = "DeadlineAdmissionCalculator";
+constexpr char kPassThroughCalculator[] = "PassThroughCalculator";
+constexpr char kVideoEncoderCalculator[] = "AsyncVideoEncoderCalculator";
+constexpr char kFinishedTag[] = "FINISHED";
+constexpr char kInFlightMemoryCalculator[] = "InFlightMemoryCalculator";
+constexpr char kAffinityExecutor[] = "AffinityThreadPoolExecutor";
+constexpr char kDefaultExecutorName[] = "default";
+
+// Whether `node` throttles the graph input on a FINISHED back edge.
+bool IsFrameLimiter(const CalculatorGraphConfig::Node& node) {
+  return node.calculator() == kFlowLimiterCalculator ||
+         node.calculator() == kDeadlineAdmissionCalculator;
+}
+
+// Stream specs without a tag ("name" as opposed to "TAG:name") are the ones
+// FlowLimiterCalculator passes through, paired by index.
+bool IsUntagged(const std::string& stream) {
+  return !absl::StrContains(stream, ':');
+}
+
+// Strips the "TAG:" or "TAG:index:" prefix off a stream spec.
+std::string StreamName(const std::string& stream) {
+  return stream.substr(stream.rfind(':') + 1);
+}
+
+// Parses the binary proto straight out of a read-only mapping of the file.
+absl::Status ParseBinaryGraphConfig(const std::string& path,
+                                    CalculatorGraphConfig* config) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  RET_CHECK_GE(fd, 0) << "Failed to open " << path;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return absl::InternalError(absl::StrCat("Failed to stat ", path));
+  }
+  const size_t size = file_stat.st_size;
+  if (size == 0) {
+    close(fd);
+    return absl::InvalidArgumentError(
+        absl::StrCat("Empty binary graph config: ", path));
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  RET_CHECK(data != MAP_FAILED) << "Failed to map " << path;
+
+  const bool parsed = config->ParseFromArray(data, size);
+  munmap(data, size);
+  RET_CHECK(parsed) << "Failed to parse binary graph config: " << path;
+  return absl::OkStatus();
+}
+
+// Returns true when `cache_path` exists and was written after both
+// `source_path` and the running binary. Subgraphs are registered by the
+// mediapipe_simple_subgraph targets linked into the binary, so an edited
+// subgraph only takes effect once the binary is rebuilt, which makes the
+// binary's mtime stand in for every subgraph's.
+bool IsCacheFresh(const std::string& source_path,
+                  const std::string& cache_path) {
+  struct stat source_stat, binary_stat, cache_stat;
+  if (stat(source_path.c_str(), &source_stat) != 0) return false;
+  if (stat("/proc/self/exe", &binary_stat) != 0) return false;
+  if (stat(cache_path.c_str(), &cache_stat) != 0) return false;
+  return cache_stat.st_mtime >= source_stat.st_mtime &&
+         cache_stat.st_mtime >= binary_stat.st_mtime;
+}
+
+}  // namespace
+
+absl::StatusOr<CalculatorGraphConfig> LoadGraphConfig(const std::string& path) {
+  CalculatorGraphConfig config;
+  if (absl::EndsWith(path, kBinaryGraphExtension)) {
+    MP_RETURN_IF_ERROR(ParseBinaryGraphConfig(path, &config));
+    return config;
+  }
+
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  RET_CHECK(ParseTextProto<CalculatorGraphConfig>(contents, &config))
+      << "Failed to parse text format graph config: " << path;
+  return config;
+}
+
+absl::StatusOr<CalculatorGraphConfig> LoadExpandedGraphConfig(
+    const std::string& path, const std::string& cache_path) {
+  if (IsCacheFresh(path, cache_path)) {
+    CalculatorGraphConfig config;
+    MP_RETURN_IF_ERROR(ParseBinaryGraphConfig(cache_path, &config));
+    return config;
+  }
+
+  ASSIGN_OR_RETURN(CalculatorGraphConfig config, LoadGraphConfig(path));
+  MP_RETURN_IF_ERROR(tool::ExpandSubgraphs(&config));
+  std::string serialized;
+  RET_CHECK(config.SerializeToString(&serialized));
+  MP_RETURN_IF_ERROR(file::SetContents(cache_path, serialized));
+  return config;
+}
+
+int DisableFlowLimiters(CalculatorGraphConfig* config) {
+  int replaced = 0;
+  for (auto& node : *config->mutable_node()) {
+    if (!IsFrameLimiter(node)) continue;
+
+    // Name, executor, stream handlers and the like stay; the limiter's
+    // options, side packets, back edge and tagged streams go.
+    CalculatorGraphConfig::Node pass_through = node;
+    pass_through.set_calculator(kPassThroughCalculator);
+    pass_through.clear_options();
+    pass_through.clear_node_options();
+    pass_through.clear_input_side_packet();
+    pass_through.clear_input_stream_info();
+    pass_through.clear_input_stream();
+    pass_through.clear_output_stream();
+    for (const auto& stream : node.input_stream()) {
+      if (IsUntagged(stream)) pass_through.add_input_stream(stream);
+    }
+    for (const auto& stream : node.output_stream()) {
+      if (IsUntagged(stream)) pass_through.add_output_stream(stream);
+    }
+
+    node = pass_through;
+    ++replaced;
+  }
+  return replaced;
+}
+
+int UseDeadlineAdmission(const DeadlineAdmissionCalculatorOptions& options,
+                         CalculatorGraphConfig* config) {
+  int replaced = 0;
+  for (auto& node : *config->mutable_node()) {
+    if (node.calculator() != kFlowLimiterCalculator) continue;
+    const int throttled = std::count_if(node.input_stream().begin(),
+                                        node.input_stream().end(), IsUntagged);
+    if (throttled != 1) continue;
+
+    // Streams, back edge info and executor stay; the limits are replaced.
+    node.set_calculator(kDeadlineAdmissionCalculator);
+    node.clear_options();
+    node.clear_node_options();
+    node.clear_input_side_packet();
+    node.mutable_options()
+        ->MutableExtension(DeadlineAdmissionCalculatorOptions::ext)
+        ->CopyFrom(options);
+    ++replaced;
+  }
+  return replaced;
+}
+
+int AttachVideoEncoder(const std::string& video_stream,
+                       const AsyncVideoEncoderCalculatorOptions& options,
+                       CalculatorGraphConfig* config) {
+  const std::string encoded_stream = absl::StrCat(video_stream, "_encoded");
+  auto* encoder = config->add_node();
+  encoder->set_calculator(kVideoEncoderCalculator);
+  encoder->add_input_stream(absl::StrCat("VIDEO:", video_stream));
+  encoder->add_output_stream(absl::StrCat(kFinishedTag, ":", encoded_stream));
+  encoder->mutable_options()->MutableExtension(
+      AsyncVideoEncoderCalculatorOptions::ext)->CopyFrom(options);
+
+  const std::string finished = absl::StrCat(kFinishedTag, ":", video_stream);
+  int repointed = 0;
+  for (auto& node : *config->mutable_node()) {
+    if (!IsFrameLimiter(node)) continue;
+    for (auto& stream : *node.mutable_input_stream()) {
+      if (stream != finished) continue;
+      stream = absl::StrCat(kFinishedTag, ":", encoded_stream);
+      ++repointed;
+    }
+  }
+  return repointed;
+}
+
+int AttachMemoryAccounting(const std::string& accountant_side_packet,
+                           CalculatorGraphConfig* config) {
+  std::vector<std::string> streams;
+  std::set<std::string> seen;
+  auto add_stream = [&](const std::string& stream) {
+    const std::string name = StreamName(stream);
+    if (seen.insert(name).second) streams.push_back(name);
+  };
+  for (const auto& stream : config->input_stream()) add_stream(stream);
+  for (const auto& node : config->node()) {
+    for (const auto& stream : node.output_stream()) add_stream(stream);
+  }
+
+  auto* tap = config->add_node();
+  tap->set_calculator(kInFlightMemoryCalculator);
+  for (const auto& stream : streams) tap->add_input_stream(stream);
+  tap->add_input_side_packet(
+      absl::StrCat("ACCOUNTANT:", accountant_side_packet));
+  return streams.size();
+}
+
+absl::StatusOr<std::vector<int>> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  for (absl::string_view range :
+       absl::StrSplit(cpu_list, ',', absl::SkipWhitespace())) {
+    std::vector<absl::string_view> bounds = absl::StrSplit(range, '-');
+    RET_CHECK_LE(bounds.size(), 2) << "Bad CPU range: " << range;
+    int first, last;
+    RET_CHECK(absl::SimpleAtoi(bounds.front(), &first) &&
+              absl::SimpleAtoi(bounds.back(), &last) && first >= 0 &&
+              first <= last)
+        << "Bad CPU range: " << range;
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+absl::StatusOr<std::map<std::string, Packet>> ParseSidePackets(
+    const std::string& side_packets) {
+  std::map<std::string, Packet> packets;
+  for (absl::string_view spec :
+       absl::StrSplit(side_packets, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> name_and_value =
+        absl::StrSplit(spec, absl::MaxSplits('=', 1));
+    RET_CHECK(!name_and_value.first.empty() && !name_and_value.second.empty())
+        << "Bad side packet: " << spec;
+    const absl::string_view value = name_and_value.second;
+    int int_value;
+    float float_value;
+    Packet packet;
+    if (value == "true" || value == "false") {
+      packet = MakePacket<bool>(value == "true");
+    } else if (absl::SimpleAtoi(value, &int_value)) {
+      packet = MakePacket<int>(int_value);
+    } else if (absl::SimpleAtof(value, &float_value)) {
+      packet = MakePacket<float>(float_value);
+    } else {
+      packet = MakePacket<std::string>(std::string(value));
+    }
+    packets[std::string(name_and_value.first)] = packet;
+  }
+  return packets;
+}
+
+absl::Status ConfigureExecutors(const std::string& executors,
+                                const std::string& node_executors,
+                                CalculatorGraphConfig* config) {
+  for (absl::string_view spec :
+       absl::StrSplit(executors, ';', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> name_and_threads =
+        absl::StrSplit(spec, absl::MaxSplits('=', 1));
+    std::pair<absl::string_view, absl::string_view> threads_and_cpus =
+        absl::StrSplit(name_and_threads.second, absl::MaxSplits('@', 1));
+
+    AffinityThreadPoolExecutorOptions options;
+    int num_threads;
+    RET_CHECK(absl::SimpleAtoi(threads_and_cpus.first, &num_threads))
+        << "Bad executor spec: " << spec;
+    options.set_num_threads(num_threads);
+    ASSIGN_OR_RETURN(std::vector<int> cpus,
+                     ParseCpuList(std::string(threads_and_cpus.second)));
+    for (const int cpu : cpus) options.add_cpu(cpu);
+    options.set_thread_name_prefix(
+        absl::StrCat("mediapipe_", name_and_threads.first));
+
+    auto* executor = config->add_executor();
+    if (name_and_threads.first != kDefaultExecutorName) {
+      executor->set_name(std::string(name_and_threads.first));
+    }
+    executor->set_type(kAffinityExecutor);
+    *executor->mutable_options()->MutableExtension(
+        AffinityThreadPoolExecutorOptions::ext) = options;
+  }
+
+  for (absl::string_view assignment :
+       absl::StrSplit(node_executors, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> node_and_executor =
+        absl::StrSplit(assignment, absl::MaxSplits('=', 1));
+    RET_CHECK(!node_and_executor.second.empty())
+        << "Bad node executor assignment: " << assignment;
+    int assigned = 0;
+    for (auto& node : *config->mutable_node()) {
+      if (node.name() != node_and_executor.first &&
+          node.calculator() != node_and_executor.first) {
+        continue;
+      }
+      node.set_executor(std::string(node_and_executor.second));
+      ++assigned;
+    }
+    RET_CHECK_GT(assigned, 0)
+        << "No node matches " << node_and_executor.first
+        << "; nodes inside subgraphs only match once subgraphs are expanded.";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
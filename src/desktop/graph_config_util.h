@@ -0,0 +1,89 @@
+// "desktop/prebuilt/graph_config_util.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_CONFIG_UTIL_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_CONFIG_UTIL_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mediapipe/examples/common/prebuilt/calculators/deadline_admission_calculator.pb.h"
+#include "mediapipe/examples/desktop/prebuilt/calculators/async_video_encoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Reads a CalculatorGraphConfig from `path`. Files ending in ".binarypb", as
+// produced by mediapipe_binary_graph, are memory mapped and parsed as binary
+// protos; anything else is parsed as text format.
+absl::StatusOr<CalculatorGraphConfig> LoadGraphConfig(const std::string& path);
+
+// Like LoadGraphConfig, but with every subgraph node already expanded. The
+// expanded config is written to `cache_path` as a binary proto and read back
+// from there on later launches, for as long as it is newer than both `path`
+// and the running binary, which carries the registered subgraphs. Subgraphs
+// registered at runtime from other files are not tracked.
+absl::StatusOr<CalculatorGraphConfig> LoadExpandedGraphConfig(
+    const std::string& path, const std::string& cache_path);
+
+// Replaces every FlowLimiterCalculator and DeadlineAdmissionCalculator in
+// `config` with a PassThroughCalculator that forwards the throttled stream
+// unconditionally, so that every input frame reaches the rest of the graph. The
+// FINISHED back edge and the limiter options are dropped; the name, executor
+// and stream handlers of the node are kept. Returns the number of nodes
+// replaced.
+int DisableFlowLimiters(CalculatorGraphConfig* config);
+
+// Turns every FlowLimiterCalculator in `config` that throttles a single stream
+// into a DeadlineAdmissionCalculator with `options`, on the same streams and
+// FINISHED back edge. Returns the number of nodes replaced.
+int UseDeadlineAdmission(const DeadlineAdmissionCalculatorOptions& options,
+                         CalculatorGraphConfig* config);
+
+// Appends an AsyncVideoEncoderCalculator with `options` that encodes
+// `video_stream`. Every FlowLimiterCalculator or DeadlineAdmissionCalculator
+// whose FINISHED back edge reads `video_stream` is pointed at the encoder's
+// FINISHED output instead, so that an encoder falling behind throttles the
+// graph input. Returns the number of limiters pointed at the encoder.
+int AttachVideoEncoder(const std::string& video_stream,
+                       const AsyncVideoEncoderCalculatorOptions& options,
+                       CalculatorGraphConfig* config);
+
+// Appends an InFlightMemoryCalculator that taps every graph input stream and
+// node output stream of `config` and reports their image and tensor packets
+// to the MemoryAccountant in the `accountant_side_packet` side packet.
+// Streams inside subgraphs are only tapped once subgraphs are expanded.
+// Returns the number of streams tapped.
+int AttachMemoryAccounting(const std::string& accountant_side_packet,
+                           CalculatorGraphConfig* config);
+
+// Parses a CPU list such as "0-3,6" into the CPU indices it names.
+absl::StatusOr<std::vector<int>> ParseCpuList(const std::string& cpu_list);
+
+// Parses a ',' separated list of "name=value" into input side packets, e.g.
+// "render=false,num_poses=4". Values are typed by their spelling: "true" and
+// "false" become bool, integers int, other numbers float, anything else
+// std::string.
+absl::StatusOr<std::map<std::string, Packet>> ParseSidePackets(
+    const std::string& side_packets);
+
+// Adds AffinityThreadPoolExecutor executors to `config` and assigns nodes to
+// them, for trying out thread placement without editing the graph.
+//
+// `executors` is a ';' separated list of "name=num_threads[@cpu_list]", e.g.
+// "inference=2@2-3;io=1@0". The name "default" replaces the graph's default
+// executor. `node_executors` is a ',' separated list of "node=executor", where
+// node matches either a node name or a calculator type, e.g.
+// "TfLiteInferenceCalculator=inference". Executors already declared in the
+// graph can be assigned too.
+absl::Status ConfigureExecutors(const std::string& executors,
+                                const std::string& node_executors,
+                                CalculatorGraphConfig* config);
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_CONFIG_UTIL_H_
@@ -0,0 +1,35 @@
+// "desktop/prebuilt/graph_warmup.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/graph_warmup.h"
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+absl::Status WarmUpGraph(const WarmUpOptions& options, CalculatorGraph* graph,
+                         OutputStreamPoller* poller, Timestamp* timestamp) {
+  RET_CHECK_GT(options.frame_width, 0);
+  RET_CHECK_GT(options.frame_height, 0);
+
+  for (int i = 0; i < options.num_frames; ++i) {
+    auto frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGB, options.frame_width, options.frame_height,
+        ImageFrame::kDefaultAlignmentBoundary);
+    frame->SetToZero();
+    MP_RETURN_IF_ERROR(graph->AddPacketToInputStream(
+        options.input_stream, Adopt(frame.release()).At(*timestamp)));
+    *timestamp = *timestamp + 1;
+
+    MP_RETURN_IF_ERROR(graph->WaitUntilIdle());
+    Packet discarded;
+    while (poller && poller->QueueSize() > 0 && poller->Next(&discarded)) {
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
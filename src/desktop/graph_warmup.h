@@ -0,0 +1,37 @@
+// "desktop/prebuilt/graph_warmup.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_WARMUP_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_WARMUP_H_
+
+#include <string>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+struct WarmUpOptions {
+  std::string input_stream = "input_video";
+  int num_frames = 0;
+  int frame_width = 640;
+  int frame_height = 480;
+};
+
+// Pushes `options.num_frames` black SRGB frames through a started graph so
+// that interpreters allocate their tensors and caches are populated before
+// real input arrives. Each frame is run to completion before the next one is
+// sent, so flow limiters drop nothing, and whatever reaches `poller`, when
+// given, is discarded.
+//
+// Frames are stamped one microsecond apart starting at `*timestamp`, which is
+// advanced past the last warm-up frame on return. Real input must be stamped
+// after that.
+absl::Status WarmUpGraph(const WarmUpOptions& options, CalculatorGraph* graph,
+                         OutputStreamPoller* poller, Timestamp* timestamp);
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_GRAPH_WARMUP_H_
@@ -0,0 +1,271 @@
+// "desktop/prebuilt/holistic/holistic_preprocessing_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/holistic
+//
+// Measures the input preprocessing of the seven model runs per frame of
+// holistic_shared_pyramid_cpu.pbtxt (face, pose and palm detection, face and
+// pose landmarks, and two hands), without the models:
+//   - standalone: each run crops the camera's SRGBA frame with
+//     ImageToTensorCalculator, as it does in the face mesh, pose and hand
+//     graphs running side by side;
+//   - frame: each run crops the same frame with RoiToTensorCalculator;
+//   - shared: one ImagePyramidCalculator feeds every RoiToTensorCalculator,
+//     as in holistic_shared_pyramid_cpu.pbtxt;
+// and logs the full-frame conversions and pixels each way reads.
+//
+//   holistic_preprocessing_benchmark_cpu \
+//     --frame_width=1280 --frame_height=720
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/image_pyramid.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(int, frames, 200, "Number of measured frames per graph.");
+ABSL_FLAG(int, warmup_frames, 10, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 1280, "Width of the synthetic input frames.");
+ABSL_FLAG(int, frame_height, 720, "Height of the synthetic input frames.");
+ABSL_FLAG(int, min_level_size, 128,
+          "Smallest pyramid level side, as in the holistic graph.");
+
+namespace {
+
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+constexpr char kInputVideo[] = "input_video";
+constexpr char kPyramid[] = "pyramid";
+
+// One model input of the holistic graph.
+struct ModelInput {
+  const char* name;
+  int size;
+  bool keep_aspect_ratio;
+  float float_min;
+  // The whole frame when not set.
+  bool has_roi;
+  float x_center, y_center, width, height;
+};
+
+// A face, a person and two hands in a landscape frame, with the tensor
+// sizes and ranges of holistic_shared_pyramid_cpu.pbtxt.
+constexpr ModelInput kModelInputs[] = {
+    {"face_detection", 128, true, -1, false, 0, 0, 0, 0},
+    {"face_landmark", 192, false, 0, true, 0.5f, 0.25f, 0.16f, 0.28f},
+    {"pose_detection", 224, true, -1, false, 0, 0, 0, 0},
+    {"pose_landmark", 256, true, 0, true, 0.5f, 0.5f, 0.56f, 1.0f},
+    {"palm_detection", 192, true, 0, false, 0, 0, 0, 0},
+    {"hand_landmark_0", 224, true, 0, true, 0.3f, 0.6f, 0.14f, 0.25f},
+    {"hand_landmark_1", 224, true, 0, true, 0.7f, 0.6f, 0.14f, 0.25f},
+};
+
+std::string RoiStream(const ModelInput& input) {
+  return absl::StrCat(input.name, "_roi");
+}
+
+// A graph cropping every model input with `calculator`, from the frame or,
+// when `shared`, from an ImagePyramidCalculator output.
+mediapipe::CalculatorGraphConfig MakeConfig(const std::string& calculator,
+                                            bool shared) {
+  std::string text = absl::StrCat("input_stream: \"", kInputVideo, "\"\n");
+  const std::string image_stream =
+      shared ? absl::StrCat("PYRAMID:", kPyramid)
+             : absl::StrCat("IMAGE:", kInputVideo);
+  if (shared) {
+    absl::StrAppend(
+        &text, "node { calculator: \"ImagePyramidCalculator\" ",
+        "input_stream: \"IMAGE:", kInputVideo, "\" ",
+        "output_stream: \"PYRAMID:", kPyramid, "\" ",
+        "node_options: { ",
+        "[type.googleapis.com/mediapipe.ImagePyramidCalculatorOptions] { ",
+        "min_level_size: ", absl::GetFlag(FLAGS_min_level_size), " } } }\n");
+  }
+  for (const ModelInput& input : kModelInputs) {
+    const std::string keep_aspect_ratio =
+        input.keep_aspect_ratio ? "true" : "false";
+    if (input.has_roi) {
+      absl::StrAppend(&text, "input_stream: \"", RoiStream(input), "\"\n");
+    }
+    absl::StrAppend(&text, "node { calculator: \"", calculator, "\" ",
+                    "input_stream: \"", image_stream, "\" ");
+    if (input.has_roi) {
+      absl::StrAppend(&text, "input_stream: \"NORM_RECT:", RoiStream(input),
+                      "\" ");
+    }
+    absl::StrAppend(&text, "output_stream: \"TENSORS:", input.name,
+                    "_tensors\" ");
+    if (calculator == "ImageToTensorCalculator") {
+      absl::StrAppend(
+          &text, "options: { [mediapipe.ImageToTensorCalculatorOptions.ext] { ",
+          "output_tensor_width: ", input.size, " ",
+          "output_tensor_height: ", input.size, " ",
+          "keep_aspect_ratio: ", keep_aspect_ratio, " ",
+          "output_tensor_float_range { min: ", input.float_min,
+          " max: 1.0 } ", "border_mode: BORDER_ZERO } } }\n");
+    } else {
+      absl::StrAppend(
+          &text, "node_options: { ",
+          "[type.googleapis.com/mediapipe.RoiToTensorCalculatorOptions] { ",
+          "output_tensor_width: ", input.size, " ",
+          "output_tensor_height: ", input.size, " ",
+          "keep_aspect_ratio: ", keep_aspect_ratio, " ",
+          "output_tensor_float_min: ", input.float_min, " ",
+          "output_tensor_float_max: 1.0 ", "border_mode: BORDER_ZERO } } }\n");
+    }
+  }
+  return mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+      text);
+}
+
+// A frame of smooth gradients, so that the crops have something to average.
+std::unique_ptr<mediapipe::ImageFrame> MakeFrame(int width, int height) {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGBA, width, height,
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      row[x * 4 + 0] = x * 255 / width;
+      row[x * 4 + 1] = y * 255 / height;
+      row[x * 4 + 2] = (x + y) & 255;
+      row[x * 4 + 3] = 255;
+    }
+  }
+  return frame;
+}
+
+// Runs the graph of `config` on copies of `frame` and logs its per-frame
+// latency as `name`. `built_pixels`, when set, receives the pyramid pixels
+// built for the last frame.
+absl::Status BenchmarkPreprocessing(
+    const std::string& name, const mediapipe::CalculatorGraphConfig& config,
+    const mediapipe::ImageFrame& frame, int64* built_pixels) {
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  mediapipe::Packet last_pyramid;
+  if (built_pixels) {
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        kPyramid, [&last_pyramid](const mediapipe::Packet& packet) {
+          last_pyramid = packet;
+          return absl::OkStatus();
+        }));
+  }
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(frames);
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    auto input = absl::make_unique<mediapipe::ImageFrame>();
+    input->CopyFrom(frame, mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    const mediapipe::Timestamp timestamp(i);
+
+    const absl::Time sent = absl::Now();
+    for (const ModelInput& model_input : kModelInputs) {
+      if (!model_input.has_roi) continue;
+      mediapipe::NormalizedRect roi;
+      roi.set_x_center(model_input.x_center);
+      roi.set_y_center(model_input.y_center);
+      roi.set_width(model_input.width);
+      roi.set_height(model_input.height);
+      MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+          RoiStream(model_input),
+          mediapipe::MakePacket<mediapipe::NormalizedRect>(roi).At(
+              timestamp)));
+    }
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputVideo, mediapipe::Adopt(input.release()).At(timestamp)));
+    MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+    if (i >= warmup_frames) {
+      latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - sent));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  if (built_pixels) {
+    RET_CHECK(!last_pyramid.IsEmpty()) << "No pyramid was produced.";
+    *built_pixels =
+        last_pyramid.Get<mediapipe::prebuilt::ImagePyramid>().built_pixels();
+  }
+  RET_CHECK(!latencies_ms.empty()) << "No frames were measured.";
+  LOG(INFO) << name << " over " << latencies_ms.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_ms), "ms");
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  const int width = absl::GetFlag(FLAGS_frame_width);
+  const int height = absl::GetFlag(FLAGS_frame_height);
+  RET_CHECK(width > 0 && height > 0);
+  const auto frame = MakeFrame(width, height);
+  const int num_inputs = sizeof(kModelInputs) / sizeof(kModelInputs[0]);
+  LOG(INFO) << num_inputs << " model inputs per " << width << "x" << height
+            << " frame.";
+
+  MP_RETURN_IF_ERROR(BenchmarkPreprocessing(
+      "Standalone", MakeConfig("ImageToTensorCalculator", false), *frame,
+      nullptr));
+  MP_RETURN_IF_ERROR(BenchmarkPreprocessing(
+      "Frame", MakeConfig("RoiToTensorCalculator", false), *frame, nullptr));
+  int64 built_pixels = 0;
+  MP_RETURN_IF_ERROR(BenchmarkPreprocessing(
+      "Shared", MakeConfig("RoiToTensorCalculator", true), *frame,
+      &built_pixels));
+
+  // The levels each input samples, as RoiToTensorCalculator picks them.
+  mediapipe::prebuilt::ImagePyramid pyramid(
+      cv::Mat(height, width, CV_8UC3), nullptr,
+      absl::GetFlag(FLAGS_min_level_size));
+  for (const ModelInput& input : kModelInputs) {
+    const float roi_width = input.has_roi ? input.width : 1.0f;
+    const float roi_height = input.has_roi ? input.height : 1.0f;
+    const int level =
+        pyramid.LevelFor(roi_width * width, roi_height * height, input.size,
+                         input.size);
+    LOG(INFO) << input.name << ": " << input.size << "x" << input.size
+              << " from level " << level << " ("
+              << (width >> level) << "x" << (height >> level) << ")";
+  }
+
+  // ImageToTensorCalculator converts the whole SRGBA frame to RGB before
+  // every crop; the pyramid converts it once and downscales it once.
+  const int64 frame_pixels = static_cast<int64>(width) * height;
+  LOG(INFO) << "Full-frame RGB conversions per frame: " << num_inputs
+            << " standalone, 1 shared.";
+  LOG(INFO) << "Pixels converted or downscaled per frame: "
+            << num_inputs * frame_pixels << " standalone, "
+            << frame_pixels + built_pixels << " shared ("
+            << pyramid.num_levels() << " levels).";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+// "desktop/prebuilt/iris/iris_batch_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/iris
+//
+// Compares the iris half of iris_tracking_cpu.pbtxt, which crops and runs
+// the iris model once per eye in IrisLandmarkLeftAndRightCpu, against the
+// batched path of iris_tracking_batched_cpu.pbtxt, on synthetic frames and
+// face meshes of a slowly swaying head:
+//   - per eye: IrisLandmarkLeftAndRightCpu;
+//   - batched: both eyes cropped into one batch and the model run once, with
+//     every ROI derived anew, whose landmarks should stay close to the
+//     per-eye ones;
+//   - batched with reuse: the same with --reuse_threshold, logging how often
+//     an eye kept its ROI.
+//
+//   iris_batch_benchmark_cpu --frame_width=1280 --frame_height=720
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(int, frames, 500, "Number of measured frames per graph.");
+ABSL_FLAG(int, warmup_frames, 20, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 1280, "Width of the synthetic frames.");
+ABSL_FLAG(int, frame_height, 720, "Height of the synthetic frames.");
+ABSL_FLAG(double, jitter_pixels, 0.5,
+          "Largest jitter of the eye corners, in pixels, as landmark model "
+          "output has.");
+ABSL_FLAG(double, reuse_threshold, 0.05,
+          "reuse_threshold of FaceLandmarksToEyeRoisCalculator for the "
+          "batched graph with reuse.");
+
+namespace {
+
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+constexpr char kInputVideo[] = "input_video";
+constexpr char kFaceLandmarks[] = "face_landmarks";
+constexpr char kIrisLandmarks[] = "iris_landmarks";
+constexpr char kEyeRois[] = "eye_rois";
+
+constexpr int kNumFaceLandmarks = 468;
+
+constexpr char kPerEyeGraph[] = R"pb(
+  input_stream: "input_video"
+  input_stream: "face_landmarks"
+  output_stream: "iris_landmarks"
+  node {
+    calculator: "SplitNormalizedLandmarkListCalculator"
+    input_stream: "face_landmarks"
+    output_stream: "left_eye_boundary_landmarks"
+    node_options: {
+      [type.googleapis.com/mediapipe.SplitVectorCalculatorOptions] {
+        ranges: { begin: 33 end: 34 }
+        ranges: { begin: 133 end: 134 }
+        combine_outputs: true
+      }
+    }
+  }
+  node {
+    calculator: "SplitNormalizedLandmarkListCalculator"
+    input_stream: "face_landmarks"
+    output_stream: "right_eye_boundary_landmarks"
+    node_options: {
+      [type.googleapis.com/mediapipe.SplitVectorCalculatorOptions] {
+        ranges: { begin: 362 end: 363 }
+        ranges: { begin: 263 end: 264 }
+        combine_outputs: true
+      }
+    }
+  }
+  node {
+    calculator: "IrisLandmarkLeftAndRightCpu"
+    input_stream: "IMAGE:input_video"
+    input_stream: "LEFT_EYE_BOUNDARY_LANDMARKS:left_eye_boundary_landmarks"
+    input_stream: "RIGHT_EYE_BOUNDARY_LANDMARKS:right_eye_boundary_landmarks"
+    output_stream: "LEFT_EYE_CONTOUR_LANDMARKS:left_eye_contour_landmarks"
+    output_stream: "LEFT_EYE_IRIS_LANDMARKS:left_iris_landmarks"
+    output_stream: "LEFT_EYE_ROI:left_eye_roi"
+    output_stream: "RIGHT_EYE_CONTOUR_LANDMARKS:right_eye_contour_landmarks"
+    output_stream: "RIGHT_EYE_IRIS_LANDMARKS:right_iris_landmarks"
+    output_stream: "RIGHT_EYE_ROI:right_eye_roi"
+  }
+  node {
+    calculator: "ConcatenateNormalizedLandmarkListCalculator"
+    input_stream: "left_iris_landmarks"
+    input_stream: "right_iris_landmarks"
+    output_stream: "iris_landmarks"
+  }
+)pb";
+
+// The iris nodes of iris_tracking_batched_cpu.pbtxt, with the reuse
+// threshold as $0.
+constexpr char kBatchedGraph[] = R"pb(
+  input_stream: "input_video"
+  input_stream: "face_landmarks"
+  output_stream: "iris_landmarks"
+  node {
+    calculator: "ImagePropertiesCalculator"
+    input_stream: "IMAGE:input_video"
+    output_stream: "SIZE:image_size"
+  }
+  node {
+    calculator: "FaceLandmarksToEyeRoisCalculator"
+    input_stream: "LANDMARKS:face_landmarks"
+    input_stream: "IMAGE_SIZE:image_size"
+    output_stream: "NORM_RECTS:eye_rois"
+    node_options: {
+      [type.googleapis.com/mediapipe.FaceLandmarksToEyeRoisCalculatorOptions] {
+        reuse_threshold: $0
+      }
+    }
+  }
+  node {
+    calculator: "RoiToTensorCalculator"
+    input_stream: "IMAGE:input_video"
+    input_stream: "NORM_RECTS:eye_rois"
+    output_stream: "TENSORS:eye_tensors"
+    output_stream: "MATRIX:eye_matrices"
+    node_options: {
+      [type.googleapis.com/mediapipe.RoiToTensorCalculatorOptions] {
+        output_tensor_width: 64
+        output_tensor_height: 64
+        output_tensor_float_min: 0.0
+        output_tensor_float_max: 1.0
+        flip_horizontally: false
+        flip_horizontally: true
+      }
+    }
+  }
+  node {
+    calculator: "CachedInferenceCalculator"
+    input_stream: "TENSORS:eye_tensors"
+    output_stream: "TENSORS:iris_tensors"
+    node_options: {
+      [type.googleapis.com/mediapipe.CachedTfLiteInferenceCalculatorOptions] {
+        model_path: "mediapipe/modules/iris_landmark/iris_landmark.tflite"
+        batch_size: 2
+      }
+    }
+  }
+  node {
+    calculator: "IrisTensorsToLandmarksCalculator"
+    input_stream: "TENSORS:iris_tensors"
+    input_stream: "MATRIX:eye_matrices"
+    output_stream: "IRIS_LANDMARKS:iris_landmarks"
+  }
+)pb";
+
+// A face mesh of a head swaying and rolling slowly with `frame`, with only
+// the eye corners in place; the iris nodes read nothing else.
+mediapipe::NormalizedLandmarkList MakeFace(int frame, std::mt19937* random) {
+  const int width = absl::GetFlag(FLAGS_frame_width);
+  const int height = absl::GetFlag(FLAGS_frame_height);
+  const float jitter_pixels = absl::GetFlag(FLAGS_jitter_pixels);
+  std::uniform_real_distribution<float> jitter(-jitter_pixels, jitter_pixels);
+
+  const float center_x = 0.5f * width + 0.02f * width * std::sin(frame * 0.05f);
+  const float center_y = 0.42f * height;
+  const float roll = 0.1f * std::sin(frame * 0.03f);
+  // Eye corners left to right across the face, as fractions of the frame
+  // width from its center.
+  const int corners[4] = {33, 133, 362, 263};
+  const float offsets[4] = {-0.09f, -0.035f, 0.035f, 0.09f};
+
+  mediapipe::NormalizedLandmarkList face;
+  for (int i = 0; i < kNumFaceLandmarks; ++i) {
+    auto* landmark = face.add_landmark();
+    landmark->set_x(center_x / width);
+    landmark->set_y(center_y / height);
+  }
+  for (int i = 0; i < 4; ++i) {
+    const float offset = offsets[i] * width;
+    auto* landmark = face.mutable_landmark(corners[i]);
+    landmark->set_x((center_x + offset * std::cos(roll) + jitter(*random)) /
+                    width);
+    landmark->set_y((center_y + offset * std::sin(roll) + jitter(*random)) /
+                    height);
+  }
+  return face;
+}
+
+// An SRGB frame of smooth gradients.
+std::unique_ptr<mediapipe::ImageFrame> MakeFrame(int width, int height) {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, width, height,
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      row[x * 3 + 0] = x * 255 / width;
+      row[x * 3 + 1] = y * 255 / height;
+      row[x * 3 + 2] = (x + y) & 255;
+    }
+  }
+  return frame;
+}
+
+// Runs the graph of `config` and logs its per-frame latency as `name`. The
+// iris landmarks of every measured frame go to `landmarks`, by frame. When
+// `kept_rois` is set, it receives how many eye ROIs were kept from the
+// previous frame.
+absl::Status BenchmarkIris(
+    const std::string& name, const mediapipe::CalculatorGraphConfig& config,
+    std::map<int, mediapipe::NormalizedLandmarkList>* landmarks,
+    int* kept_rois) {
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+      kIrisLandmarks, [landmarks](const mediapipe::Packet& packet) {
+        (*landmarks)[packet.Timestamp().Value()] =
+            packet.Get<mediapipe::NormalizedLandmarkList>();
+        return absl::OkStatus();
+      }));
+  std::vector<mediapipe::NormalizedRect> previous_rois;
+  if (kept_rois) {
+    *kept_rois = 0;
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        kEyeRois, [&](const mediapipe::Packet& packet) {
+          const auto& rois =
+              packet.Get<std::vector<mediapipe::NormalizedRect>>();
+          for (int i = 0; i < rois.size() && i < previous_rois.size(); ++i) {
+            *kept_rois += rois[i].SerializeAsString() ==
+                          previous_rois[i].SerializeAsString();
+          }
+          previous_rois = rois;
+          return absl::OkStatus();
+        }));
+  }
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  const int width = absl::GetFlag(FLAGS_frame_width);
+  const int height = absl::GetFlag(FLAGS_frame_height);
+  const auto frame = MakeFrame(width, height);
+  std::mt19937 random(0);
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(frames);
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    auto input = absl::make_unique<mediapipe::ImageFrame>();
+    input->CopyFrom(*frame, mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    const mediapipe::Timestamp timestamp(i);
+
+    const absl::Time sent = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kFaceLandmarks,
+        mediapipe::MakePacket<mediapipe::NormalizedLandmarkList>(
+            MakeFace(i, &random))
+            .At(timestamp)));
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputVideo, mediapipe::Adopt(input.release()).At(timestamp)));
+    MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+    if (i >= warmup_frames) {
+      latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - sent));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  RET_CHECK(!latencies_ms.empty()) << "No frames were measured.";
+  LOG(INFO) << name << " over " << latencies_ms.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_ms), "ms");
+  return absl::OkStatus();
+}
+
+// The largest distance in pixels between landmarks of the same frame.
+double LargestDifference(
+    const std::map<int, mediapipe::NormalizedLandmarkList>& a,
+    const std::map<int, mediapipe::NormalizedLandmarkList>& b) {
+  const int width = absl::GetFlag(FLAGS_frame_width);
+  const int height = absl::GetFlag(FLAGS_frame_height);
+  double largest = 0;
+  for (const auto& entry : a) {
+    const auto it = b.find(entry.first);
+    if (it == b.end()) continue;
+    const int count =
+        std::min(entry.second.landmark_size(), it->second.landmark_size());
+    for (int i = 0; i < count; ++i) {
+      const auto& p = entry.second.landmark(i);
+      const auto& q = it->second.landmark(i);
+      largest = std::max<double>(largest,
+                                 std::hypot((p.x() - q.x()) * width,
+                                            (p.y() - q.y()) * height));
+    }
+  }
+  return largest;
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  RET_CHECK(absl::GetFlag(FLAGS_frame_width) > 0 &&
+            absl::GetFlag(FLAGS_frame_height) > 0);
+  LOG(INFO) << "One face, two eyes on " << absl::GetFlag(FLAGS_frame_width)
+            << "x" << absl::GetFlag(FLAGS_frame_height) << " frames.";
+
+  std::map<int, mediapipe::NormalizedLandmarkList> per_eye;
+  MP_RETURN_IF_ERROR(BenchmarkIris(
+      "Per eye",
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          kPerEyeGraph),
+      &per_eye, nullptr));
+
+  std::map<int, mediapipe::NormalizedLandmarkList> batched;
+  MP_RETURN_IF_ERROR(BenchmarkIris(
+      "Batched",
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          absl::Substitute(kBatchedGraph, 0)),
+      &batched, nullptr));
+
+  std::map<int, mediapipe::NormalizedLandmarkList> reused;
+  int kept_rois = 0;
+  MP_RETURN_IF_ERROR(BenchmarkIris(
+      "Batched with reuse",
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          absl::Substitute(kBatchedGraph,
+                           absl::GetFlag(FLAGS_reuse_threshold))),
+      &reused, &kept_rois));
+
+  RET_CHECK_EQ(per_eye.size(), batched.size())
+      << "The graphs produced iris landmarks for different frames.";
+  LOG(INFO) << "Largest iris landmark difference from per eye: "
+            << LargestDifference(per_eye, batched) << " px batched, "
+            << LargestDifference(per_eye, reused) << " px with reuse.";
+  const int eye_frames =
+      2 * (absl::GetFlag(FLAGS_warmup_frames) + absl::GetFlag(FLAGS_frames));
+  LOG(INFO) << "ROIs kept from the previous frame: " << kept_rois << " of "
+            << eye_frames << " eyes.";
+  LOG(INFO) << "Iris model runs per frame: 2 per eye, 1 batched.";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+// "desktop/prebuilt/latency_stats.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+double Percentile(const std::vector<double>& sorted, double fraction) {
+  const size_t index = std::min(sorted.size() - 1,
+                                static_cast<size_t>(fraction * sorted.size()));
+  return sorted[index];
+}
+
+}  // namespace
+
+LatencyStats SummarizeLatencies(std::vector<double> latencies) {
+  LatencyStats stats;
+  if (latencies.empty()) return stats;
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (const double latency : latencies) total += latency;
+  stats.count = latencies.size();
+  stats.mean = total / latencies.size();
+  stats.p50 = Percentile(latencies, 0.5);
+  stats.p90 = Percentile(latencies, 0.9);
+  stats.p99 = Percentile(latencies, 0.99);
+  stats.max = latencies.back();
+  return stats;
+}
+
+std::string FormatLatencyStats(const LatencyStats& stats,
+                               absl::string_view unit) {
+  return absl::StrCat("mean ", stats.mean, " ", unit, ", p50 ", stats.p50,
+                      " ", unit, ", p90 ", stats.p90, " ", unit, ", p99 ",
+                      stats.p99, " ", unit, ", max ", stats.max, " ", unit);
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,35 @@
+// "desktop/prebuilt/latency_stats.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_LATENCY_STATS_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_LATENCY_STATS_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Summary of per-frame latencies, in the unit they were measured in.
+struct LatencyStats {
+  int count = 0;
+  double mean = 0;
+  double p50 = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
+// All zero for no latencies.
+LatencyStats SummarizeLatencies(std::vector<double> latencies);
+
+// "mean 1.5 ms, p50 1.4 ms, p90 2 ms, p99 3.1 ms, max 4 ms" for unit "ms".
+std::string FormatLatencyStats(const LatencyStats& stats,
+                               absl::string_view unit);
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_LATENCY_STATS_H_
@@ -0,0 +1,100 @@
+// "desktop/prebuilt/memory_accountant.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/memory_accountant.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+int64 MemoryAccountant::PayloadBytes(const Packet& packet) {
+  if (packet.IsEmpty()) return 0;
+  if (packet.ValidateAsType<ImageFrame>().ok()) {
+    const auto& frame = packet.Get<ImageFrame>();
+    return static_cast<int64>(frame.WidthStep()) * frame.Height();
+  }
+  if (packet.ValidateAsType<Tensor>().ok()) {
+    return packet.Get<Tensor>().bytes();
+  }
+  if (packet.ValidateAsType<std::vector<Tensor>>().ok()) {
+    int64 bytes = 0;
+    for (const auto& tensor : packet.Get<std::vector<Tensor>>()) {
+      bytes += tensor.bytes();
+    }
+    return bytes;
+  }
+  return 0;
+}
+
+void MemoryAccountant::Track(const std::string& stream, const Packet& packet,
+                             int64 bytes) {
+  absl::MutexLock lock(&mutex_);
+  Stream& tracked = streams_[stream];
+  tracked.packets.push_back({packet_internal::GetHolderShared(packet), bytes});
+  tracked.peak_bytes = std::max(tracked.peak_bytes, Sweep(&tracked));
+}
+
+std::vector<MemoryAccountant::StreamUsage> MemoryAccountant::GetUsage() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<StreamUsage> usage;
+  usage.reserve(streams_.size());
+  for (auto& name_and_stream : streams_) {
+    StreamUsage stream_usage;
+    stream_usage.stream = name_and_stream.first;
+    stream_usage.live_bytes = Sweep(&name_and_stream.second);
+    stream_usage.live_packets = name_and_stream.second.packets.size();
+    stream_usage.peak_bytes = name_and_stream.second.peak_bytes;
+    usage.push_back(stream_usage);
+  }
+  return usage;
+}
+
+int64 MemoryAccountant::Sweep(Stream* stream) {
+  auto& packets = stream->packets;
+  packets.erase(std::remove_if(packets.begin(), packets.end(),
+                               [](const Tracked& tracked) {
+                                 return tracked.payload.expired();
+                               }),
+                packets.end());
+  int64 bytes = 0;
+  for (const auto& tracked : packets) bytes += tracked.bytes;
+  return bytes;
+}
+
+int64 CurrentRssBytes() {
+#if defined(__linux__)
+  // The second field of statm is the resident page count.
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (statm == nullptr) return 0;
+  long size_pages = 0;
+  long resident_pages = 0;
+  const int fields = std::fscanf(statm, "%ld %ld", &size_pages,
+                                 &resident_pages);
+  std::fclose(statm);
+  if (fields != 2) return 0;
+  return static_cast<int64>(resident_pages) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif  // __linux__
+}
+
+int64 PeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;  // Bytes on macOS.
+#else
+  return static_cast<int64>(usage.ru_maxrss) * 1024;  // Kilobytes elsewhere.
+#endif  // __APPLE__
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,70 @@
+// "desktop/prebuilt/memory_accountant.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_MEMORY_ACCOUNTANT_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_MEMORY_ACCOUNTANT_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+// Counts the bytes of image and tensor packets that are still alive, per
+// stream. A packet is tracked through a weak reference to its payload, so
+// tracking does not keep it alive: its bytes count for as long as any queue,
+// calculator or poller holds a copy, and stop counting once the last copy is
+// gone.
+//
+// Fed by InFlightMemoryCalculator, see AttachMemoryAccounting. Thread-safe.
+class MemoryAccountant {
+ public:
+  struct StreamUsage {
+    std::string stream;
+    int64 live_bytes = 0;
+    int live_packets = 0;
+    int64 peak_bytes = 0;
+  };
+
+  // Bytes of the ImageFrame, Tensor or std::vector<Tensor> in `packet`, or 0
+  // for other payloads.
+  static int64 PayloadBytes(const Packet& packet);
+
+  // Starts counting the payload of `packet` towards `stream`.
+  void Track(const std::string& stream, const Packet& packet, int64 bytes);
+
+  // Usage of every tracked stream, by stream name.
+  std::vector<StreamUsage> GetUsage();
+
+ private:
+  struct Tracked {
+    std::weak_ptr<packet_internal::HolderBase> payload;
+    int64 bytes;
+  };
+  struct Stream {
+    std::vector<Tracked> packets;
+    int64 peak_bytes = 0;
+  };
+
+  // Forgets the packets of `stream` that are gone. Returns the live bytes.
+  static int64 Sweep(Stream* stream);
+
+  absl::Mutex mutex_;
+  std::map<std::string, Stream> streams_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Resident set size of this process, and its peak so far, in bytes. 0 where
+// unavailable.
+int64 CurrentRssBytes();
+int64 PeakRssBytes();
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_MEMORY_ACCOUNTANT_H_
@@ -0,0 +1,374 @@
+// "desktop/prebuilt/multipose/multi_pose_detection_decode_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/multipose
+//
+// Compares TensorsToDetectionsCalculator followed by
+// NonMaxSuppressionCalculator against SsdDecodeNmsCalculator on synthetic pose
+// detector output, with the options of multi_pose_detection_cpu.pbtxt, and
+// checks that both produce the same detections:
+//
+//   multi_pose_detection_decode_benchmark_cpu --people=4
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(int, people, 4, "Number of people in the synthetic detector output.");
+ABSL_FLAG(double, overlap, 0.5,
+          "Fraction of their width by which neighbouring people overlap.");
+ABSL_FLAG(double, max_difference, 1e-4,
+          "Largest difference between the detections of the two paths, in "
+          "relative coordinates or score, before the benchmark fails.");
+ABSL_FLAG(int, frames, 1000, "Number of measured frames per graph.");
+ABSL_FLAG(int, warmup_frames, 20, "Number of unmeasured frames sent first.");
+
+namespace {
+
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+constexpr char kTensors[] = "detection_tensors";
+constexpr char kDetections[] = "detections";
+
+constexpr int kNumBoxes = 2254;
+constexpr int kNumCoords = 12;
+constexpr int kNumKeypoints = 4;
+constexpr float kInputSize = 224.0f;
+// Distinct synthetic frames, cycled through.
+constexpr int kNumInputs = 16;
+
+constexpr char kAnchorsNode[] = R"pb(
+  node {
+    calculator: "SsdAnchorsCalculator"
+    output_side_packet: "anchors"
+    options: {
+      [mediapipe.SsdAnchorsCalculatorOptions.ext] {
+        num_layers: 5
+        min_scale: 0.1484375
+        max_scale: 0.75
+        input_size_height: 224
+        input_size_width: 224
+        anchor_offset_x: 0.5
+        anchor_offset_y: 0.5
+        strides: 8
+        strides: 16
+        strides: 32
+        strides: 32
+        strides: 32
+        aspect_ratios: 1.0
+        fixed_anchor_size: true
+      }
+    }
+  }
+)pb";
+
+constexpr char kChainNodes[] = R"pb(
+  node {
+    calculator: "TensorsToDetectionsCalculator"
+    input_stream: "TENSORS:detection_tensors"
+    input_side_packet: "ANCHORS:anchors"
+    output_stream: "DETECTIONS:unfiltered_detections"
+    options: {
+      [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+        num_classes: 1
+        num_boxes: 2254
+        num_coords: 12
+        box_coord_offset: 0
+        keypoint_coord_offset: 4
+        num_keypoints: 4
+        num_values_per_keypoint: 2
+        sigmoid_score: true
+        score_clipping_thresh: 100.0
+        reverse_output_order: true
+        x_scale: 224.0
+        y_scale: 224.0
+        h_scale: 224.0
+        w_scale: 224.0
+        min_score_thresh: 0.15
+        max_results: 50
+      }
+    }
+  }
+  node {
+    calculator: "NonMaxSuppressionCalculator"
+    input_stream: "unfiltered_detections"
+    output_stream: "detections"
+    options: {
+      [mediapipe.NonMaxSuppressionCalculatorOptions.ext] {
+        min_suppression_threshold: 0.35
+        max_num_detections: 2
+        overlap_type: JACCARD
+        algorithm: WEIGHTED
+      }
+    }
+  }
+)pb";
+
+constexpr char kFusedNodes[] = R"pb(
+  node {
+    calculator: "SsdDecodeNmsCalculator"
+    input_stream: "TENSORS:detection_tensors"
+    input_side_packet: "ANCHORS:anchors"
+    output_stream: "DETECTIONS:detections"
+    options: {
+      [mediapipe.SsdDecodeNmsCalculatorOptions.ext] {
+        num_boxes: 2254
+        num_coords: 12
+        box_coord_offset: 0
+        keypoint_coord_offset: 4
+        num_keypoints: 4
+        num_values_per_keypoint: 2
+        sigmoid_score: true
+        score_clipping_thresh: 100.0
+        reverse_output_order: true
+        x_scale: 224.0
+        y_scale: 224.0
+        h_scale: 224.0
+        w_scale: 224.0
+        min_score_thresh: 0.15
+        max_results: 50
+        min_suppression_threshold: 0.35
+        max_num_detections: 2
+        overlap_type: JACCARD
+      }
+    }
+  }
+)pb";
+
+// Raw boxes and scores of one frame.
+struct DetectorOutput {
+  std::vector<float> boxes;
+  std::vector<float> scores;
+};
+
+mediapipe::CalculatorGraphConfig MakeConfig(const char* nodes) {
+  auto config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          absl::StrCat(kAnchorsNode, nodes));
+  config.add_input_stream(kTensors);
+  config.add_output_stream(kDetections);
+  return config;
+}
+
+absl::StatusOr<std::vector<mediapipe::Anchor>> GenerateAnchors() {
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(MakeConfig("")));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  ASSIGN_OR_RETURN(mediapipe::Packet anchors,
+                   graph.GetOutputSidePacket("anchors"));
+  return anchors.Get<std::vector<mediapipe::Anchor>>();
+}
+
+// Detector output with `people` clusters of confident boxes, as the model
+// gives around each person, over a background of low scores. Every anchor
+// whose center falls into a person's box votes for a jittered copy of it.
+// Neighbours overlap by `overlap` of their width and are offset vertically
+// too, so that the box enclosing two of them is larger than their union and
+// the overlap measures of suppression tell apart.
+DetectorOutput MakeDetectorOutput(
+    const std::vector<mediapipe::Anchor>& anchors, int people, float overlap,
+    int seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+  std::uniform_real_distribution<float> confident(0.0f, 4.0f);
+  DetectorOutput output;
+  output.boxes.assign(kNumBoxes * kNumCoords, 0.0f);
+  output.scores.assign(kNumBoxes, -8.0f);
+  for (int person = 0; person < people; ++person) {
+    const float width = 0.6f / people;
+    const float height = 0.5f;
+    const float center_x =
+        0.5f + (person - (people - 1) / 2.0f) * width * (1 - overlap);
+    const float center_y =
+        0.5f + (person % 2 == 0 ? -0.05f : 0.05f) + jitter(random);
+    for (int i = 0; i < kNumBoxes; ++i) {
+      const auto& anchor = anchors[i];
+      if (std::abs(anchor.x_center() - center_x) > width / 4 ||
+          std::abs(anchor.y_center() - center_y) > height / 4) {
+        continue;
+      }
+      output.scores[i] = confident(random) - 1.0f;
+      // Model output order is x, y, w, h, relative to the anchor and scaled
+      // by the input size.
+      float* box = &output.boxes[i * kNumCoords];
+      box[0] = (center_x + jitter(random) - anchor.x_center()) * kInputSize /
+               anchor.w();
+      box[1] = (center_y + jitter(random) - anchor.y_center()) * kInputSize /
+               anchor.h();
+      box[2] = (width + jitter(random)) * kInputSize / anchor.w();
+      box[3] = (height + jitter(random)) * kInputSize / anchor.h();
+      for (int k = 0; k < kNumKeypoints; ++k) {
+        box[4 + k * 2] = (center_x + jitter(random) - anchor.x_center()) *
+                         kInputSize / anchor.w();
+        box[5 + k * 2] = (center_y + (k - 1.5f) * height / 4 -
+                          anchor.y_center()) *
+                         kInputSize / anchor.h();
+      }
+    }
+  }
+  return output;
+}
+
+mediapipe::Packet MakeTensorsPacket(const DetectorOutput& output) {
+  std::vector<mediapipe::Tensor> tensors;
+  tensors.emplace_back(mediapipe::Tensor::ElementType::kFloat32,
+                       mediapipe::Tensor::Shape{1, kNumBoxes, kNumCoords});
+  tensors.emplace_back(mediapipe::Tensor::ElementType::kFloat32,
+                       mediapipe::Tensor::Shape{1, kNumBoxes, 1});
+  {
+    auto view = tensors[0].GetCpuWriteView();
+    std::copy(output.boxes.begin(), output.boxes.end(),
+              view.buffer<float>());
+  }
+  {
+    auto view = tensors[1].GetCpuWriteView();
+    std::copy(output.scores.begin(), output.scores.end(),
+              view.buffer<float>());
+  }
+  return mediapipe::MakePacket<std::vector<mediapipe::Tensor>>(
+      std::move(tensors));
+}
+
+// Runs the decode and suppression `nodes` over the inputs, logs their
+// per-frame latency and returns the detections of each distinct input.
+absl::StatusOr<std::vector<std::vector<mediapipe::Detection>>> Benchmark(
+    const std::string& name, const char* nodes,
+    const std::vector<DetectorOutput>& inputs) {
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(MakeConfig(nodes)));
+  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller(kDetections));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<std::vector<mediapipe::Detection>> results(inputs.size());
+  std::vector<double> latencies_us;
+  latencies_us.reserve(frames);
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    const int input = i % inputs.size();
+    mediapipe::Packet tensors =
+        MakeTensorsPacket(inputs[input]).At(mediapipe::Timestamp(i));
+
+    const absl::Time sent = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(kTensors, tensors));
+    mediapipe::Packet packet;
+    RET_CHECK(poller.Next(&packet)) << "Graph stopped producing output.";
+    if (i >= warmup_frames) {
+      latencies_us.push_back(absl::ToDoubleMicroseconds(absl::Now() - sent));
+    }
+    if (i < static_cast<int>(inputs.size())) {
+      results[input] = packet.Get<std::vector<mediapipe::Detection>>();
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  RET_CHECK(!latencies_us.empty()) << "No frames were measured.";
+  LOG(INFO) << name << " over " << latencies_us.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_us), "us");
+  return results;
+}
+
+// Largest difference between the boxes, keypoints and scores of `a` and `b`.
+absl::StatusOr<float> MaxDifference(
+    const std::vector<mediapipe::Detection>& a,
+    const std::vector<mediapipe::Detection>& b) {
+  RET_CHECK_EQ(a.size(), b.size()) << "Different number of detections.";
+  float difference = 0;
+  auto track = [&difference](float x, float y) {
+    difference = std::max(difference, std::abs(x - y));
+  };
+  for (size_t i = 0; i < a.size(); ++i) {
+    const auto& box_a = a[i].location_data().relative_bounding_box();
+    const auto& box_b = b[i].location_data().relative_bounding_box();
+    track(a[i].score(0), b[i].score(0));
+    track(box_a.xmin(), box_b.xmin());
+    track(box_a.ymin(), box_b.ymin());
+    track(box_a.width(), box_b.width());
+    track(box_a.height(), box_b.height());
+    const auto& location_a = a[i].location_data();
+    const auto& location_b = b[i].location_data();
+    RET_CHECK_EQ(location_a.relative_keypoints_size(),
+                 location_b.relative_keypoints_size());
+    for (int k = 0; k < location_a.relative_keypoints_size(); ++k) {
+      track(location_a.relative_keypoints(k).x(),
+            location_b.relative_keypoints(k).x());
+      track(location_a.relative_keypoints(k).y(),
+            location_b.relative_keypoints(k).y());
+    }
+  }
+  return difference;
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  const int people = absl::GetFlag(FLAGS_people);
+  const float overlap = absl::GetFlag(FLAGS_overlap);
+  // Without people neither path outputs a packet to wait for.
+  RET_CHECK_GT(people, 0) << "--people must be positive.";
+  RET_CHECK(overlap >= 0 && overlap < 1) << "--overlap must be in [0, 1).";
+  ASSIGN_OR_RETURN(std::vector<mediapipe::Anchor> anchors, GenerateAnchors());
+  RET_CHECK_EQ(anchors.size(), kNumBoxes);
+
+  std::vector<DetectorOutput> inputs;
+  int candidates = 0;
+  for (int seed = 0; seed < kNumInputs; ++seed) {
+    inputs.push_back(MakeDetectorOutput(anchors, people, overlap, seed));
+    for (const float logit : inputs.back().scores) {
+      if (logit >= std::log(0.15f / 0.85f)) ++candidates;
+    }
+  }
+  LOG(INFO) << people << " people, "
+            << candidates / kNumInputs
+            << " boxes above the score threshold per frame.";
+
+  ASSIGN_OR_RETURN(
+      auto chain,
+      Benchmark("TensorsToDetections + NonMaxSuppression", kChainNodes,
+                inputs));
+  ASSIGN_OR_RETURN(auto fused,
+                   Benchmark("SsdDecodeNms", kFusedNodes, inputs));
+
+  float difference = 0;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    ASSIGN_OR_RETURN(float input_difference,
+                     MaxDifference(chain[i], fused[i]));
+    difference = std::max(difference, input_difference);
+  }
+  LOG(INFO) << "Largest difference between the detections: " << difference;
+  RET_CHECK_LE(difference, absl::GetFlag(FLAGS_max_difference))
+      << "SsdDecodeNms and the two-node chain disagree.";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+// "desktop/prebuilt/multipose/multi_pose_overlay_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/multipose
+//
+// Compares AnnotationOverlayCalculator against
+// BatchedAnnotationOverlayCalculator on the render data of several tracked
+// people, as produced by multi_pose_tracking_cpu.pbtxt, and checks that both
+// draw the same image:
+//
+//   multi_pose_overlay_benchmark_cpu --people=8 \
+//     --frame_width=1920 --frame_height=1080
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/render_data.pb.h"
+
+ABSL_FLAG(int, people, 8, "Number of people drawn per frame.");
+ABSL_FLAG(int, frames, 200, "Number of measured frames per calculator.");
+ABSL_FLAG(int, warmup_frames, 10, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 1920, "Width of the synthetic input frames.");
+ABSL_FLAG(int, frame_height, 1080, "Height of the synthetic input frames.");
+ABSL_FLAG(int, pixel_tolerance, 128,
+          "Channel difference up to which two drawn pixels count as equal. "
+          "Only one of the calculators anti-aliases, so edge pixels differ by "
+          "up to half the intensity.");
+ABSL_FLAG(double, max_mismatched_fraction, 0.05,
+          "Largest share of the annotated pixels allowed to differ by more "
+          "than --pixel_tolerance.");
+
+namespace {
+
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+constexpr char kInputVideo[] = "input_video";
+constexpr char kRenderData[] = "render_data";
+constexpr char kOutputVideo[] = "output_video";
+
+constexpr int kNumLandmarks = 33;
+
+// Landmark connections of the full-body pose topology, as drawn by
+// LandmarksToRenderDataCalculator in the pose landmark subgraphs.
+constexpr int kConnections[][2] = {
+    {0, 1},   {1, 2},   {2, 3},   {3, 7},   {0, 4},   {4, 5},   {5, 6},
+    {6, 8},   {9, 10},  {11, 12}, {11, 13}, {13, 15}, {15, 17}, {15, 19},
+    {15, 21}, {17, 19}, {12, 14}, {14, 16}, {16, 18}, {16, 20}, {16, 22},
+    {18, 20}, {11, 23}, {12, 24}, {23, 24}, {23, 25}, {24, 26}, {25, 27},
+    {26, 28}, {27, 29}, {28, 30}, {29, 31}, {30, 32}, {27, 31}, {28, 32}};
+
+void SetColor(int r, int g, int b, mediapipe::RenderAnnotation* annotation) {
+  annotation->mutable_color()->set_r(r);
+  annotation->mutable_color()->set_g(g);
+  annotation->mutable_color()->set_b(b);
+}
+
+// Render data for `people` people spread over the frame: per person, an ROI
+// rectangle, the landmark connections and the landmarks.
+std::vector<mediapipe::RenderData> MakeRenderData(int people) {
+  std::mt19937 random(people);
+  std::uniform_real_distribution<float> jitter(-0.02f, 0.02f);
+  std::vector<mediapipe::RenderData> render_data(people);
+  for (int person = 0; person < people; ++person) {
+    const float center_x = (person + 0.5f) / people;
+    const float width = 0.8f / people;
+    auto& data = render_data[person];
+
+    auto* roi = data.add_render_annotations();
+    roi->set_thickness(4);
+    SetColor(255, 0, 0, roi);
+    auto* rect = roi->mutable_rectangle();
+    rect->set_normalized(true);
+    rect->set_left(center_x - width / 2);
+    rect->set_right(center_x + width / 2);
+    rect->set_top(0.1f);
+    rect->set_bottom(0.95f);
+    rect->set_rotation(jitter(random) * 5);
+
+    std::vector<std::pair<float, float>> landmarks(kNumLandmarks);
+    for (int i = 0; i < kNumLandmarks; ++i) {
+      landmarks[i] = {center_x + width * (i % 2 ? 0.25f : -0.25f) +
+                          jitter(random),
+                      0.15f + 0.78f * i / kNumLandmarks + jitter(random)};
+    }
+    for (const auto& connection : kConnections) {
+      auto* annotation = data.add_render_annotations();
+      annotation->set_thickness(4);
+      SetColor(255, 255, 255, annotation);
+      auto* line = annotation->mutable_line();
+      line->set_normalized(true);
+      line->set_x_start(landmarks[connection[0]].first);
+      line->set_y_start(landmarks[connection[0]].second);
+      line->set_x_end(landmarks[connection[1]].first);
+      line->set_y_end(landmarks[connection[1]].second);
+    }
+    for (const auto& landmark : landmarks) {
+      auto* annotation = data.add_render_annotations();
+      annotation->set_thickness(4);
+      SetColor(255, 0, 0, annotation);
+      auto* point = annotation->mutable_point();
+      point->set_normalized(true);
+      point->set_x(landmark.first);
+      point->set_y(landmark.second);
+    }
+  }
+  return render_data;
+}
+
+// Runs a graph of the single overlay `calculator`, logs its per-frame latency
+// and returns the last frame it drew.
+absl::StatusOr<mediapipe::Packet> BenchmarkOverlay(
+    const std::string& calculator,
+    const std::vector<mediapipe::RenderData>& render_data) {
+  mediapipe::CalculatorGraphConfig config;
+  config.add_input_stream(kInputVideo);
+  config.add_input_stream(kRenderData);
+  config.add_output_stream(kOutputVideo);
+  auto* node = config.add_node();
+  node->set_calculator(calculator);
+  node->add_input_stream(absl::StrCat("IMAGE:", kInputVideo));
+  node->add_input_stream(absl::StrCat("VECTOR:", kRenderData));
+  node->add_output_stream(absl::StrCat("IMAGE:", kOutputVideo));
+
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller(kOutputVideo));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(frames);
+  mediapipe::Packet packet;
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    auto frame = absl::make_unique<mediapipe::ImageFrame>(
+        mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+        absl::GetFlag(FLAGS_frame_height),
+        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    frame->SetToZero();
+    const mediapipe::Timestamp timestamp(i);
+
+    const absl::Time sent = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kRenderData,
+        mediapipe::MakePacket<std::vector<mediapipe::RenderData>>(render_data)
+            .At(timestamp)));
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputVideo, mediapipe::Adopt(frame.release()).At(timestamp)));
+    RET_CHECK(poller.Next(&packet)) << "Graph stopped producing output.";
+    if (i >= warmup_frames) {
+      latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - sent));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  RET_CHECK(!latencies_ms.empty()) << "No frames were measured.";
+  LOG(INFO) << calculator << " over " << latencies_ms.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_ms), "ms");
+  return packet;
+}
+
+// Compares the frames drawn by both calculators on the same black input.
+// Anti-aliased edges differ by design, so pixels count as mismatched only past
+// --pixel_tolerance, and the check fails once more than
+// --max_mismatched_fraction of the pixels either calculator drew on mismatch.
+absl::Status CompareFrames(const mediapipe::ImageFrame& expected,
+                           const mediapipe::ImageFrame& actual) {
+  RET_CHECK(expected.Format() == actual.Format() &&
+            expected.Width() == actual.Width() &&
+            expected.Height() == actual.Height())
+      << "The calculators output frames of different formats or sizes.";
+  const int row_bytes = expected.Width() * expected.NumberOfChannels();
+  const int tolerance = absl::GetFlag(FLAGS_pixel_tolerance);
+  int max_difference = 0;
+  int64_t total_difference = 0;
+  int64_t annotated = 0;
+  int64_t mismatched = 0;
+  for (int row = 0; row < expected.Height(); ++row) {
+    const uint8_t* expected_row =
+        expected.PixelData() + row * expected.WidthStep();
+    const uint8_t* actual_row = actual.PixelData() + row * actual.WidthStep();
+    for (int i = 0; i < row_bytes; ++i) {
+      if (expected_row[i] == 0 && actual_row[i] == 0) continue;
+      const int difference = std::abs(expected_row[i] - actual_row[i]);
+      max_difference = std::max(max_difference, difference);
+      total_difference += difference;
+      ++annotated;
+      if (difference > tolerance) ++mismatched;
+    }
+  }
+  RET_CHECK_GT(annotated, 0) << "Neither calculator drew anything.";
+  const double mismatched_fraction =
+      static_cast<double>(mismatched) / annotated;
+  LOG(INFO) << "Over " << annotated << " annotated channel values: max "
+            << "difference " << max_difference << ", mean difference "
+            << static_cast<double>(total_difference) / annotated << ", "
+            << mismatched_fraction * 100 << "% past the tolerance of "
+            << tolerance;
+  RET_CHECK_LE(mismatched_fraction,
+               absl::GetFlag(FLAGS_max_mismatched_fraction))
+      << "BatchedAnnotationOverlayCalculator does not draw what "
+      << "AnnotationOverlayCalculator draws.";
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  const std::vector<mediapipe::RenderData> render_data =
+      MakeRenderData(absl::GetFlag(FLAGS_people));
+  int annotations = 0;
+  for (const auto& data : render_data) {
+    annotations += data.render_annotations_size();
+  }
+  LOG(INFO) << absl::GetFlag(FLAGS_people) << " people, " << annotations
+            << " annotations on " << absl::GetFlag(FLAGS_frame_width) << "x"
+            << absl::GetFlag(FLAGS_frame_height) << " frames.";
+
+  ASSIGN_OR_RETURN(
+      mediapipe::Packet expected,
+      BenchmarkOverlay("AnnotationOverlayCalculator", render_data));
+  ASSIGN_OR_RETURN(
+      mediapipe::Packet actual,
+      BenchmarkOverlay("BatchedAnnotationOverlayCalculator", render_data));
+  return CompareFrames(expected.Get<mediapipe::ImageFrame>(),
+                       actual.Get<mediapipe::ImageFrame>());
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
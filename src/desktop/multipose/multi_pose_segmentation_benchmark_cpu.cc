@@ -0,0 +1,227 @@
+// "desktop/prebuilt/multipose/multi_pose_segmentation_benchmark_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop/multipose
+//
+// Measures what keeping the segmentation masks of several tracked people
+// costs per frame on CPU, outside of the model, which computes the masks
+// either way:
+//   - full resolution: each person's float mask warped into a float mask of
+//     the frame, as PoseLandmarksAndSegmentationInverseProjection does;
+//   - compact: each mask quantized to 8 bits at model resolution, placed in
+//     the frame and blended with the previous frame's, as
+//     multi_pose_landmark_cpu.pbtxt does with segmentation enabled;
+// and what a consumer then pays when it asks for the 8-bit mask of the
+// whole frame or of a region of it.
+//
+//   multi_pose_segmentation_benchmark_cpu --people=4 \
+//     --frame_width=1920 --frame_height=1080 --region_fraction=0.25
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/compact_mask.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(int, people, 4, "Number of people segmented per frame.");
+ABSL_FLAG(int, frames, 200, "Number of measured frames per path.");
+ABSL_FLAG(int, warmup_frames, 10, "Number of unmeasured frames run first.");
+ABSL_FLAG(int, frame_width, 1920, "Width of the frames.");
+ABSL_FLAG(int, frame_height, 1080, "Height of the frames.");
+ABSL_FLAG(int, mask_size, 256, "Width and height of the model's mask.");
+ABSL_FLAG(double, region_fraction, 0.25,
+          "Width and height of the requested region, as a fraction of the "
+          "frame's.");
+
+namespace {
+
+using ::mediapipe::prebuilt::CompactMask;
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+// The ROI of each person, standing side by side, swaying with `frame`.
+std::vector<mediapipe::NormalizedRect> MakeRois(int people, int frame) {
+  std::vector<mediapipe::NormalizedRect> rois(people);
+  for (int person = 0; person < people; ++person) {
+    auto& roi = rois[person];
+    roi.set_x_center((person + 0.5f) / people +
+                     0.01f * std::sin(frame * 0.1f + person));
+    roi.set_y_center(0.5f);
+    roi.set_width(0.9f / people);
+    roi.set_height(0.9f);
+    roi.set_rotation(0.05f * std::sin(frame * 0.05f + person));
+  }
+  return rois;
+}
+
+// A soft ellipse of probabilities.
+cv::Mat MakeMask(int size) {
+  cv::Mat mask(size, size, CV_32FC1);
+  for (int y = 0; y < size; ++y) {
+    float* row = mask.ptr<float>(y);
+    for (int x = 0; x < size; ++x) {
+      const float dx = (x + 0.5f) / size * 2 - 1;
+      const float dy = (y + 0.5f) / size * 2 - 1;
+      const float distance = std::sqrt(dx * dx * 4 + dy * dy);
+      row[x] = 1 / (1 + std::exp((distance - 0.8f) * 20));
+    }
+  }
+  return mask;
+}
+
+// Runs `step(frame)` for every frame and logs its latency as `name`.
+absl::Status Measure(const std::string& name,
+                     const std::function<void(int)>& step) {
+  const int warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  const int frames = absl::GetFlag(FLAGS_frames);
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(frames);
+  for (int i = 0; i < warmup_frames + frames; ++i) {
+    const absl::Time start = absl::Now();
+    step(i);
+    if (i >= warmup_frames) {
+      latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - start));
+    }
+  }
+  RET_CHECK(!latencies_ms.empty()) << "No frames were measured.";
+  LOG(INFO) << name << " over " << latencies_ms.size() << " frames: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_ms), "ms");
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  const int people = absl::GetFlag(FLAGS_people);
+  const int width = absl::GetFlag(FLAGS_frame_width);
+  const int height = absl::GetFlag(FLAGS_frame_height);
+  const int mask_size = absl::GetFlag(FLAGS_mask_size);
+  const double region_fraction = absl::GetFlag(FLAGS_region_fraction);
+  RET_CHECK(people > 0 && width > 0 && height > 0 && mask_size > 0);
+  RET_CHECK(region_fraction > 0 && region_fraction <= 1);
+  LOG(INFO) << people << " people, " << mask_size << "x" << mask_size
+            << " masks, " << width << "x" << height << " frames.";
+
+  const cv::Mat model_mask = MakeMask(mask_size);
+  // The model input is square and the ROIs are not: the padding
+  // ImageToTensorCalculator adds to keep the aspect ratio.
+  auto letterbox_padding = [&](const mediapipe::NormalizedRect& roi) {
+    const float aspect = roi.width() * width / (roi.height() * height);
+    const float pad = aspect < 1 ? (1 - aspect) / 2 : 0;
+    return std::array<float, 4>{pad, 0, pad, 0};
+  };
+
+  // Full resolution: one frame-sized float mask per person, as the warp in
+  // the upstream subgraph produces them.
+  std::vector<cv::Mat> full_masks(people);
+  MP_RETURN_IF_ERROR(Measure("Full resolution", [&](int frame) {
+    const auto rois = MakeRois(people, frame);
+    for (int person = 0; person < people; ++person) {
+      CompactMask placement;
+      placement.width = placement.height = mask_size;
+      mediapipe::prebuilt::SetMaskPlacement(rois[person],
+                                            letterbox_padding(rois[person]),
+                                            width, height, &placement);
+      // OpenCV puts pixel centers at whole coordinates.
+      const auto& m = placement.mask_to_image;
+      const cv::Mat transform =
+          (cv::Mat_<float>(2, 3) << m[0], m[1],
+           m[2] + (m[0] + m[1] - 1) * 0.5f, m[3], m[4],
+           m[5] + (m[3] + m[4] - 1) * 0.5f);
+      cv::warpAffine(model_mask, full_masks[person], transform,
+                     cv::Size(width, height), cv::INTER_LINEAR,
+                     cv::BORDER_CONSTANT, cv::Scalar(0));
+    }
+  }));
+
+  std::vector<CompactMask> previous;
+  std::vector<CompactMask> masks(people);
+  auto compact_step = [&](int frame) {
+    const auto rois = MakeRois(people, frame);
+    for (int person = 0; person < people; ++person) {
+      CompactMask& mask = masks[person];
+      mask.width = mask.height = mask_size;
+      mask.values.resize(mask_size * mask_size);
+      mediapipe::prebuilt::QuantizeMask(
+          model_mask.ptr<float>(), model_mask.step1(), mask_size, mask_size,
+          mask.values.data());
+      mediapipe::prebuilt::SetMaskPlacement(rois[person],
+                                            letterbox_padding(rois[person]),
+                                            width, height, &mask);
+      // People keep their order, which stands in for the matching.
+      if (!previous.empty()) {
+        mediapipe::prebuilt::BlendWithPrevious(previous[person], 0.7f, &mask);
+      }
+    }
+    previous = masks;
+  };
+  MP_RETURN_IF_ERROR(Measure("Compact", compact_step));
+
+  // What a consumer pays on top, on the frames it asks on.
+  std::vector<uint8_t> frame_mask(width * height);
+  MP_RETURN_IF_ERROR(Measure("Upsampled frame", [&](int) {
+    std::fill(frame_mask.begin(), frame_mask.end(), 0);
+    for (const auto& mask : masks) {
+      mediapipe::prebuilt::UpsampleMask(mask, 0, 0, width, height,
+                                        frame_mask.data(), width);
+    }
+  }));
+
+  const int region_width = std::max<int>(1, width * region_fraction);
+  const int region_height = std::max<int>(1, height * region_fraction);
+  std::vector<uint8_t> region_mask(region_width * region_height);
+  MP_RETURN_IF_ERROR(Measure("Upsampled region", [&](int) {
+    std::fill(region_mask.begin(), region_mask.end(), 0);
+    for (const auto& mask : masks) {
+      mediapipe::prebuilt::UpsampleMask(
+          mask, (width - region_width) / 2, (height - region_height) / 2,
+          region_width, region_height, region_mask.data(), region_width);
+    }
+  }));
+
+  // The two paths should agree on where the people are.
+  int64 full_pixels = 0;
+  int64 compact_pixels = 0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      float full = 0;
+      for (const auto& mask : full_masks) {
+        full = std::max(full, mask.at<float>(y, x));
+      }
+      full_pixels += full > 0.5f;
+      compact_pixels += frame_mask[y * width + x] > 127;
+    }
+  }
+  LOG(INFO) << "Pixels above 0.5: " << full_pixels << " at full resolution, "
+            << compact_pixels << " upsampled.";
+  LOG(INFO) << "Memory per person: " << width * height * sizeof(float)
+            << " bytes at full resolution, " << mask_size * mask_size
+            << " bytes compact.";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+// "desktop/prebuilt/prebuilt_latency_benchmark_main_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Measures per-frame latency percentiles of a graph while optional busy
+// threads compete for the CPUs, as on a shared multi-tenant host. Compare
+// the default executor against pinned executors:
+//
+//   cartoon_gan_latency_benchmark_cpu \
+//     --calculator_graph_config_file=<graph>.pbtxt \
+//     --background_threads=8
+//
+//   cartoon_gan_latency_benchmark_cpu \
+//     --calculator_graph_config_file=<graph>.pbtxt \
+//     --background_threads=8 --background_cpus=0-3 \
+//     --executors='inference=2@4-5' \
+//     --node_executors='TfLiteInferenceCalculator=inference'
+//
+// Graphs that gate their rendering on a "render" side packet can be measured
+// landmarks-only with --input_side_packets=render=false.
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_warmup.h"
+#include "mediapipe/examples/desktop/prebuilt/latency_stats.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+
+constexpr char kInputStream[] = "input_video";
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing a CalculatorGraphConfig proto, either in "
+          "text format or as a .binarypb from mediapipe_binary_graph.");
+ABSL_FLAG(std::string, output_stream, "output_video",
+          "Stream whose packets mark the end of each frame.");
+ABSL_FLAG(std::string, executors, "",
+          "Extra executors as 'name=num_threads[@cpu_list];...'.");
+ABSL_FLAG(std::string, node_executors, "",
+          "Node to executor assignments as 'node=executor,...'.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Input side packets as 'name=value,...', e.g. 'render=false'.");
+ABSL_FLAG(int, frames, 300, "Number of measured frames.");
+ABSL_FLAG(int, warmup_frames, 10, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 640, "Width of the synthetic input frames.");
+ABSL_FLAG(int, frame_height, 480, "Height of the synthetic input frames.");
+ABSL_FLAG(double, frame_rate, 30.0,
+          "Rate at which frames are sent. 0 sends them back to back.");
+ABSL_FLAG(int, background_threads, 0,
+          "Number of busy threads competing with the graph for CPU time.");
+ABSL_FLAG(std::string, background_cpus, "",
+          "CPU list the busy threads are pinned to, e.g. '0-3'. Empty leaves "
+          "them unpinned.");
+
+namespace {
+
+using ::mediapipe::prebuilt::FormatLatencyStats;
+using ::mediapipe::prebuilt::SummarizeLatencies;
+
+// Spins until `stop` is set. The busy loop stands in for other tenants.
+void BusyLoop(const std::vector<int>& cpus, const std::atomic<bool>* stop) {
+#if defined(__linux__)
+  if (!cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const int cpu : cpus) CPU_SET(cpu, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+  }
+#endif  // __linux__
+  volatile double sink = 0;
+  while (!stop->load(std::memory_order_relaxed)) {
+    for (int i = 0; i < 10000; ++i) sink = sink + i * 0.5;
+  }
+}
+
+std::unique_ptr<mediapipe::ImageFrame> MakeFrame() {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+      absl::GetFlag(FLAGS_frame_height),
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  frame->SetToZero();
+  return frame;
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig config,
+                   mediapipe::prebuilt::LoadGraphConfig(
+                       absl::GetFlag(FLAGS_calculator_graph_config_file)));
+  MP_RETURN_IF_ERROR(mediapipe::prebuilt::ConfigureExecutors(
+      absl::GetFlag(FLAGS_executors), absl::GetFlag(FLAGS_node_executors),
+      &config));
+
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller(
+                       absl::GetFlag(FLAGS_output_stream)));
+  ASSIGN_OR_RETURN(auto side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_input_side_packets)));
+  MP_RETURN_IF_ERROR(graph.StartRun(side_packets));
+
+  mediapipe::prebuilt::WarmUpOptions warmup;
+  warmup.input_stream = kInputStream;
+  warmup.num_frames = absl::GetFlag(FLAGS_warmup_frames);
+  warmup.frame_width = absl::GetFlag(FLAGS_frame_width);
+  warmup.frame_height = absl::GetFlag(FLAGS_frame_height);
+  mediapipe::Timestamp timestamp(0);
+  MP_RETURN_IF_ERROR(
+      mediapipe::prebuilt::WarmUpGraph(warmup, &graph, &poller, &timestamp));
+
+  ASSIGN_OR_RETURN(
+      std::vector<int> background_cpus,
+      mediapipe::prebuilt::ParseCpuList(absl::GetFlag(FLAGS_background_cpus)));
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> background;
+  for (int i = 0; i < absl::GetFlag(FLAGS_background_threads); ++i) {
+    background.emplace_back(BusyLoop, background_cpus, &stop);
+  }
+
+  const double frame_rate = absl::GetFlag(FLAGS_frame_rate);
+  const absl::Duration frame_interval =
+      frame_rate > 0 ? absl::Seconds(1.0 / frame_rate) : absl::ZeroDuration();
+  const int64 timestamp_step =
+      frame_rate > 0 ? static_cast<int64>(1e6 / frame_rate) : 1;
+
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(absl::GetFlag(FLAGS_frames));
+  absl::Time next_send = absl::Now();
+  absl::Status status;
+  for (int i = 0; i < absl::GetFlag(FLAGS_frames); ++i) {
+    absl::SleepFor(next_send - absl::Now());
+    next_send += frame_interval;
+
+    const absl::Time sent = absl::Now();
+    status = graph.AddPacketToInputStream(
+        kInputStream, mediapipe::Adopt(MakeFrame().release()).At(timestamp));
+    if (!status.ok()) break;
+    timestamp = timestamp + timestamp_step;
+
+    mediapipe::Packet packet;
+    if (!poller.Next(&packet)) {
+      status = absl::InternalError("Graph stopped producing output.");
+      break;
+    }
+    latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - sent));
+  }
+
+  stop = true;
+  for (auto& thread : background) thread.join();
+  MP_RETURN_IF_ERROR(status);
+
+  RET_CHECK(!latencies_ms.empty()) << "No frames were measured.";
+  LOG(INFO) << "Latency over " << latencies_ms.size() << " frames with "
+            << background.size() << " background threads: "
+            << FormatLatencyStats(SummarizeLatencies(latencies_ms), "ms");
+
+  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
+  return graph.WaitUntilDone();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
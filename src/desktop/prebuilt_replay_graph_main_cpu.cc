@@ -0,0 +1,378 @@
+// "desktop/prebuilt/prebuilt_replay_graph_main_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Feeds a recorded frame sequence through a graph with deterministic
+// timestamps and compares landmark/detection outputs against golden files.
+//
+// Record golden files once:
+//   cartoon_gan_replay_cpu \
+//     --calculator_graph_config_file=<graph>.pbtxt \
+//     --input_video_path=frames/%06d.png \
+//     --output_streams=pose_landmarks,pose_detections \
+//     --golden_dir=golden --update_golden
+//
+// Then rerun without --update_golden to diff against them. Per-node timing is
+// always logged, and written as CSV when --timing_output_file is set.
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/status.h"
+
+constexpr char kInputStream[] = "input_video";
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing text format CalculatorGraphConfig proto.");
+ABSL_FLAG(std::string, input_video_path, "",
+          "Recorded video file, or an image sequence pattern such as "
+          "'frames/%06d.png'.");
+ABSL_FLAG(double, frame_rate, 30.0,
+          "Frame rate used to derive deterministic input timestamps.");
+ABSL_FLAG(int, max_frames, 0, "Stop after this many frames. 0 for all.");
+ABSL_FLAG(bool, flip_horizontally, false,
+          "Mirror input frames, as the live runner does for webcams.");
+ABSL_FLAG(bool, keep_flow_limiter, false,
+          "Keep FlowLimiterCalculator nodes. They are replaced with "
+          "pass-through nodes by default so that no frame is dropped.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Input side packets as 'name=value,...', e.g. 'render=false'.");
+ABSL_FLAG(std::string, output_streams, "",
+          "Comma separated landmark/detection/rect streams to record.");
+ABSL_FLAG(std::string, golden_dir, "",
+          "Directory holding one <stream>.txt golden file per output stream.");
+ABSL_FLAG(bool, update_golden, false,
+          "Write golden files instead of comparing against them.");
+ABSL_FLAG(double, tolerance, 1e-3,
+          "Max absolute difference allowed between output and golden values.");
+ABSL_FLAG(std::string, timing_output_file, "",
+          "Optional CSV file receiving per-node timing.");
+
+namespace {
+
+// Frame index -> flattened values of one packet.
+using StreamRecord = std::map<int64, std::vector<float>>;
+
+void AppendLandmarks(const mediapipe::NormalizedLandmarkList& list,
+                     std::vector<float>* values) {
+  for (const auto& landmark : list.landmark()) {
+    values->insert(values->end(), {landmark.x(), landmark.y(), landmark.z()});
+  }
+}
+
+void AppendLandmarks(const mediapipe::LandmarkList& list,
+                     std::vector<float>* values) {
+  for (const auto& landmark : list.landmark()) {
+    values->insert(values->end(), {landmark.x(), landmark.y(), landmark.z()});
+  }
+}
+
+void AppendDetection(const mediapipe::Detection& detection,
+                     std::vector<float>* values) {
+  values->insert(values->end(), detection.score().begin(),
+                 detection.score().end());
+  const auto& location = detection.location_data();
+  const auto& box = location.relative_bounding_box();
+  values->insert(values->end(),
+                 {box.xmin(), box.ymin(), box.width(), box.height()});
+  for (const auto& keypoint : location.relative_keypoints()) {
+    values->insert(values->end(), {keypoint.x(), keypoint.y()});
+  }
+}
+
+void AppendRect(const mediapipe::NormalizedRect& rect,
+                std::vector<float>* values) {
+  values->insert(values->end(), {rect.x_center(), rect.y_center(),
+                                 rect.width(), rect.height(), rect.rotation()});
+}
+
+template <typename T, typename F>
+bool AppendIfType(const mediapipe::Packet& packet, F append,
+                  std::vector<float>* values) {
+  if (!packet.ValidateAsType<T>().ok()) return false;
+  append(packet.Get<T>(), values);
+  return true;
+}
+
+template <typename T, typename F>
+bool AppendVectorIfType(const mediapipe::Packet& packet, F append,
+                        std::vector<float>* values) {
+  if (!packet.ValidateAsType<std::vector<T>>().ok()) return false;
+  for (const auto& item : packet.Get<std::vector<T>>()) append(item, values);
+  return true;
+}
+
+// Flattens the landmark, detection and rect packet types produced by the
+// graphs in this repository into a list of floats.
+absl::StatusOr<std::vector<float>> FlattenPacket(
+    const mediapipe::Packet& packet) {
+  using mediapipe::Detection;
+  using mediapipe::LandmarkList;
+  using mediapipe::NormalizedLandmarkList;
+  using mediapipe::NormalizedRect;
+  auto normalized = [](const NormalizedLandmarkList& list,
+                       std::vector<float>* values) {
+    AppendLandmarks(list, values);
+  };
+  auto world = [](const LandmarkList& list, std::vector<float>* values) {
+    AppendLandmarks(list, values);
+  };
+
+  std::vector<float> values;
+  if (AppendIfType<NormalizedLandmarkList>(packet, normalized, &values) ||
+      AppendIfType<LandmarkList>(packet, world, &values) ||
+      AppendIfType<Detection>(packet, AppendDetection, &values) ||
+      AppendIfType<NormalizedRect>(packet, AppendRect, &values) ||
+      AppendVectorIfType<NormalizedLandmarkList>(packet, normalized,
+                                                 &values) ||
+      AppendVectorIfType<LandmarkList>(packet, world, &values) ||
+      AppendVectorIfType<Detection>(packet, AppendDetection, &values) ||
+      AppendVectorIfType<NormalizedRect>(packet, AppendRect, &values)) {
+    return values;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unsupported packet type: ", packet.DebugTypeName()));
+}
+
+std::string GoldenPath(const std::string& stream) {
+  return absl::StrCat(absl::GetFlag(FLAGS_golden_dir), "/", stream, ".txt");
+}
+
+// One line per frame: "<frame_index> <value_count> <values...>".
+std::string SerializeRecord(const StreamRecord& record) {
+  std::string contents;
+  for (const auto& [frame_index, values] : record) {
+    absl::StrAppend(&contents, frame_index, " ", values.size());
+    for (float value : values) absl::StrAppend(&contents, " ", value);
+    absl::StrAppend(&contents, "\n");
+  }
+  return contents;
+}
+
+absl::StatusOr<StreamRecord> ParseRecord(const std::string& contents) {
+  StreamRecord record;
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.empty()) continue;
+    int64 frame_index;
+    size_t count;
+    RET_CHECK(fields.size() >= 2 &&
+              absl::SimpleAtoi(fields[0], &frame_index) &&
+              absl::SimpleAtoi(fields[1], &count) &&
+              fields.size() == count + 2)
+        << "Malformed golden line: " << line;
+    auto& values = record[frame_index];
+    values.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      RET_CHECK(absl::SimpleAtof(fields[i + 2], &values[i]));
+    }
+  }
+  return record;
+}
+
+// Returns the number of frames whose values differ from the golden ones.
+int CompareRecord(const std::string& stream, const StreamRecord& golden,
+                  const StreamRecord& actual, double tolerance) {
+  int mismatches = 0;
+  double max_diff = 0;
+  for (const auto& [frame_index, expected] : golden) {
+    auto it = actual.find(frame_index);
+    if (it == actual.end() || it->second.size() != expected.size()) {
+      LOG(ERROR) << stream << " frame " << frame_index
+                 << ": expected " << expected.size() << " values, got "
+                 << (it == actual.end() ? 0 : it->second.size());
+      ++mismatches;
+      continue;
+    }
+    double frame_diff = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      frame_diff = std::max<double>(frame_diff,
+                                    std::fabs(expected[i] - it->second[i]));
+    }
+    max_diff = std::max(max_diff, frame_diff);
+    if (frame_diff > tolerance) {
+      LOG(ERROR) << stream << " frame " << frame_index
+                 << ": max abs diff " << frame_diff;
+      ++mismatches;
+    }
+  }
+  for (const auto& [frame_index, values] : actual) {
+    if (golden.find(frame_index) == golden.end()) {
+      LOG(ERROR) << stream << " frame " << frame_index
+                 << ": unexpected output with " << values.size()
+                 << " values";
+      ++mismatches;
+    }
+  }
+  LOG(INFO) << stream << ": " << golden.size() << " golden frames, "
+            << mismatches << " mismatches, max abs diff " << max_diff;
+  return mismatches;
+}
+
+int64 TotalCount(const mediapipe::TimeHistogram& histogram) {
+  int64 count = 0;
+  for (int64 bucket : histogram.count()) count += bucket;
+  return count;
+}
+
+absl::Status ReportNodeTiming(const mediapipe::CalculatorGraph& graph) {
+  std::vector<mediapipe::CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(graph.profiler()->GetCalculatorProfiles(&profiles));
+
+  std::string csv = "node,process_calls,process_total_us,process_mean_us\n";
+  for (const auto& profile : profiles) {
+    const int64 calls = TotalCount(profile.process_runtime());
+    const int64 total_us = profile.process_runtime().total();
+    const double mean_us =
+        calls > 0 ? static_cast<double>(total_us) / calls : 0.0;
+    LOG(INFO) << "Node " << profile.name() << ": " << calls << " calls, "
+              << total_us / 1000.0 << " ms total, " << mean_us
+              << " us mean";
+    absl::StrAppend(&csv, profile.name(), ",", calls, ",", total_us, ",",
+                    mean_us, "\n");
+  }
+
+  const std::string& timing_file = absl::GetFlag(FLAGS_timing_output_file);
+  if (!timing_file.empty()) {
+    MP_RETURN_IF_ERROR(mediapipe::file::SetContents(timing_file, csv));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig config,
+                   mediapipe::prebuilt::LoadGraphConfig(
+                       absl::GetFlag(FLAGS_calculator_graph_config_file)));
+  if (!absl::GetFlag(FLAGS_keep_flow_limiter)) {
+    LOG(INFO) << "Disabled "
+              << mediapipe::prebuilt::DisableFlowLimiters(&config)
+              << " flow limiter(s).";
+  }
+  config.mutable_profiler_config()->set_enable_profiler(true);
+
+  LOG(INFO) << "Initialize the calculator graph.";
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+
+  const std::vector<std::string> output_streams = absl::StrSplit(
+      absl::GetFlag(FLAGS_output_streams), ',', absl::SkipEmpty());
+  const double frame_rate = absl::GetFlag(FLAGS_frame_rate);
+  RET_CHECK_GT(frame_rate, 0);
+
+  // Timestamps are derived from the frame index, so they map back exactly.
+  std::map<std::string, StreamRecord> records;
+  for (const auto& stream : output_streams) {
+    StreamRecord* record = &records[stream];
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        stream,
+        [record, frame_rate](const mediapipe::Packet& packet) -> absl::Status {
+          ASSIGN_OR_RETURN(auto values, FlattenPacket(packet));
+          const int64 frame_index = std::llround(
+              packet.Timestamp().Seconds() * frame_rate);
+          (*record)[frame_index] = std::move(values);
+          return absl::OkStatus();
+        }));
+  }
+
+  LOG(INFO) << "Load the recorded frames.";
+  cv::VideoCapture capture;
+  capture.open(absl::GetFlag(FLAGS_input_video_path));
+  RET_CHECK(capture.isOpened());
+
+  ASSIGN_OR_RETURN(auto side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_input_side_packets)));
+  LOG(INFO) << "Start running the calculator graph.";
+  MP_RETURN_IF_ERROR(graph.StartRun(side_packets));
+
+  const int max_frames = absl::GetFlag(FLAGS_max_frames);
+  int64 frame_index = 0;
+  while (max_frames <= 0 || frame_index < max_frames) {
+    cv::Mat camera_frame_raw;
+    capture >> camera_frame_raw;
+    if (camera_frame_raw.empty()) break;  // End of recording.
+
+    cv::Mat camera_frame;
+    cv::cvtColor(camera_frame_raw, camera_frame, cv::COLOR_BGR2RGB);
+    if (absl::GetFlag(FLAGS_flip_horizontally)) {
+      cv::flip(camera_frame, camera_frame, /*flipcode=HORIZONTAL*/ 1);
+    }
+
+    auto input_frame = absl::make_unique<mediapipe::ImageFrame>(
+        mediapipe::ImageFormat::SRGB, camera_frame.cols, camera_frame.rows,
+        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
+    camera_frame.copyTo(input_frame_mat);
+
+    const int64 frame_timestamp_us =
+        std::llround(frame_index * 1e6 / frame_rate);
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputStream, mediapipe::Adopt(input_frame.release())
+                          .At(mediapipe::Timestamp(frame_timestamp_us))));
+
+    // Process one frame at a time so that loopback and smoothing calculators
+    // see exactly the same history on every run.
+    MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+    ++frame_index;
+  }
+  LOG(INFO) << "Replayed " << frame_index << " frames.";
+
+  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  MP_RETURN_IF_ERROR(ReportNodeTiming(graph));
+
+  if (absl::GetFlag(FLAGS_golden_dir).empty()) return absl::OkStatus();
+
+  int mismatches = 0;
+  for (const auto& [stream, record] : records) {
+    if (absl::GetFlag(FLAGS_update_golden)) {
+      MP_RETURN_IF_ERROR(mediapipe::file::SetContents(GoldenPath(stream),
+                                                      SerializeRecord(record)));
+      LOG(INFO) << "Wrote " << record.size() << " frames to "
+                << GoldenPath(stream);
+      continue;
+    }
+    std::string contents;
+    MP_RETURN_IF_ERROR(
+        mediapipe::file::GetContents(GoldenPath(stream), &contents));
+    ASSIGN_OR_RETURN(StreamRecord golden, ParseRecord(contents));
+    mismatches += CompareRecord(stream, golden, record,
+                                absl::GetFlag(FLAGS_tolerance));
+  }
+  RET_CHECK_EQ(mismatches, 0) << "Outputs differ from golden files in "
+                              << absl::GetFlag(FLAGS_golden_dir);
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
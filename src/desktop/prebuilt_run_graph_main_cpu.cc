@@ -1,107 +1,444 @@
 // "desktop/prebuilt/prebuilt_run_graph_main_cpu.cc"
 // https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
 
+#include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <cstdlib>
+#include <memory>
+#include <thread>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/frame_correlator.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_warmup.h"
+#include "mediapipe/examples/desktop/prebuilt/memory_accountant.h"
+#include "mediapipe/examples/desktop/prebuilt/shm_frame_ring.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
-#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/opencv_highgui_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
-#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
 
 constexpr char kInputStream[] = "input_video";
 constexpr char kOutputStream[] = "output_video";
 constexpr char kWindowName[] = "MediaPipe";
+constexpr absl::Duration kEmptyFrameBackoff = absl::Milliseconds(10);
+constexpr char kMemoryAccountantSidePacket[] = "memory_accountant";
+// How long a read from the frame ring waits before checking for Ctrl-C.
+constexpr absl::Duration kShmReadTimeout = absl::Milliseconds(100);
 
 ABSL_FLAG(std::string, calculator_graph_config_file, "",
-          "Name of file containing text format CalculatorGraphConfig proto.");
+          "Name of file containing a CalculatorGraphConfig proto, either in "
+          "text format or as a .binarypb from mediapipe_binary_graph.");
+ABSL_FLAG(std::string, expanded_graph_cache_file, "",
+          "Optional file caching the config with subgraphs expanded, as a "
+          "binary proto. Rebuilt when older than the config file or the "
+          "binary, which carries the subgraphs.");
+ABSL_FLAG(std::string, executors, "",
+          "Extra executors as 'name=num_threads[@cpu_list];...', e.g. "
+          "'inference=2@2-3;io=1@0'. 'default' replaces the default executor.");
+ABSL_FLAG(std::string, node_executors, "",
+          "Node to executor assignments as 'node=executor,...', matching "
+          "node names or calculator types, e.g. "
+          "'TfLiteInferenceCalculator=inference'.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Input side packets as 'name=value,...', e.g. 'render=false'.");
+ABSL_FLAG(std::string, input_video_path, "",
+          "Full path of video to load. If not provided, attempt to use a "
+          "webcam.");
+ABSL_FLAG(std::string, input_shm_name, "",
+          "Name of a shared-memory frame ring, e.g. '/mppb_frames', to read "
+          "frames from instead of a camera or video. The frames reach the "
+          "graph without a copy and are stamped with their capture times. "
+          "See shm_frame_producer.");
+ABSL_FLAG(std::string, output_video_path, "",
+          "Full path of a video file or named pipe to encode output_video to, "
+          "on an encoder thread, instead of showing it in a window.");
+ABSL_FLAG(std::string, output_video_codec, "avc1",
+          "FourCC of the output video file codec, e.g. 'avc1' or 'MJPG'. "
+          "Named pipes get back to back JPEG images.");
+ABSL_FLAG(int, output_video_queue_size, 4,
+          "Frames that may wait for the encoder before the graph input is "
+          "throttled.");
+ABSL_FLAG(int, input_queue_size, 4,
+          "Frames that may queue at the graph input before sending waits.");
+ABSL_FLAG(int, max_queue_size, 0,
+          "Graph-wide limit on the packets queued at any calculator input. "
+          "A node whose input is full holds back its producers, and a graph "
+          "that can no longer make progress fails instead of hanging. 0 "
+          "keeps the graph's own setting.");
+ABSL_FLAG(double, memory_report_interval, 0,
+          "Seconds between reports of current and peak RSS and of the image "
+          "and tensor bytes alive per stream. 0 disables the reports and the "
+          "accounting.");
+ABSL_FLAG(double, admission_deadline_ms, 0,
+          "Replace FlowLimiterCalculators with DeadlineAdmissionCalculators "
+          "that drop frames expected to finish more than this many "
+          "milliseconds after they arrive. 0 keeps the "
+          "FlowLimiterCalculators.");
+ABSL_FLAG(int, max_empty_frames, 100,
+          "Consecutive empty camera frames after which the run fails.");
+ABSL_FLAG(int, warmup_frames, 0,
+          "Number of black frames pushed through the graph before the first "
+          "camera frame, so that model setup does not land on real input.");
+ABSL_FLAG(int, frame_width, 640, "Requested camera and warm-up frame width.");
+ABSL_FLAG(int, frame_height, 480,
+          "Requested camera and warm-up frame height.");
+
+namespace {
+
+// Set on Ctrl-C, so that an encoded video is finalized before exiting.
+volatile std::sig_atomic_t stop_grabbing = 0;
+
+void StopGrabbing(int) { stop_grabbing = 1; }
+
+double ToMiB(int64 bytes) { return bytes / (1024.0 * 1024.0); }
+
+// Logs RSS and the bytes alive per accounted stream, busiest streams first.
+void LogMemoryUsage(mediapipe::prebuilt::MemoryAccountant* accountant) {
+  LOG(INFO) << "RSS " << ToMiB(mediapipe::prebuilt::CurrentRssBytes())
+            << " MiB, peak " << ToMiB(mediapipe::prebuilt::PeakRssBytes())
+            << " MiB.";
+  auto usage = accountant->GetUsage();
+  std::sort(usage.begin(), usage.end(), [](const auto& a, const auto& b) {
+    return a.live_bytes > b.live_bytes;
+  });
+  for (const auto& stream : usage) {
+    LOG(INFO) << "  " << stream.stream << ": " << ToMiB(stream.live_bytes)
+              << " MiB in " << stream.live_packets << " packets, peak "
+              << ToMiB(stream.peak_bytes) << " MiB.";
+  }
+}
+
+double ElapsedMs(absl::Time* since) {
+  const absl::Time now = absl::Now();
+  const double ms = absl::ToDoubleMilliseconds(now - *since);
+  *since = now;
+  return ms;
+}
+
+}  // namespace
 
 absl::Status RunMPPGraph() {
-  std::string calculator_graph_config_contents;
-  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      absl::GetFlag(FLAGS_calculator_graph_config_file),
-      &calculator_graph_config_contents));
-  LOG(INFO) << "Get calculator graph config contents: "
-            << calculator_graph_config_contents;
-  mediapipe::CalculatorGraphConfig config =
-      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
-          calculator_graph_config_contents);
+  absl::Time startup_mark = absl::Now();
+  const std::string& config_file =
+      absl::GetFlag(FLAGS_calculator_graph_config_file);
+  const std::string& cache_file =
+      absl::GetFlag(FLAGS_expanded_graph_cache_file);
+  mediapipe::CalculatorGraphConfig config;
+  if (cache_file.empty()) {
+    ASSIGN_OR_RETURN(config, mediapipe::prebuilt::LoadGraphConfig(config_file));
+  } else {
+    ASSIGN_OR_RETURN(config, mediapipe::prebuilt::LoadExpandedGraphConfig(
+                                 config_file, cache_file));
+  }
+  MP_RETURN_IF_ERROR(mediapipe::prebuilt::ConfigureExecutors(
+      absl::GetFlag(FLAGS_executors), absl::GetFlag(FLAGS_node_executors),
+      &config));
+  const bool save_video = !absl::GetFlag(FLAGS_output_video_path).empty();
+  VLOG(1) << "Calculator graph config: " << config.DebugString();
+  const double parse_ms = ElapsedMs(&startup_mark);
 
+  cv::VideoCapture capture;
+  std::shared_ptr<mediapipe::prebuilt::ShmFrameRing> ring;
+  const bool read_shm = !absl::GetFlag(FLAGS_input_shm_name).empty();
+  const bool load_video = !absl::GetFlag(FLAGS_input_video_path).empty();
+  if (read_shm) {
+    LOG(INFO) << "Attach to the frame ring.";
+    ASSIGN_OR_RETURN(ring, mediapipe::prebuilt::ShmFrameRing::Open(
+                               absl::GetFlag(FLAGS_input_shm_name)));
+  } else {
+    LOG(INFO) << "Initialize the camera or load the video.";
+    if (load_video) {
+      capture.open(absl::GetFlag(FLAGS_input_video_path));
+    } else {
+      capture.open(0);
+    }
+    RET_CHECK(capture.isOpened());
+  }
+
+  if (!save_video) {
+    cv::namedWindow(kWindowName, /*flags=WINDOW_AUTOSIZE*/ 1);
+  }
+#if (CV_MAJOR_VERSION >= 3) && (CV_MINOR_VERSION >= 2)
+  if (!load_video && !read_shm) {
+    capture.set(cv::CAP_PROP_FRAME_WIDTH, absl::GetFlag(FLAGS_frame_width));
+    capture.set(cv::CAP_PROP_FRAME_HEIGHT, absl::GetFlag(FLAGS_frame_height));
+    capture.set(cv::CAP_PROP_FPS, 30);
+  }
+#endif
+
+  if (absl::GetFlag(FLAGS_admission_deadline_ms) > 0) {
+    mediapipe::DeadlineAdmissionCalculatorOptions admission_options;
+    admission_options.set_deadline_ms(
+        absl::GetFlag(FLAGS_admission_deadline_ms));
+    LOG(INFO) << "Admitting frames with a "
+              << admission_options.deadline_ms() << " ms deadline at "
+              << mediapipe::prebuilt::UseDeadlineAdmission(admission_options,
+                                                           &config)
+              << " limiter(s).";
+  }
+
+  if (save_video) {
+    // The encoder sink replaces the window. A FlowLimiterCalculator drops
+    // the frames the graph and the encoder cannot keep up with.
+    mediapipe::AsyncVideoEncoderCalculatorOptions encoder_options;
+    encoder_options.set_output_file_path(
+        absl::GetFlag(FLAGS_output_video_path));
+    encoder_options.set_codec(absl::GetFlag(FLAGS_output_video_codec));
+    const double fps = capture.get(cv::CAP_PROP_FPS);
+    encoder_options.set_fps(fps > 0 ? fps : 30);
+    encoder_options.set_max_queued_frames(
+        absl::GetFlag(FLAGS_output_video_queue_size));
+    // Warm-up frames are stamped 0 to warmup_frames - 1 below.
+    encoder_options.set_start_timestamp(absl::GetFlag(FLAGS_warmup_frames));
+    const int throttled = mediapipe::prebuilt::AttachVideoEncoder(
+        kOutputStream, encoder_options, &config);
+    if (throttled == 0) {
+      // The encoder waiting for room then only holds up its own input
+      // stream, whose queue grows for as long as the graph outruns it.
+      RET_CHECK_GT(absl::GetFlag(FLAGS_max_queue_size), 0)
+          << "No FlowLimiterCalculator reads FINISHED:" << kOutputStream
+          << ", so nothing throttles the graph against the encoder. Pass "
+          << "--max_queue_size to bound the graph queues instead.";
+      LOG(WARNING) << "No limiter waits for the encoder; --max_queue_size "
+                   << "holds back the graph input instead.";
+    }
+    LOG(INFO) << "Encoding " << kOutputStream << " to "
+              << encoder_options.output_file_path() << "; " << throttled
+              << " limiter(s) wait for the encoder.";
+  }
+
+  if (absl::GetFlag(FLAGS_max_queue_size) > 0) {
+    config.set_max_queue_size(absl::GetFlag(FLAGS_max_queue_size));
+    config.set_report_deadlock(true);
+  }
+  const absl::Duration memory_report_interval =
+      absl::Seconds(absl::GetFlag(FLAGS_memory_report_interval));
+  auto accountant = std::make_shared<mediapipe::prebuilt::MemoryAccountant>();
+  if (memory_report_interval > absl::ZeroDuration()) {
+    const int tapped = mediapipe::prebuilt::AttachMemoryAccounting(
+        kMemoryAccountantSidePacket, &config);
+    LOG(INFO) << "Accounting image and tensor memory on " << tapped
+              << " streams.";
+  }
+
+  // Declared before the graph, whose output observer refers to them.
+  mediapipe::prebuilt::FrameCorrelator correlator;
+  absl::Mutex latest_output_mutex;
+  mediapipe::Packet latest_output;
+
+  ElapsedMs(&startup_mark);  // Camera setup is not part of graph startup.
   LOG(INFO) << "Initialize the calculator graph.";
   mediapipe::CalculatorGraph graph;
   MP_RETURN_IF_ERROR(graph.Initialize(config));
+  const double initialize_ms = ElapsedMs(&startup_mark);
 
-  LOG(INFO) << "Initialize the camera or load the video.";
-  cv::VideoCapture capture;
-  
-  capture.open(0);
-  RET_CHECK(capture.isOpened());
+  LOG(INFO) << "Start running the calculator graph.";
+  // Outputs are observed rather than polled one per input: a flow limiter
+  // may drop frames, and the correlator accounts for them by timestamp. The
+  // window shows whichever output arrived last.
+  MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+      kOutputStream, [&](const mediapipe::Packet& packet) {
+        correlator.AddOutput(packet.Timestamp());
+        absl::MutexLock lock(&latest_output_mutex);
+        latest_output = packet;
+        return absl::OkStatus();
+      }));
+  // Without a flow limiter, a full input queue holds up the capture loop
+  // instead of growing.
+  graph.SetInputStreamMaxQueueSize(kInputStream,
+                                   absl::GetFlag(FLAGS_input_queue_size));
+  ASSIGN_OR_RETURN(auto side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_input_side_packets)));
+  side_packets[kMemoryAccountantSidePacket] =
+      mediapipe::MakePacket<
+          std::shared_ptr<mediapipe::prebuilt::MemoryAccountant>>(accountant);
+  MP_RETURN_IF_ERROR(graph.StartRun(side_packets));
+  const double start_run_ms = ElapsedMs(&startup_mark);
 
-  cv::namedWindow(kWindowName, /*flags=WINDOW_AUTOSIZE*/ 1);
-#if (CV_MAJOR_VERSION >= 3) && (CV_MINOR_VERSION >= 2)
-  capture.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-  capture.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
-  capture.set(cv::CAP_PROP_FPS, 30);
-#endif  
+  // Warm-up frames are stamped from 0; real frames follow them.
+  mediapipe::prebuilt::WarmUpOptions warmup;
+  warmup.input_stream = kInputStream;
+  warmup.num_frames = absl::GetFlag(FLAGS_warmup_frames);
+  warmup.frame_width = absl::GetFlag(FLAGS_frame_width);
+  warmup.frame_height = absl::GetFlag(FLAGS_frame_height);
+  mediapipe::Timestamp first_timestamp(0);
+  MP_RETURN_IF_ERROR(mediapipe::prebuilt::WarmUpGraph(
+      warmup, &graph, /*poller=*/nullptr, &first_timestamp));
+  const double warmup_ms = ElapsedMs(&startup_mark);
 
-  LOG(INFO) << "Start running the calculator graph.";
-  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
-                   graph.AddOutputStreamPoller(kOutputStream));
-  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  // Reports from a thread of its own: the capture loop may be held up by a
+  // full input queue, which is when the reports matter most.
+  absl::Notification stop_reporting;
+  std::thread reporter;
+  if (memory_report_interval > absl::ZeroDuration()) {
+    reporter = std::thread([&] {
+      while (!stop_reporting.WaitForNotificationWithTimeout(
+          memory_report_interval)) {
+        LogMemoryUsage(accountant.get());
+      }
+    });
+  }
 
   LOG(INFO) << "Start grabbing and processing frames.";
+  std::signal(SIGINT, StopGrabbing);
+  const absl::Time grab_start = absl::Now();
+  const auto clock_start = std::chrono::steady_clock::now();
+  mediapipe::Timestamp last_timestamp = mediapipe::Timestamp::Unset();
+  mediapipe::Timestamp shown_timestamp = mediapipe::Timestamp::Unset();
+  int64 first_capture_us = -1;
+  int empty_frames = 0;
+  int consecutive_empty_frames = 0;
+  bool first_frame = true;
   bool grab_frames = true;
-  while (grab_frames) {
-    // Capture opencv camera or video frame.
-    cv::Mat camera_frame_raw;
-    capture >> camera_frame_raw;
-    if (camera_frame_raw.empty()) {
-      LOG(INFO) << "Ignore empty frames from camera.";
-      continue;
-    }
-    cv::Mat camera_frame;
-    cv::cvtColor(camera_frame_raw, camera_frame, cv::COLOR_BGR2RGB);
-    cv::flip(camera_frame, camera_frame, /*flipcode=HORIZONTAL*/ 1);
+  // Errors end the loop rather than return, so that the reporter is joined.
+  absl::Status status;
+  while (grab_frames && !stop_grabbing) {
+    std::unique_ptr<mediapipe::ImageFrame> input_frame;
+    int64 offset_us;
+    if (read_shm) {
+      // The frame points into its slot, which is freed once the graph is
+      // done with the frame.
+      int64 capture_us;
+      auto shm_frame = ring->Read(kShmReadTimeout, &capture_us);
+      if (!shm_frame.ok()) {
+        status = shm_frame.status();
+        break;
+      }
+      input_frame = std::move(shm_frame).value();
+      if (!input_frame) {
+        if (ring->closed()) {
+          LOG(INFO) << "The frame ring was closed.";
+          break;
+        }
+        continue;
+      }
+      if (first_capture_us < 0) first_capture_us = capture_us;
+      offset_us = capture_us - first_capture_us;
+    } else {
+      // Capture opencv camera or video frame.
+      cv::Mat camera_frame_raw;
+      capture >> camera_frame_raw;
+      if (camera_frame_raw.empty()) {
+        if (load_video) {
+          LOG(INFO) << "Empty frame, end of video reached.";
+          break;
+        }
+        ++empty_frames;
+        if (++consecutive_empty_frames >=
+            absl::GetFlag(FLAGS_max_empty_frames)) {
+          status =
+              absl::UnavailableError("The camera stopped delivering frames.");
+          break;
+        }
+        absl::SleepFor(kEmptyFrameBackoff);
+        continue;
+      }
+      consecutive_empty_frames = 0;
 
-    // Wrap Mat into an ImageFrame.
-    auto input_frame = absl::make_unique<mediapipe::ImageFrame>(
-        mediapipe::ImageFormat::SRGB, camera_frame.cols, camera_frame.rows,
-        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
-    cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
-    camera_frame.copyTo(input_frame_mat);
+      if (load_video) {
+        offset_us = capture.get(cv::CAP_PROP_POS_MSEC) * 1000;
+      } else {
+        offset_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - clock_start)
+                        .count();
+      }
+
+      cv::Mat camera_frame;
+      cv::cvtColor(camera_frame_raw, camera_frame, cv::COLOR_BGR2RGB);
+      if (!load_video) {
+        cv::flip(camera_frame, camera_frame, /*flipcode=HORIZONTAL*/ 1);
+      }
+
+      // Wrap Mat into an ImageFrame.
+      input_frame = absl::make_unique<mediapipe::ImageFrame>(
+          mediapipe::ImageFormat::SRGB, camera_frame.cols, camera_frame.rows,
+          mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+      cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
+      camera_frame.copyTo(input_frame_mat);
+    }
+    // Ring frames are stamped with their capture times, video frames with
+    // their position in the video, camera frames with a monotonic clock, all
+    // offset past the warm-up frames and kept strictly increasing.
+    mediapipe::Timestamp frame_timestamp = first_timestamp + offset_us;
+    if (last_timestamp != mediapipe::Timestamp::Unset() &&
+        frame_timestamp <= last_timestamp) {
+      frame_timestamp = last_timestamp + 1;
+    }
+    last_timestamp = frame_timestamp;
 
     // Send image packet into the graph.
-    size_t frame_timestamp_us =
-        (double)cv::getTickCount() / (double)cv::getTickFrequency() * 1e6;
-    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
-        kInputStream, mediapipe::Adopt(input_frame.release())
-                          .At(mediapipe::Timestamp(frame_timestamp_us))));
+    correlator.AddInput(frame_timestamp);
+    status = graph.AddPacketToInputStream(
+        kInputStream,
+        mediapipe::Adopt(input_frame.release()).At(frame_timestamp));
+    if (!status.ok()) break;
+
+    if (first_frame && correlator.outputs() > 0) {
+      first_frame = false;
+      LOG(INFO) << "Startup: parse " << parse_ms << " ms, Initialize "
+                << initialize_ms << " ms, StartRun " << start_run_ms
+                << " ms, warm-up " << warmup_ms << " ms ("
+                << warmup.num_frames << " frames), first frame "
+                << ElapsedMs(&startup_mark) << " ms.";
+    }
+    if (save_video) continue;
 
-    // Get the graph result packet, or stop if that fails.
+    // Show the latest output, if there is a new one.
     mediapipe::Packet packet;
-    if (!poller.Next(&packet))
-      break;
-    auto &output_frame = packet.Get<mediapipe::ImageFrame>();
-
-    // Convert back to opencv for display or saving.
-    cv::Mat output_frame_mat = mediapipe::formats::MatView(&output_frame);
-    cv::cvtColor(output_frame_mat, output_frame_mat, cv::COLOR_RGB2BGR);
-    cv::imshow(kWindowName, output_frame_mat);
+    {
+      absl::MutexLock lock(&latest_output_mutex);
+      packet = latest_output;
+    }
+    if (!packet.IsEmpty() && packet.Timestamp() != shown_timestamp) {
+      shown_timestamp = packet.Timestamp();
+      cv::Mat output_frame_mat =
+          mediapipe::formats::MatView(&packet.Get<mediapipe::ImageFrame>());
+      cv::Mat display_frame;
+      cv::cvtColor(output_frame_mat, display_frame, cv::COLOR_RGB2BGR);
+      cv::imshow(kWindowName, display_frame);
+    }
     // Press any key to exit.
     const int pressed_key = cv::waitKey(5);
     if (pressed_key >= 0 && pressed_key != 255)
       grab_frames = false;
   }
+  const double grab_seconds = absl::ToDoubleSeconds(absl::Now() - grab_start);
 
   LOG(INFO) << "Shutting down.";
-  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
-  return graph.WaitUntilDone();
+  absl::Status close_status = graph.CloseInputStream(kInputStream);
+  if (close_status.ok()) close_status = graph.WaitUntilDone();
+  if (reporter.joinable()) {
+    stop_reporting.Notify();
+    reporter.join();
+    LogMemoryUsage(accountant.get());
+  }
+  MP_RETURN_IF_ERROR(status);
+  MP_RETURN_IF_ERROR(close_status);
+
+  const auto stats = correlator.GetStats();
+  LOG(INFO) << "Sent " << stats.inputs << " frames at "
+            << stats.inputs / grab_seconds
+            << " fps; " << stats.outputs << " came out, " << stats.dropped
+            << " were dropped, " << stats.pending << " never settled, "
+            << empty_frames << " empty camera frames were skipped.";
+  if (stats.outputs > 0) {
+    LOG(INFO) << "End-to-end latency: first frame " << stats.first_ms
+              << " ms, mean " << stats.mean_ms << " ms, p50 " << stats.p50_ms
+              << " ms, p90 " << stats.p90_ms << " ms, p99 " << stats.p99_ms
+              << " ms, max " << stats.max_ms << " ms.";
+  }
+  return absl::OkStatus();
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,142 @@
+// "desktop/prebuilt/prebuilt_session_benchmark_main_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Drives a graph through GraphSession, the core behind the iOS wrappers, the
+// way a camera drives a wrapper: frames arrive at a fixed rate stamped with
+// their capture time, and frames arriving while max_frames_in_flight frames
+// are unfinished get dropped. Logs the delivered throughput and drop rate.
+//
+//   multi_pose_session_benchmark_cpu \
+//     --calculator_graph_config_file=<graph>.pbtxt --frame_rate=30
+//
+// --frame_rate=0 sends each frame as soon as a slot frees up, which measures
+// the sustained throughput instead.
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/graph_session.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing a CalculatorGraphConfig proto, either in "
+          "text format or as a .binarypb from mediapipe_binary_graph.");
+ABSL_FLAG(std::string, output_stream, "output_video",
+          "Stream whose packets mark the end of each frame.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Input side packets as 'name=value,...', e.g. 'render=false'.");
+ABSL_FLAG(int, max_frames_in_flight, 2,
+          "Frames arriving while this many are unfinished are dropped, as in "
+          "the iOS wrappers.");
+ABSL_FLAG(int, frames, 300, "Number of measured frames offered.");
+ABSL_FLAG(int, warmup_frames, 10, "Number of unmeasured frames sent first.");
+ABSL_FLAG(int, frame_width, 640, "Width of the synthetic input frames.");
+ABSL_FLAG(int, frame_height, 480, "Height of the synthetic input frames.");
+ABSL_FLAG(double, frame_rate, 30.0,
+          "Rate at which frames arrive. 0 sends each frame as soon as the "
+          "session has room for it.");
+
+namespace {
+
+using ::mediapipe::prebuilt::GraphSession;
+
+mediapipe::Packet MakeFrame() {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+      absl::GetFlag(FLAGS_frame_height),
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  frame->SetToZero();
+  return mediapipe::Adopt(frame.release());
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig config,
+                   GraphSession::LoadConfig(
+                       absl::GetFlag(FLAGS_calculator_graph_config_file)));
+  GraphSession::Options options;
+  options.frame_output_stream = absl::GetFlag(FLAGS_output_stream);
+  options.max_frames_in_flight = absl::GetFlag(FLAGS_max_frames_in_flight);
+  RET_CHECK_GT(options.max_frames_in_flight, 0)
+      << "Finished frames are only counted with a frame budget.";
+  ASSIGN_OR_RETURN(std::unique_ptr<GraphSession> session,
+                   GraphSession::Create(std::move(config), options));
+
+  ASSIGN_OR_RETURN(auto side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_input_side_packets)));
+  for (const auto& side_packet : side_packets) {
+    MP_RETURN_IF_ERROR(
+        session->SetSidePacket(side_packet.first, side_packet.second));
+  }
+  MP_RETURN_IF_ERROR(session->Start());
+
+  // Frames are stamped with their send time, like camera frames with their
+  // capture time.
+  const absl::Time start = absl::Now();
+  auto send = [&]() {
+    return session->SendFrame(MakeFrame(),
+                              absl::ToDoubleSeconds(absl::Now() - start))
+        .status();
+  };
+
+  // Warm-up frames are sent as fast as the session takes them and are left
+  // out of the figures.
+  for (int i = 0; i < absl::GetFlag(FLAGS_warmup_frames); ++i) {
+    session->WaitForFrameSlot();
+    MP_RETURN_IF_ERROR(send());
+  }
+  const GraphSession::Stats warm = session->GetStats();
+
+  const double frame_rate = absl::GetFlag(FLAGS_frame_rate);
+  const absl::Duration frame_interval =
+      frame_rate > 0 ? absl::Seconds(1.0 / frame_rate) : absl::ZeroDuration();
+  const absl::Time measure_start = absl::Now();
+  absl::Time next_send = measure_start;
+  for (int i = 0; i < absl::GetFlag(FLAGS_frames); ++i) {
+    if (frame_rate > 0) {
+      absl::SleepFor(next_send - absl::Now());
+      next_send += frame_interval;
+    } else {
+      session->WaitForFrameSlot();
+    }
+    MP_RETURN_IF_ERROR(send());
+  }
+  // Closing the inputs settles the frames still in flight.
+  MP_RETURN_IF_ERROR(session->Stop());
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - measure_start);
+  const GraphSession::Stats done = session->GetStats();
+
+  const int64 sent = done.frames_sent - warm.frames_sent;
+  const int64 dropped = done.frames_dropped - warm.frames_dropped;
+  const int64 finished = done.frames_finished - warm.frames_finished;
+  RET_CHECK_GT(sent, 0) << "No frames were measured.";
+  LOG(INFO) << "Offered " << sent + dropped << " frames in " << seconds
+            << " s: " << sent << " sent, " << dropped << " dropped ("
+            << 100.0 * dropped / (sent + dropped) << "%), " << finished
+            << " finished, " << finished / seconds << " fps delivered.";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+// "desktop/prebuilt/prebuilt_startup_benchmark_main_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Measures cold vs. warm graph startup within one process. The graph is
+// created, fed one synthetic frame and torn down --runs times; the first run
+// pays for model loading, later runs show what the ModelRegistry saves when
+// the graph uses CachedTfLiteModelCalculator or
+// CachedTfLiteInferenceCalculator.
+
+#include <cstdlib>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/model_registry.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+
+constexpr char kInputStream[] = "input_video";
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing text format CalculatorGraphConfig proto.");
+ABSL_FLAG(std::string, output_stream, "output_video",
+          "Stream whose first packet marks the end of startup.");
+ABSL_FLAG(int, runs, 5, "Number of graph lifetimes to measure.");
+ABSL_FLAG(int, frame_width, 640, "Width of the synthetic input frame.");
+ABSL_FLAG(int, frame_height, 480, "Height of the synthetic input frame.");
+
+namespace {
+
+double ElapsedMs(absl::Time* since) {
+  const absl::Time now = absl::Now();
+  const double ms = absl::ToDoubleMilliseconds(now - *since);
+  *since = now;
+  return ms;
+}
+
+absl::Status RunOnce(int run) {
+  absl::Time mark = absl::Now();
+  const absl::Time start = mark;
+
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig config,
+                   mediapipe::prebuilt::LoadGraphConfig(
+                       absl::GetFlag(FLAGS_calculator_graph_config_file)));
+  const double parse_ms = ElapsedMs(&mark);
+
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller(
+                       absl::GetFlag(FLAGS_output_stream)));
+  const double initialize_ms = ElapsedMs(&mark);
+
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  const double start_run_ms = ElapsedMs(&mark);
+
+  auto input_frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+      absl::GetFlag(FLAGS_frame_height),
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  input_frame->SetToZero();
+  MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+      kInputStream,
+      mediapipe::Adopt(input_frame.release()).At(mediapipe::Timestamp(0))));
+  mediapipe::Packet packet;
+  RET_CHECK(poller.Next(&packet)) << "Graph produced no output.";
+  const double first_frame_ms = ElapsedMs(&mark);
+
+  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  const double shutdown_ms = ElapsedMs(&mark);
+
+  LOG(INFO) << "Run " << run << (run == 0 ? " (cold)" : " (warm)")
+            << ": parse " << parse_ms << " ms, Initialize " << initialize_ms
+            << " ms, StartRun " << start_run_ms << " ms, first frame "
+            << first_frame_ms << " ms, shutdown " << shutdown_ms
+            << " ms, total "
+            << absl::ToDoubleMilliseconds(absl::Now() - start) << " ms";
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  for (int run = 0; run < absl::GetFlag(FLAGS_runs); ++run) {
+    MP_RETURN_IF_ERROR(RunOnce(run));
+  }
+
+  const auto stats =
+      mediapipe::prebuilt::ModelRegistry::GetInstance().GetStats();
+  LOG(INFO) << "Model registry: " << stats.model_hits << " model hits, "
+            << stats.model_misses << " model misses, "
+            << stats.interpreter_hits << " interpreter hits, "
+            << stats.interpreter_misses << " interpreter misses.";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+// "desktop/prebuilt/prebuilt_swap_benchmark_main_cpu.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Feeds frames at a camera's pace into a SwappableGraphSession and swaps the
+// graph every --swap_interval frames, alternating between the first graph
+// and the swapped one. Logs, per swap, how long preparing the new graph
+// took off the frame path, and the output gap the switch left in frames and
+// milliseconds.
+//
+//   multi_pose_swap_benchmark_cpu \
+//     --calculator_graph_config_file=<graph>.pbtxt \
+//     --input_side_packets=render=true --swap_side_packets=render=false
+//
+// The prepare time is roughly what stopping and reloading the graph would
+// have stalled the stream for.
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/common/prebuilt/util/swappable_graph_session.h"
+#include "mediapipe/examples/desktop/prebuilt/graph_config_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing a CalculatorGraphConfig proto, either in "
+          "text format or as a .binarypb from mediapipe_binary_graph.");
+ABSL_FLAG(std::string, swap_graph_config_file, "",
+          "Graph swapped in on every other swap. Defaults to "
+          "--calculator_graph_config_file.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Input side packets as 'name=value,...', e.g. 'render=true'.");
+ABSL_FLAG(std::string, swap_side_packets, "",
+          "Side packets of the swapped graph, overriding "
+          "--input_side_packets, e.g. 'render=false'.");
+ABSL_FLAG(std::string, output_stream, "output_video",
+          "Stream whose packets mark the end of each frame.");
+ABSL_FLAG(int, max_frames_in_flight, 2,
+          "Frames arriving while this many are unfinished are dropped, as in "
+          "the iOS wrappers.");
+ABSL_FLAG(int, frames, 600, "Number of frames offered.");
+ABSL_FLAG(int, swap_interval, 150, "Frames between swaps.");
+ABSL_FLAG(int, warmup_frames, 2,
+          "Frames pushed through each new graph before it takes over.");
+ABSL_FLAG(int, frame_width, 640, "Width of the synthetic input frames.");
+ABSL_FLAG(int, frame_height, 480, "Height of the synthetic input frames.");
+ABSL_FLAG(double, frame_rate, 30.0, "Rate at which frames arrive.");
+
+namespace {
+
+using ::mediapipe::prebuilt::GraphSession;
+using ::mediapipe::prebuilt::SwappableGraphSession;
+
+mediapipe::Packet MakeFrame() {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+      absl::GetFlag(FLAGS_frame_height),
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  frame->SetToZero();
+  return mediapipe::Adopt(frame.release());
+}
+
+}  // namespace
+
+absl::Status RunMPPGraph() {
+  const std::string& config_file =
+      absl::GetFlag(FLAGS_calculator_graph_config_file);
+  const std::string& swap_file =
+      absl::GetFlag(FLAGS_swap_graph_config_file).empty()
+          ? config_file
+          : absl::GetFlag(FLAGS_swap_graph_config_file);
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig config,
+                   GraphSession::LoadConfig(config_file));
+  ASSIGN_OR_RETURN(mediapipe::CalculatorGraphConfig swap_config,
+                   GraphSession::LoadConfig(swap_file));
+  ASSIGN_OR_RETURN(auto side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_input_side_packets)));
+  ASSIGN_OR_RETURN(auto swap_side_packets,
+                   mediapipe::prebuilt::ParseSidePackets(
+                       absl::GetFlag(FLAGS_swap_side_packets)));
+  // Swapping back restores the first graph's values.
+  std::map<std::string, mediapipe::Packet> restore_side_packets;
+  for (const auto& side_packet : swap_side_packets) {
+    const auto original = side_packets.find(side_packet.first);
+    RET_CHECK(original != side_packets.end())
+        << side_packet.first << " needs a value in --input_side_packets.";
+    restore_side_packets.insert(*original);
+  }
+
+  SwappableGraphSession::Options options;
+  options.session.frame_output_stream = absl::GetFlag(FLAGS_output_stream);
+  options.session.max_frames_in_flight =
+      absl::GetFlag(FLAGS_max_frames_in_flight);
+  RET_CHECK_GT(options.session.max_frames_in_flight, 0)
+      << "Warm-up needs a frame budget.";
+  options.warmup_frame = MakeFrame();
+  options.warmup_frames = absl::GetFlag(FLAGS_warmup_frames);
+  ASSIGN_OR_RETURN(std::unique_ptr<SwappableGraphSession> session,
+                   SwappableGraphSession::Create(config, options));
+  for (const auto& side_packet : side_packets) {
+    MP_RETURN_IF_ERROR(
+        session->SetSidePacket(side_packet.first, side_packet.second));
+  }
+  MP_RETURN_IF_ERROR(session->Start());
+
+  std::vector<SwappableGraphSession::SwapStats> swaps;
+  auto collect_swap = [&]() {
+    const SwappableGraphSession::SwapStats stats = session->GetSwapStats();
+    if (stats.swaps > static_cast<int64>(swaps.size())) swaps.push_back(stats);
+  };
+
+  const absl::Duration frame_interval =
+      absl::Seconds(1.0 / absl::GetFlag(FLAGS_frame_rate));
+  const int swap_interval = absl::GetFlag(FLAGS_swap_interval);
+  RET_CHECK_GT(swap_interval, 0);
+  const absl::Time start = absl::Now();
+  absl::Time next_send = start;
+  bool swapped = false;
+  for (int i = 0; i < absl::GetFlag(FLAGS_frames); ++i) {
+    if (i > 0 && i % swap_interval == 0) {
+      // The previous swap had a whole interval to settle.
+      MP_RETURN_IF_ERROR(session->WaitForSwap());
+      collect_swap();
+      swapped = !swapped;
+      MP_RETURN_IF_ERROR(session->Swap(
+          swapped ? swap_config : config,
+          swapped ? swap_side_packets : restore_side_packets));
+    }
+    absl::SleepFor(next_send - absl::Now());
+    next_send += frame_interval;
+    MP_RETURN_IF_ERROR(
+        session->SendFrame(MakeFrame(),
+                           absl::ToDoubleSeconds(absl::Now() - start))
+            .status());
+  }
+  MP_RETURN_IF_ERROR(session->WaitForSwap());
+  collect_swap();
+  MP_RETURN_IF_ERROR(session->Stop());
+
+  const GraphSession::Stats stats = session->GetStats();
+  LOG(INFO) << "Offered " << stats.frames_sent + stats.frames_dropped
+            << " frames: " << stats.frames_sent << " sent, "
+            << stats.frames_dropped << " dropped, " << stats.frames_finished
+            << " finished.";
+  RET_CHECK(!swaps.empty()) << "No swap took effect; lower --swap_interval.";
+  double prepare_ms = 0, gap_ms = 0, max_gap_ms = 0;
+  int64 gap_frames = 0, max_gap_frames = 0;
+  for (const auto& swap : swaps) {
+    prepare_ms += swap.prepare_ms;
+    gap_ms += swap.gap_ms;
+    gap_frames += swap.gap_frames;
+    max_gap_ms = std::max(max_gap_ms, swap.gap_ms);
+    max_gap_frames = std::max<int64>(max_gap_frames, swap.gap_frames);
+  }
+  const int n = swaps.size();
+  LOG(INFO) << n << " swaps: prepared in " << prepare_ms / n
+            << " ms on average, off the frame path. Output gap mean "
+            << gap_ms / n << " ms, max " << max_gap_ms << " ms; frames "
+            << "without output mean " << static_cast<double>(gap_frames) / n
+            << ", max " << max_gap_frames << ".";
+  return absl::OkStatus();
+}
+
+int main(int argc, char **argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
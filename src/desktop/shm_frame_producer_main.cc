@@ -0,0 +1,164 @@
+// "desktop/prebuilt/shm_frame_producer_main.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+//
+// Writes camera, video or synthetic frames into a shared-memory frame ring,
+// for a runner started with --input_shm_name to read.
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <memory>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/prebuilt/shm_frame_ring.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(std::string, shm_name, "/mppb_frames",
+          "Name of the frame ring to create.");
+ABSL_FLAG(int, num_slots, 4,
+          "Frames the ring holds. The reader keeps a slot for as long as "
+          "its graph keeps the frame.");
+ABSL_FLAG(std::string, input_video_path, "",
+          "Full path of a video to write. 'camera' writes webcam frames; "
+          "empty writes a moving test pattern.");
+ABSL_FLAG(int, frame_width, 640, "Width of the test pattern and camera.");
+ABSL_FLAG(int, frame_height, 480, "Height of the test pattern and camera.");
+ABSL_FLAG(double, frame_rate, 30,
+          "Frames per second written. 0 writes as fast as slots free up.");
+ABSL_FLAG(int, num_frames, 0, "Frames to write before closing; 0 for all.");
+ABSL_FLAG(bool, drop_when_full, false,
+          "Drop frames while every slot is taken, as a live camera would, "
+          "instead of waiting for the reader.");
+
+namespace {
+
+// Set on Ctrl-C, so that the reader is told the ring is closed.
+volatile std::sig_atomic_t stop_writing = 0;
+
+void StopWriting(int) { stop_writing = 1; }
+
+// Diagonal bands that move a pixel per frame, in RGB.
+void DrawTestPattern(int frame_index, cv::Mat* frame) {
+  for (int y = 0; y < frame->rows; ++y) {
+    uint8* row = frame->ptr<uint8>(y);
+    for (int x = 0; x < frame->cols; ++x) {
+      const int band = (x + y + frame_index) & 0xff;
+      row[3 * x] = band;
+      row[3 * x + 1] = 255 - band;
+      row[3 * x + 2] = (x * 255) / frame->cols;
+    }
+  }
+}
+
+}  // namespace
+
+absl::Status RunProducer() {
+  cv::VideoCapture capture;
+  const std::string& video_path = absl::GetFlag(FLAGS_input_video_path);
+  int width = absl::GetFlag(FLAGS_frame_width);
+  int height = absl::GetFlag(FLAGS_frame_height);
+  if (!video_path.empty()) {
+    if (video_path == "camera") {
+      capture.open(0);
+      capture.set(cv::CAP_PROP_FRAME_WIDTH, width);
+      capture.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    } else {
+      capture.open(video_path);
+    }
+    RET_CHECK(capture.isOpened());
+    width = capture.get(cv::CAP_PROP_FRAME_WIDTH);
+    height = capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+  }
+  RET_CHECK(width > 0 && height > 0);
+
+  // Rows are packed; the reader takes any width step.
+  const int width_step = width * 3;
+  ASSIGN_OR_RETURN(auto ring, mediapipe::prebuilt::ShmFrameRing::Create(
+                                  absl::GetFlag(FLAGS_shm_name),
+                                  absl::GetFlag(FLAGS_num_slots),
+                                  static_cast<size_t>(width_step) * height));
+  LOG(INFO) << "Writing " << width << "x" << height << " frames to "
+            << absl::GetFlag(FLAGS_shm_name) << ".";
+
+  std::signal(SIGINT, StopWriting);
+  const double frame_rate = absl::GetFlag(FLAGS_frame_rate);
+  const absl::Duration frame_interval =
+      frame_rate > 0 ? absl::Seconds(1 / frame_rate) : absl::ZeroDuration();
+  const bool drop_when_full = absl::GetFlag(FLAGS_drop_when_full);
+  const int num_frames = absl::GetFlag(FLAGS_num_frames);
+  absl::Time next_frame = absl::Now();
+  int written = 0;
+  int dropped = 0;
+  cv::Mat camera_frame;
+  absl::Status status;
+  for (int frame_index = 0;
+       !stop_writing && (num_frames == 0 || frame_index < num_frames);
+       ++frame_index) {
+    absl::SleepFor(next_frame - absl::Now());
+    next_frame += frame_interval;
+    if (capture.isOpened()) {
+      capture >> camera_frame;
+      if (camera_frame.empty()) break;
+      if (camera_frame.cols != width || camera_frame.rows != height) {
+        status = absl::FailedPreconditionError("The frame size changed.");
+        break;
+      }
+    }
+    // Captured before waiting, so time spent waiting counts as latency.
+    const int64 capture_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+
+    int slot = -1;
+    while (slot < 0 && !stop_writing) {
+      slot = ring->AcquireSlot(drop_when_full ? absl::ZeroDuration()
+                                              : absl::Milliseconds(100));
+      if (drop_when_full) break;
+    }
+    if (slot < 0) {
+      ++dropped;
+      continue;
+    }
+
+    // Frames are written straight into the slot.
+    cv::Mat slot_mat(height, width, CV_8UC3, ring->SlotPixels(slot),
+                     width_step);
+    if (capture.isOpened()) {
+      cv::cvtColor(camera_frame, slot_mat, cv::COLOR_BGR2RGB);
+    } else {
+      DrawTestPattern(frame_index, &slot_mat);
+    }
+    mediapipe::prebuilt::ShmFrameRing::FrameInfo info;
+    info.timestamp_us = capture_us;
+    info.format = mediapipe::ImageFormat::SRGB;
+    info.width = width;
+    info.height = height;
+    info.width_step = width_step;
+    status = ring->PublishSlot(slot, info);
+    if (!status.ok()) break;
+    ++written;
+  }
+  ring->Close();
+  LOG(INFO) << "Wrote " << written << " frames, dropped " << dropped << ".";
+  return status;
+}
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunProducer();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to write frames: " << run_status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
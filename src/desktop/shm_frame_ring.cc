@@ -0,0 +1,323 @@
+// "desktop/prebuilt/shm_frame_ring.cc"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#include "mediapipe/examples/desktop/prebuilt/shm_frame_ring.h"
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+namespace {
+
+constexpr uint32 kMagic = 0x4d50524e;  // "MPRN"
+constexpr uint32 kVersion = 1;
+// Slot headers and pixels start on cache lines of their own.
+constexpr size_t kAlignment = 64;
+
+enum SlotState : uint32 {
+  kFree = 0,
+  kWriting = 1,
+  kReady = 2,
+  kReading = 3,
+};
+
+size_t AlignUp(size_t bytes) {
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+absl::Status ErrnoError(const std::string& what, const std::string& name) {
+  return absl::InternalError(
+      absl::StrCat(what, " ", name, ": ", std::strerror(errno)));
+}
+
+// Waits on `semaphore` until `timeout` passes. Returns false on timeout.
+bool TimedWait(sem_t* semaphore, absl::Duration timeout) {
+  const timespec deadline = absl::ToTimespec(absl::Now() + timeout);
+  while (sem_timedwait(semaphore, &deadline) != 0) {
+    if (errno != EINTR) return false;
+  }
+  return true;
+}
+
+// Checks that a frame of `format`, `width` x `height` with rows `width_step`
+// bytes apart is an interleaved ImageFrame that fits `slot_bytes`. The writer
+// checks what it publishes and the reader what it finds in a slot header,
+// which another process wrote.
+absl::Status CheckFrameLayout(int format, int width, int height,
+                              int width_step, size_t slot_bytes) {
+  switch (format) {
+    case ImageFormat::SRGB:
+    case ImageFormat::SRGBA:
+    case ImageFormat::SBGRA:
+    case ImageFormat::GRAY8:
+    case ImageFormat::GRAY16:
+    case ImageFormat::SRGB48:
+    case ImageFormat::SRGBA64:
+    case ImageFormat::VEC32F1:
+    case ImageFormat::VEC32F2:
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported frame format ", format, "."));
+  }
+  const auto image_format = static_cast<ImageFormat::Format>(format);
+  const int64 pixel_bytes =
+      ImageFrame::NumberOfChannelsForFormat(image_format) *
+      ImageFrame::ByteDepthForFormat(image_format);
+  RET_CHECK(width > 0 && height > 0 &&
+            static_cast<int64>(width_step) >= width * pixel_bytes)
+      << "Invalid frame size " << width << "x" << height << " with "
+      << width_step << " bytes per row.";
+  RET_CHECK_LE(static_cast<uint64>(width_step) * height, slot_bytes)
+      << "Frame does not fit a slot.";
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Both sides map these at different addresses, so they hold no pointers.
+struct ShmFrameRingHeader {
+  std::atomic<uint32> magic;
+  uint32 version;
+  int32 num_slots;
+  uint64 slot_bytes;
+  // Distance between slots, slot header included.
+  uint64 slot_stride;
+  sem_t free_slots;
+  sem_t ready_frames;
+  // Sequence numbers of the next frame to publish and to take.
+  std::atomic<uint64> next_write;
+  std::atomic<uint64> next_read;
+  std::atomic<uint32> closed;
+};
+
+struct ShmFrameRingSlot {
+  std::atomic<uint32> state;
+  uint64 sequence;
+  int64 timestamp_us;
+  int32 format;
+  int32 width;
+  int32 height;
+  int32 width_step;
+};
+
+static_assert(std::atomic<uint32>::is_always_lock_free &&
+                  std::atomic<uint64>::is_always_lock_free,
+              "Shared memory atomics must be lock free.");
+
+absl::StatusOr<std::shared_ptr<ShmFrameRing>> ShmFrameRing::Create(
+    const std::string& name, int num_slots, size_t slot_bytes) {
+  RET_CHECK_GT(num_slots, 0);
+  RET_CHECK_GT(slot_bytes, 0);
+  const size_t slot_stride =
+      AlignUp(sizeof(ShmFrameRingSlot)) + AlignUp(slot_bytes);
+  const size_t mapping_bytes =
+      AlignUp(sizeof(ShmFrameRingHeader)) + num_slots * slot_stride;
+
+  // A ring left behind by a writer that crashed is replaced.
+  shm_unlink(name.c_str());
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) return ErrnoError("shm_open", name);
+  if (ftruncate(fd, mapping_bytes) != 0) {
+    const absl::Status status = ErrnoError("ftruncate", name);
+    close(fd);
+    shm_unlink(name.c_str());
+    return status;
+  }
+  void* mapping = mmap(nullptr, mapping_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    const absl::Status status = ErrnoError("mmap", name);
+    shm_unlink(name.c_str());
+    return status;
+  }
+
+  // The new mapping is zeroed, so every slot starts out free.
+  auto* header = new (mapping) ShmFrameRingHeader;
+  header->version = kVersion;
+  header->num_slots = num_slots;
+  header->slot_bytes = slot_bytes;
+  header->slot_stride = slot_stride;
+  sem_init(&header->free_slots, /*pshared=*/1, num_slots);
+  sem_init(&header->ready_frames, /*pshared=*/1, 0);
+  header->next_write = 0;
+  header->next_read = 0;
+  header->closed = 0;
+  // Readers only trust a ring once the magic is in place.
+  header->magic.store(kMagic, std::memory_order_release);
+  return std::shared_ptr<ShmFrameRing>(
+      new ShmFrameRing(name, /*owner=*/true, mapping, mapping_bytes));
+}
+
+absl::StatusOr<std::shared_ptr<ShmFrameRing>> ShmFrameRing::Open(
+    const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) return ErrnoError("shm_open", name);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    const absl::Status status = ErrnoError("fstat", name);
+    close(fd);
+    return status;
+  }
+  const size_t mapping_bytes = file_stat.st_size;
+  RET_CHECK_GE(mapping_bytes, sizeof(ShmFrameRingHeader))
+      << name << " is not a frame ring.";
+  void* mapping = mmap(nullptr, mapping_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return ErrnoError("mmap", name);
+  auto ring = std::shared_ptr<ShmFrameRing>(
+      new ShmFrameRing(name, /*owner=*/false, mapping, mapping_bytes));
+
+  const ShmFrameRingHeader* header = ring->header_;
+  RET_CHECK_EQ(header->magic.load(std::memory_order_acquire), kMagic)
+      << name << " is not a frame ring, or is still being set up.";
+  RET_CHECK_EQ(header->version, kVersion) << name << " has another layout.";
+  RET_CHECK_EQ(AlignUp(sizeof(ShmFrameRingHeader)) +
+                   header->num_slots * header->slot_stride,
+               mapping_bytes)
+      << name << " has an unexpected size.";
+
+  // Slots a previous reader took never come back otherwise.
+  for (int slot = 0; slot < ring->num_slots(); ++slot) {
+    uint32 reading = kReading;
+    if (ring->Slot(slot)->state.compare_exchange_strong(reading, kFree)) {
+      sem_post(&ring->header_->free_slots);
+    }
+  }
+  return ring;
+}
+
+ShmFrameRing::ShmFrameRing(std::string name, bool owner, void* mapping,
+                           size_t mapping_bytes)
+    : name_(std::move(name)),
+      owner_(owner),
+      mapping_(mapping),
+      mapping_bytes_(mapping_bytes),
+      header_(static_cast<ShmFrameRingHeader*>(mapping)) {}
+
+ShmFrameRing::~ShmFrameRing() {
+  // The other side keeps its mapping; only the name goes away.
+  if (owner_) shm_unlink(name_.c_str());
+  munmap(mapping_, mapping_bytes_);
+}
+
+int ShmFrameRing::num_slots() const { return header_->num_slots; }
+
+size_t ShmFrameRing::slot_bytes() const { return header_->slot_bytes; }
+
+ShmFrameRingSlot* ShmFrameRing::Slot(int slot) const {
+  uint8* slots =
+      static_cast<uint8*>(mapping_) + AlignUp(sizeof(ShmFrameRingHeader));
+  return reinterpret_cast<ShmFrameRingSlot*>(slots +
+                                             slot * header_->slot_stride);
+}
+
+uint8* ShmFrameRing::SlotPixels(int slot) {
+  return reinterpret_cast<uint8*>(Slot(slot)) +
+         AlignUp(sizeof(ShmFrameRingSlot));
+}
+
+int ShmFrameRing::AcquireSlot(absl::Duration timeout) {
+  if (!TimedWait(&header_->free_slots, timeout)) return -1;
+  // The reader frees slots in any order, so any free one will do.
+  for (int slot = 0; slot < num_slots(); ++slot) {
+    uint32 free = kFree;
+    if (Slot(slot)->state.compare_exchange_strong(free, kWriting)) {
+      return slot;
+    }
+  }
+  // Only reachable when another writer shares the ring.
+  sem_post(&header_->free_slots);
+  return -1;
+}
+
+absl::Status ShmFrameRing::PublishSlot(int slot, const FrameInfo& info) {
+  RET_CHECK(slot >= 0 && slot < num_slots());
+  ShmFrameRingSlot* frame = Slot(slot);
+  RET_CHECK_EQ(frame->state.load(), kWriting) << "Slot was not acquired.";
+  MP_RETURN_IF_ERROR(CheckFrameLayout(info.format, info.width, info.height,
+                                       info.width_step, slot_bytes()));
+
+  frame->timestamp_us = info.timestamp_us;
+  frame->format = info.format;
+  frame->width = info.width;
+  frame->height = info.height;
+  frame->width_step = info.width_step;
+  const uint64 sequence = header_->next_write.load();
+  frame->sequence = sequence;
+  frame->state.store(kReady, std::memory_order_release);
+  header_->next_write.store(sequence + 1);
+  sem_post(&header_->ready_frames);
+  return absl::OkStatus();
+}
+
+void ShmFrameRing::Close() {
+  header_->closed.store(1);
+  // Wakes a waiting reader; it finds no frame and sees the ring closed.
+  sem_post(&header_->ready_frames);
+}
+
+bool ShmFrameRing::closed() const { return header_->closed.load() != 0; }
+
+absl::StatusOr<std::unique_ptr<ImageFrame>> ShmFrameRing::Read(
+    absl::Duration timeout, int64* timestamp_us) {
+  if (!TimedWait(&header_->ready_frames, timeout)) return nullptr;
+  const uint64 sequence = header_->next_read.load();
+  for (int slot = 0; slot < num_slots(); ++slot) {
+    ShmFrameRingSlot* frame = Slot(slot);
+    if (frame->state.load(std::memory_order_acquire) != kReady ||
+        frame->sequence != sequence) {
+      continue;
+    }
+    frame->state.store(kReading);
+    header_->next_read.store(sequence + 1);
+    // The header comes from another process; a bad one must not make the
+    // graph read past the slot.
+    const absl::Status layout =
+        CheckFrameLayout(frame->format, frame->width, frame->height,
+                         frame->width_step, slot_bytes());
+    if (!layout.ok()) {
+      ReleaseSlot(slot);
+      return layout;
+    }
+    *timestamp_us = frame->timestamp_us;
+    // The graph reads the pixels in place; deleting the frame frees the
+    // slot, and the deleter keeps the mapping alive until then.
+    return absl::make_unique<ImageFrame>(
+        static_cast<ImageFormat::Format>(frame->format), frame->width,
+        frame->height, frame->width_step, SlotPixels(slot),
+        [ring = shared_from_this(), slot](uint8*) {
+          ring->ReleaseSlot(slot);
+        });
+  }
+  RET_CHECK(closed()) << "Frame " << sequence << " is missing from "
+                      << name_ << ".";
+  // Keeps later reads from waiting on a closed ring.
+  sem_post(&header_->ready_frames);
+  return nullptr;
+}
+
+void ShmFrameRing::ReleaseSlot(int slot) {
+  Slot(slot)->state.store(kFree, std::memory_order_release);
+  sem_post(&header_->free_slots);
+}
+
+}  // namespace prebuilt
+}  // namespace mediapipe
@@ -0,0 +1,101 @@
+// "desktop/prebuilt/shm_frame_ring.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/desktop
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_SHM_FRAME_RING_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_SHM_FRAME_RING_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+namespace prebuilt {
+
+struct ShmFrameRingHeader;
+struct ShmFrameRingSlot;
+
+// A fixed number of frame slots in POSIX shared memory, for handing frames
+// from a capture process to a graph without encoding or copying them. One
+// process writes and one reads.
+//
+// The writer creates the ring, fills a free slot in place and publishes it
+// with its capture timestamp, size and format. The reader takes published
+// frames in order as ImageFrames that point into the slot; the slot becomes
+// free again when the ImageFrame is deleted, in whatever order the graph
+// releases them. Process-shared semaphores count the free and the published
+// slots, so neither side spins.
+//
+// A reader that attaches frees the slots a previous reader was holding when
+// it went away. The writer unlinks the ring when it is destroyed; mappings
+// stay valid until both sides let go of them.
+class ShmFrameRing : public std::enable_shared_from_this<ShmFrameRing> {
+ public:
+  struct FrameInfo {
+    // Capture time, in microseconds of any monotonic clock.
+    int64 timestamp_us = 0;
+    ImageFormat::Format format = ImageFormat::SRGB;
+    int width = 0;
+    int height = 0;
+    // Bytes per row, at least width times the pixel size.
+    int width_step = 0;
+  };
+
+  // Creates the ring `name` ("/name", as for shm_open) with `num_slots`
+  // slots of `slot_bytes` pixel bytes each, replacing any ring left under
+  // that name.
+  static absl::StatusOr<std::shared_ptr<ShmFrameRing>> Create(
+      const std::string& name, int num_slots, size_t slot_bytes);
+  // Attaches to the ring `name` as its reader.
+  static absl::StatusOr<std::shared_ptr<ShmFrameRing>> Open(
+      const std::string& name);
+
+  ~ShmFrameRing();
+  ShmFrameRing(const ShmFrameRing&) = delete;
+  ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+  int num_slots() const;
+  size_t slot_bytes() const;
+
+  // Writer. Claims a free slot to be filled through SlotPixels(). Returns -1
+  // when every slot is still held after `timeout`.
+  int AcquireSlot(absl::Duration timeout);
+  uint8* SlotPixels(int slot);
+  // Hands a filled slot to the reader.
+  absl::Status PublishSlot(int slot, const FrameInfo& info);
+  // Tells the reader that no more frames follow.
+  void Close();
+
+  // Reader. Takes the next published frame, waiting up to `timeout` for
+  // one. Returns nullptr when none arrived, or when the writer closed the
+  // ring and every frame was taken; closed() tells the two apart.
+  absl::StatusOr<std::unique_ptr<ImageFrame>> Read(absl::Duration timeout,
+                                                   int64* timestamp_us);
+  bool closed() const;
+
+ private:
+  ShmFrameRing(std::string name, bool owner, void* mapping,
+               size_t mapping_bytes);
+
+  ShmFrameRingSlot* Slot(int slot) const;
+  // Frees a slot the reader took.
+  void ReleaseSlot(int slot);
+
+  const std::string name_;
+  // Whether this side created the ring and unlinks it.
+  const bool owner_;
+  void* const mapping_;
+  const size_t mapping_bytes_;
+  ShmFrameRingHeader* const header_;
+};
+
+}  // namespace prebuilt
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_PREBUILT_SHM_FRAME_RING_H_
@@ -0,0 +1,36 @@
+// "ios/prebuilt/common/MPPBGraphSession.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/ios/common/
+
+#import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+#import <CoreMedia/CoreMedia.h>
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/examples/common/prebuilt/util/graph_session.h"
+
+// Objective-C++ glue between the framework wrappers and GraphSession. The graph
+// logic lives in the portable session; these only translate bundle resources,
+// CMTime and CVPixelBufferRef. Failures are logged, and a null session makes
+// every call a no-op, as a nil MPPGraph used to.
+
+// Creates a session for `<resource>.binarypb` in `bundle`.
+std::unique_ptr<mediapipe::prebuilt::GraphSession> MPPBCreateSessionFromResource(
+    NSBundle* bundle, NSString* resource);
+
+// Creates a session for a text proto graph config.
+std::unique_ptr<mediapipe::prebuilt::GraphSession> MPPBCreateSessionFromString(
+    NSString* string);
+
+// Calls `block` with the pixel buffer of every frame on `stream`, on a graph
+// worker thread.
+void MPPBObservePixelBuffers(mediapipe::prebuilt::GraphSession* session,
+                             const std::string& stream,
+                             void (^block)(CVPixelBufferRef pixelBuffer));
+
+void MPPBStartSession(mediapipe::prebuilt::GraphSession* session);
+
+// Sends a camera frame into the session, stamped with its presentation time.
+void MPPBSendPixelBuffer(mediapipe::prebuilt::GraphSession* session,
+                         CVPixelBufferRef imageBuffer, CMTime timestamp);
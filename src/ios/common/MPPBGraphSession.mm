@@ -0,0 +1,91 @@
+// "ios/prebuilt/common/MPPBGraphSession.mm"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/ios/common/
+
+#import "MPPBGraphSession.h"
+
+#include <utility>
+
+#include "mediapipe/gpu/gpu_buffer.h"
+
+using mediapipe::prebuilt::GraphSession;
+
+namespace {
+
+std::unique_ptr<GraphSession> CreateSession(
+    absl::StatusOr<mediapipe::CalculatorGraphConfig> config) {
+    if (!config.ok()) {
+        NSLog(@"Failed to load MediaPipe graph config: %s",
+              config.status().ToString().c_str());
+        return nullptr;
+    }
+    // Same frame budget the wrappers gave MPPGraph.
+    GraphSession::Options options;
+    options.max_frames_in_flight = 2;
+    auto session = GraphSession::Create(*std::move(config), options);
+    if (!session.ok()) {
+        NSLog(@"Failed to create graph: %s",
+              session.status().ToString().c_str());
+        return nullptr;
+    }
+    return *std::move(session);
+}
+
+}  // namespace
+
+std::unique_ptr<GraphSession> MPPBCreateSessionFromResource(
+    NSBundle* bundle, NSString* resource) {
+    if (!resource || resource.length == 0) {
+        return nullptr;
+    }
+    NSError* configLoadError = nil;
+    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
+    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
+    if (!data) {
+        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
+        return nullptr;
+    }
+    return CreateSession(GraphSession::ParseConfig(
+        absl::string_view(static_cast<const char*>(data.bytes), data.length),
+        /*binary=*/true));
+}
+
+std::unique_ptr<GraphSession> MPPBCreateSessionFromString(NSString* string) {
+    if (!string || string.length == 0) {
+        NSLog(@"Failed to load MediaPipe graph config: empty string");
+        return nullptr;
+    }
+    return CreateSession(
+        GraphSession::ParseConfig(string.UTF8String, /*binary=*/false));
+}
+
+void MPPBObservePixelBuffers(GraphSession* session, const std::string& stream,
+                             void (^block)(CVPixelBufferRef pixelBuffer)) {
+    if (!session) return;
+    absl::Status status = session->ObserveOutput<mediapipe::GpuBuffer>(
+        stream, [block](const mediapipe::GpuBuffer& buffer, mediapipe::Timestamp) {
+            block(buffer.GetCVPixelBufferRef());
+        });
+    if (!status.ok()) {
+        NSLog(@"Failed to observe %s: %s", stream.c_str(), status.ToString().c_str());
+    }
+}
+
+void MPPBStartSession(GraphSession* session) {
+    if (!session) return;
+    absl::Status status = session->Start();
+    if (!status.ok()) {
+        NSLog(@"Failed to start graph: %s", status.ToString().c_str());
+    }
+}
+
+void MPPBSendPixelBuffer(GraphSession* session, CVPixelBufferRef imageBuffer,
+                         CMTime timestamp) {
+    if (!session) return;
+    // The packet retains the pixel buffer until the graph is done with it.
+    auto sent = session->SendFrame(
+        mediapipe::MakePacket<mediapipe::GpuBuffer>(imageBuffer),
+        CMTimeGetSeconds(timestamp));
+    if (!sent.ok()) {
+        NSLog(@"Failed to send frame: %s", sent.status().ToString().c_str());
+    }
+}
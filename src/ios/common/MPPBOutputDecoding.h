@@ -0,0 +1,30 @@
+// "ios/prebuilt/common/MPPBOutputDecoding.h"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/ios/common/
+
+#import <Foundation/Foundation.h>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+// Turns output packets of the wrapper graphs into what the delegates receive,
+// so the wrappers only decide which streams go to which delegate method.
+
+// Flattens landmarks into x, y, z, visibility, presence per landmark.
+NSArray<NSNumber*>* MPPBFlattenLandmarks(
+    const mediapipe::NormalizedLandmarkList& landmarkList);
+NSArray<NSNumber*>* MPPBFlattenLandmarks(
+    const mediapipe::LandmarkList& landmarkList);
+
+// Boxes every value of a repeated numeric proto field, e.g. the vertex and
+// index buffers of a face geometry mesh.
+template <typename RepeatedFieldT>
+NSArray<NSNumber*>* MPPBNumberArray(const RepeatedFieldT& values) {
+    NSMutableArray* numbers = [NSMutableArray arrayWithCapacity:values.size()];
+    for (const auto value : values) {
+        [numbers addObject:@(value)];
+    }
+    return numbers;
+}
+
+// Logs the landmarks of `name`[`index`], one line per landmark.
+void MPPBLogLandmarks(NSString* name, int index,
+                      const mediapipe::NormalizedLandmarkList& landmarkList);
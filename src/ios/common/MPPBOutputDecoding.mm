@@ -0,0 +1,40 @@
+// "ios/prebuilt/common/MPPBOutputDecoding.mm"
+// https://github.com/61315/mediapipe-prebuilt/tree/master/src/ios/common/
+
+#import "MPPBOutputDecoding.h"
+
+namespace {
+
+template <typename LandmarkListT>
+NSArray<NSNumber*>* FlattenLandmarks(const LandmarkListT& landmarkList) {
+    NSMutableArray* landmarks = [NSMutableArray arrayWithCapacity:landmarkList.landmark_size() * 5];
+    for (const auto& landmark : landmarkList.landmark()) {
+        [landmarks addObject:[NSNumber numberWithFloat:landmark.x()]];
+        [landmarks addObject:[NSNumber numberWithFloat:landmark.y()]];
+        [landmarks addObject:[NSNumber numberWithFloat:landmark.z()]];
+        [landmarks addObject:[NSNumber numberWithFloat:landmark.visibility()]];
+        [landmarks addObject:[NSNumber numberWithFloat:landmark.presence()]];
+    }
+    return landmarks;
+}
+
+}  // namespace
+
+NSArray<NSNumber*>* MPPBFlattenLandmarks(
+    const mediapipe::NormalizedLandmarkList& landmarkList) {
+    return FlattenLandmarks(landmarkList);
+}
+
+NSArray<NSNumber*>* MPPBFlattenLandmarks(
+    const mediapipe::LandmarkList& landmarkList) {
+    return FlattenLandmarks(landmarkList);
+}
+
+void MPPBLogLandmarks(NSString* name, int index,
+                      const mediapipe::NormalizedLandmarkList& landmarkList) {
+    NSLog(@"\tNumber of landmarks for %@[%d]: %d", name, index, landmarkList.landmark_size());
+    for (int i = 0; i < landmarkList.landmark_size(); ++i) {
+        const auto& landmark = landmarkList.landmark(i);
+        NSLog(@"\t\tLandmark[%d]: (%f, %f, %f)", i, landmark.x(), landmark.y(), landmark.z());
+    }
+}
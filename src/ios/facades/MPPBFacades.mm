@@ -3,88 +3,33 @@
 
 #import "MPPBFacades.h"
 
-#import "mediapipe/objc/MPPGraph.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
 
-#include "mediapipe/framework/port/parse_text_proto.h"
+using mediapipe::prebuilt::GraphSession;
 
 static NSString* const kGraphName = @"facades_mobile_gpu";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
 
-@interface MPPBFacades() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
-
-@implementation MPPBFacades { }
+@implementation MPPBFacades {
+    std::unique_ptr<GraphSession> _session;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
-// https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
-
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-
-    return newGraph;
-}
-
-+ (MPPGraph*)loadGraphFromString:(NSString*)string {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    
-    if (!string || string.length == 0) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config string into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config = mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(string.UTF8String);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-
-    return newGraph;
-}
 
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromResource([NSBundle bundleForClass:[self class]], kGraphName);
+        [self observeOutputs];
     }
     return self;
 }
@@ -93,51 +38,30 @@ static const char* kOutputStream = "output_video";
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromString:string];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromString(string);
+        [self observeOutputs];
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads.
+- (void)observeOutputs {
+    __weak MPPBFacades* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBFacades* strongSelf = weakSelf;
+        [strongSelf.delegate tracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
-    }
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
-}
-
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate tracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    return;
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
 @end
@@ -18,4 +18,8 @@
 - (void)startGraph;
 - (void)processVideoFrame: (CVPixelBufferRef)imageBuffer timestamp: (CMTime)timestamp;
 @property (weak, nonatomic) id <MPPBFaceGeometryDelegate> delegate;
+// Max number of faces to track and estimate the geometry of. Defaults to 1.
+// Must be set before -startGraph. Landmarks are smoothed for a single face
+// only, so transforms jitter more with several.
+@property (nonatomic) NSInteger numFaces;
 @end
@@ -1,92 +1,42 @@
 #import "MPPBFaceGeometry.h"
 
-#import "mediapipe/objc/MPPGraph.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBOutputDecoding.h"
 
-#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/formats/matrix_data.pb.h"
 #include "mediapipe/modules/face_geometry/protos/face_geometry.pb.h"
 
+using mediapipe::prebuilt::GraphSession;
+
 static NSString* const kGraphName = @"face_geometry_with_transform";
+static NSString* const kMultiFaceGraphName = @"face_geometry_multi_face";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
 static const char* kMultiFaceGeometryStream = "multi_face_geometry";
+static const char* kNumFacesInputSidePacket = "num_faces";
 
-@interface MPPBFaceGeometry() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
-
-@implementation MPPBFaceGeometry { }
+@implementation MPPBFaceGeometry {
+    std::unique_ptr<GraphSession> _session;
+    // Set when the graph comes from the framework bundle, which happens in
+    // -startGraph, once numFaces is final.
+    NSBundle* _graphBundle;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
-// https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
-
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    [newGraph addFrameOutputStream:kMultiFaceGeometryStream outputPacketType:MPPPacketTypeRaw];
-
-    return newGraph;
-}
-
-+ (MPPGraph*)loadGraphFromString:(NSString*)string {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    
-    if (!string || string.length == 0) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config string into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config = mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(string.UTF8String);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    [newGraph addFrameOutputStream:kMultiFaceGeometryStream outputPacketType:MPPPacketTypeRaw];
-
-    return newGraph;
-}
 
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _graphBundle = [NSBundle bundleForClass:[self class]];
+        _numFaces = 1;
     }
     return self;
 }
@@ -95,83 +45,68 @@ static const char* kMultiFaceGeometryStream = "multi_face_geometry";
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromString:string];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromString(string);
+        [self observeOutputs];
+        _numFaces = 1;
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads. Observing only fails once
+// the graph has started, which cannot have happened yet.
+- (void)observeOutputs {
+    if (!_session) return;
+    __weak MPPBFaceGeometry* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBFaceGeometry* strongSelf = weakSelf;
+        [strongSelf.delegate tracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+    _session->ObserveOutput<std::vector<mediapipe::face_geometry::FaceGeometry>>(kMultiFaceGeometryStream,
+        [weakSelf](const std::vector<mediapipe::face_geometry::FaceGeometry>& multiFaceGeometry,
+                   mediapipe::Timestamp) {
+            MPPBFaceGeometry* strongSelf = weakSelf;
+            [strongSelf didOutputMultiFaceGeometry:multiFaceGeometry];
+        }).IgnoreError();
+}
+
+- (void)didOutputMultiFaceGeometry:(const std::vector<mediapipe::face_geometry::FaceGeometry>&)multiFaceGeometry {
+    for (int faceIndex = 0; faceIndex < multiFaceGeometry.size(); ++faceIndex) {
+        const auto& faceGeometry = multiFaceGeometry[faceIndex];
+        const auto& t = faceGeometry.pose_transform_matrix().packed_data();
+        const auto& matrix = simd_matrix(
+            (simd_float4){ t[0],  t[1],  t[2],  t[3] },
+            (simd_float4){ t[4],  t[5],  t[6],  t[7] },
+            (simd_float4){ t[8],  t[9],  t[10], t[11] },
+            (simd_float4){ t[12], t[13], t[14], t[15] }
+        );
+
+        [_delegate tracker: self didOutputTransform: matrix withFace: faceIndex];
+
+        [_delegate tracker: self
+         didOutputGeometry: MPPBNumberArray(faceGeometry.mesh().index_buffer())
+              withVertices: MPPBNumberArray(faceGeometry.mesh().vertex_buffer())
+                  withFace: faceIndex];
+    }
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
+    // Only the single face graph smooths the landmarks.
+    if (!_session && _graphBundle) {
+        _session = MPPBCreateSessionFromResource(
+            _graphBundle, self.numFaces > 1 ? kMultiFaceGraphName : kGraphName);
+        [self observeOutputs];
     }
+    if (!_session) return;
+    _session->SetSidePacket(kNumFacesInputSidePacket,
+                            mediapipe::MakePacket<int>(static_cast<int>(self.numFaces))).IgnoreError();
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
-}
-
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate tracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    if (streamName == kMultiFaceGeometryStream) {
-        if (packet.IsEmpty()) {
-            NSLog(@"[TS:%lld] No face geometry", packet.Timestamp().Value());
-            return;
-        }
-        
-        const auto& multiFaceGeometry = packet.Get<std::vector<::mediapipe::face_geometry::FaceGeometry>>();
-        
-        for (int faceIndex = 0; faceIndex < multiFaceGeometry.size(); ++faceIndex) {
-            const auto& faceGeometry = multiFaceGeometry[faceIndex];
-            const auto& t = faceGeometry.pose_transform_matrix().packed_data();
-            const auto& matrix = simd_matrix(
-                (simd_float4){ t[0],  t[1],  t[2],  t[3] },
-                (simd_float4){ t[4],  t[5],  t[6],  t[7] },
-                (simd_float4){ t[8],  t[9],  t[10], t[11] },
-                (simd_float4){ t[12], t[13], t[14], t[15] }
-            );
-            
-            [_delegate tracker: self didOutputTransform: matrix withFace: faceIndex];
-
-            NSMutableArray *indices = [NSMutableArray arrayWithCapacity:faceGeometry.mesh().index_buffer_size()];
-            for (int i = 0; i < faceGeometry.mesh().index_buffer_size(); ++i) {
-                [indices addObject:[NSNumber numberWithInteger:faceGeometry.mesh().index_buffer(i)]];
-            }
-            
-            NSMutableArray *vertices = [NSMutableArray arrayWithCapacity:faceGeometry.mesh().vertex_buffer_size()];
-            for (int i = 0; i < faceGeometry.mesh().vertex_buffer_size(); ++i) {
-                [vertices addObject:[NSNumber numberWithFloat:faceGeometry.mesh().vertex_buffer(i)]];
-            }
-
-            [_delegate tracker: self didOutputGeometry: indices withVertices: vertices withFace: faceIndex];
-        }
-    }
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
 @end
@@ -16,4 +16,8 @@
 - (void)startGraph;
 - (void)processVideoFrame: (CVPixelBufferRef)imageBuffer timestamp: (CMTime)timestamp;
 @property (weak, nonatomic) id <MPPBFaceMeshDelegate> delegate;
+// Whether annotations are drawn onto the output pixel buffers. Defaults to YES.
+// With NO, the graph skips rendering and hands back the input frames as is.
+// Must be set before -startGraph.
+@property (nonatomic) BOOL renderEnabled;
 @end
\ No newline at end of file
@@ -1,137 +1,82 @@
 #import "MPPBFaceMesh.h"
-#import "mediapipe/objc/MPPGraph.h"
+
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBOutputDecoding.h"
 
 #include "mediapipe/framework/formats/landmark.pb.h"
 
+using mediapipe::prebuilt::GraphSession;
+
 static NSString* const kGraphName = @"custom_face_mesh_ios";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
 
 static const char* kNumFacesInputSidePacket = "num_faces";
+static const char* kRenderInputSidePacket = "render";
 static const char* kLandmarksOutputStream = "multi_smoothed_face_landmarks";
 
 // Max number of faces to detect/process.
 static const int kNumFaces = 1;
 
-@interface MPPBFaceMesh() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
-
-@implementation MPPBFaceMesh { }
+@implementation MPPBFaceMesh {
+    std::unique_ptr<GraphSession> _session;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
-// https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
-
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-    
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph setSidePacket:(mediapipe::MakePacket<int>(kNumFaces))
-                               named:kNumFacesInputSidePacket];
-    [newGraph addFrameOutputStream:kLandmarksOutputStream outputPacketType:MPPPacketTypeRaw];
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    
-    return newGraph;
-}
 
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromResource([NSBundle bundleForClass:[self class]], kGraphName);
+        [self observeOutputs];
+        _renderEnabled = YES;
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads. Observing only fails once
+// the graph has started, which cannot have happened yet.
+- (void)observeOutputs {
+    if (!_session) return;
+    __weak MPPBFaceMesh* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBFaceMesh* strongSelf = weakSelf;
+        [strongSelf.delegate tracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+    _session->ObserveOutput<std::vector<mediapipe::NormalizedLandmarkList>>(kLandmarksOutputStream,
+        [](const std::vector<mediapipe::NormalizedLandmarkList>& multi_face_landmarks,
+           mediapipe::Timestamp timestamp) {
+            NSLog(@"[TS:%lld] Number of face instances with landmarks: %lu", timestamp.Value(),
+                multi_face_landmarks.size());
+
+            for (int face_index = 0; face_index < multi_face_landmarks.size(); ++face_index) {
+                MPPBLogLandmarks(@"face", face_index, multi_face_landmarks[face_index]);
+            }
+        }).IgnoreError();
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
-    }
+    if (!_session) return;
+    _session->SetSidePacket(kNumFacesInputSidePacket,
+                            mediapipe::MakePacket<int>(kNumFaces)).IgnoreError();
+    _session->SetSidePacket(kRenderInputSidePacket,
+                            mediapipe::MakePacket<bool>(self.renderEnabled)).IgnoreError();
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate tracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    if (streamName == kLandmarksOutputStream) {
-        if (packet.IsEmpty()) {
-                NSLog(@"[TS:%lld] No face landmarks", packet.Timestamp().Value());
-                return;
-            }
-            
-            const auto& multi_face_landmarks = packet.Get<std::vector<::mediapipe::NormalizedLandmarkList>>();
-            
-            NSLog(@"[TS:%lld] Number of face instances with landmarks: %lu", packet.Timestamp().Value(),
-                multi_face_landmarks.size());
-            
-            for (int face_index = 0; face_index < multi_face_landmarks.size(); ++face_index) {
-                const auto& landmarks = multi_face_landmarks[face_index];
-                
-                NSLog(@"\tNumber of landmarks for face[%d]: %d", face_index, landmarks.landmark_size());
-                
-                for (int i = 0; i < landmarks.landmark_size(); ++i) {
-                    NSLog(@"\t\tLandmark[%d]: (%f, %f, %f)", i, landmarks.landmark(i).x(),
-                        landmarks.landmark(i).y(), landmarks.landmark(i).z());
-            }
-        }
-    }
-}
-
-@end
\ No newline at end of file
+@end
@@ -1,150 +1,79 @@
 #import "MPPBHand.h"
-#import "mediapipe/objc/MPPGraph.h"
-#import "mediapipe/objc/MPPCameraInputSource.h"
-#import "mediapipe/objc/MPPLayerRenderer.h"
+
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBOutputDecoding.h"
+
 #include "mediapipe/framework/formats/landmark.pb.h"
 
+using mediapipe::prebuilt::GraphSession;
+
 static NSString* const kGraphName = @"hand_tracking_mobile_gpu";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
 
 static const char* kLandmarksOutputStream = "hand_landmarks";
 static const char* kNumHandsInputSidePacket = "num_hands";
-static const char* kVideoQueueLabel = "com.mediapipe.prebuilt.example.videoQueue";
 
 // Max number of hands to detect/process.
 static const int kNumHands = 2;
 
-/// Input side packet for `num_hands` parameter.
-// std::map<std::string, mediapipe::Packet> _input_side_packets;
-// mediapipe::Packet _number_of_hands_side_packet;
-
-@interface MPPBHand() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
-
-
-@implementation MPPBHand { }
+@implementation MPPBHand {
+    std::unique_ptr<GraphSession> _session;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
 // https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
 
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-    
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    // _number_of_hands_side_packet =
-    // mediapipe::MakePacket<std::unique_ptr<float>>(absl::make_unique<float>(0.0));
-    // _input_side_packets = {
-    //     {"focal_length_pixel", _number_of_hands_side_packet},
-    // };
-    // [newGraph addSidePackets:_input_side_packets];
-    [newGraph setSidePacket:(mediapipe::MakePacket<int>(kNumHands))
-                               named:kNumHandsInputSidePacket];
-    [newGraph addFrameOutputStream:kLandmarksOutputStream outputPacketType:MPPPacketTypeRaw];
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    
-    return newGraph;
-}
-
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromResource([NSBundle bundleForClass:[self class]], kGraphName);
+        [self observeOutputs];
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads. Observing only fails once
+// the graph has started, which cannot have happened yet.
+- (void)observeOutputs {
+    if (!_session) return;
+    __weak MPPBHand* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBHand* strongSelf = weakSelf;
+        [strongSelf.delegate handTracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+    _session->ObserveOutput<std::vector<mediapipe::NormalizedLandmarkList>>(kLandmarksOutputStream,
+        [](const std::vector<mediapipe::NormalizedLandmarkList>& multiHandLandmarks,
+           mediapipe::Timestamp timestamp) {
+            NSLog(@"[TS:%lld] Number of hand instances with landmarks: %lu", timestamp.Value(),
+                multiHandLandmarks.size());
+
+            for (int handIndex = 0; handIndex < multiHandLandmarks.size(); ++handIndex) {
+                MPPBLogLandmarks(@"hand", handIndex, multiHandLandmarks[handIndex]);
+            }
+        }).IgnoreError();
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
-    }
+    if (!_session) return;
+    _session->SetSidePacket(kNumHandsInputSidePacket,
+                            mediapipe::MakePacket<int>(kNumHands)).IgnoreError();
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
-}
-
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate handTracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    if (streamName == kLandmarksOutputStream) {
-        if (packet.IsEmpty()) {
-            NSLog(@"[TS:%lld] No hand landmarks", packet.Timestamp().Value());
-            return;
-        }
-
-        const auto& multiHandLandmarks = packet.Get<std::vector<::mediapipe::NormalizedLandmarkList>>();
-        
-        NSLog(@"[TS:%lld] Number of hand instances with landmarks: %lu", packet.Timestamp().Value(),
-            multiHandLandmarks.size());
-        
-        for (int handIndex = 0; handIndex < multiHandLandmarks.size(); ++handIndex) {
-            const auto& landmarks = multiHandLandmarks[handIndex];
-            
-            NSLog(@"\tNumber of landmarks for hand[%d]: %d", handIndex, landmarks.landmark_size());
-            
-            for (int i = 0; i < landmarks.landmark_size(); ++i) {
-                NSLog(@"\t\tLandmark[%d]: (%f, %f, %f)", i, landmarks.landmark(i).x(),
-                    landmarks.landmark(i).y(), landmarks.landmark(i).z());
-            }
-        }
-    }
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
-@end
\ No newline at end of file
+@end
@@ -1,137 +1,75 @@
 #import "MPPBIris.h"
-#import "mediapipe/objc/MPPGraph.h"
-#import "mediapipe/objc/MPPCameraInputSource.h"
-#import "mediapipe/objc/MPPLayerRenderer.h"
+
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBOutputDecoding.h"
+
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 
+using mediapipe::prebuilt::GraphSession;
+
 static NSString* const kGraphName = @"iris_tracking_gpu";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
 
 static const char* kLandmarksOutputStream = "iris_landmarks";
-static const char* kVideoQueueLabel = "com.mediapipe.prebuilt.example.videoQueue";
-
 
 /// Input side packet for focal length parameter.
-std::map<std::string, mediapipe::Packet> _input_side_packets;
-mediapipe::Packet _focal_length_side_packet;
-
-@interface MPPBIris() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
+static const char* kFocalLengthInputSidePacket = "focal_length_pixel";
 
-
-@implementation MPPBIris { }
+@implementation MPPBIris {
+    std::unique_ptr<GraphSession> _session;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
 // https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
 
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-    
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-    
-    _focal_length_side_packet =
-    mediapipe::MakePacket<std::unique_ptr<float>>(absl::make_unique<float>(0.0));
-    _input_side_packets = {
-        {"focal_length_pixel", _focal_length_side_packet},
-    };
-    [newGraph addSidePackets:_input_side_packets];
-    [newGraph addFrameOutputStream:kLandmarksOutputStream outputPacketType:MPPPacketTypeRaw];
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    
-    return newGraph;
-}
-
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromResource([NSBundle bundleForClass:[self class]], kGraphName);
+        [self observeOutputs];
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads. Observing only fails once
+// the graph has started, which cannot have happened yet.
+- (void)observeOutputs {
+    if (!_session) return;
+    __weak MPPBIris* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBIris* strongSelf = weakSelf;
+        [strongSelf.delegate irisTracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+    _session->ObserveOutput<mediapipe::NormalizedLandmarkList>(kLandmarksOutputStream,
+        [](const mediapipe::NormalizedLandmarkList& landmarks, mediapipe::Timestamp timestamp) {
+            NSLog(@"[TS:%lld] Iris landmarks:", timestamp.Value());
+            MPPBLogLandmarks(@"iris", 0, landmarks);
+        }).IgnoreError();
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
-    }
+    if (!_session) return;
+    _session->SetSidePacket(kFocalLengthInputSidePacket,
+                            mediapipe::MakePacket<std::unique_ptr<float>>(
+                                absl::make_unique<float>(0.0))).IgnoreError();
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate irisTracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    if (streamName == kLandmarksOutputStream) {
-        if (packet.IsEmpty()) {
-            NSLog(@"[TS:%lld] No iris landmarks", packet.Timestamp().Value());
-            return;
-        }
-        
-        const auto& landmarks = packet.Get<::mediapipe::NormalizedLandmarkList>();
-        NSLog(@"[TS:%lld] Number of landmarks on iris: %d", packet.Timestamp().Value(),
-              landmarks.landmark_size());
-        for (int i = 0; i < landmarks.landmark_size(); ++i) {
-          NSLog(@"\tLandmark[%d]: (%f, %f, %f)", i, landmarks.landmark(i).x(),
-                landmarks.landmark(i).y(), landmarks.landmark(i).z());
-        }
-    }
-}
-
-@end
\ No newline at end of file
+@end
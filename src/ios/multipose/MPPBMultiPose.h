@@ -19,4 +19,8 @@
 - (void)startGraph;
 - (void)processVideoFrame: (CVPixelBufferRef)imageBuffer timestamp: (CMTime)timestamp;
 @property (weak, nonatomic) id <MPPBMultiPoseDelegate> delegate;
+// Whether annotations are drawn onto the output pixel buffers. Defaults to YES.
+// With NO, the graph skips rendering and hands back the input frames as is.
+// Must be set before -startGraph.
+@property (nonatomic) BOOL renderEnabled;
 @end
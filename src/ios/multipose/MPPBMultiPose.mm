@@ -3,92 +3,38 @@
 
 #import "MPPBMultiPose.h"
 
-#import "mediapipe/objc/MPPGraph.h"
+#import "mediapipe/examples/ios/prebuilt/common/MPPBGraphSession.h"
 
-#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/formats/detection.pb.h"
 
+using mediapipe::prebuilt::GraphSession;
+
 static NSString* const kGraphName = @"multi_pose_tracking_gpu";
 
-static const char* kInputStream = "input_video";
 static const char* kOutputStream = "output_video";
+static const char* kRenderInputSidePacket = "render";
 static const char* kDetectionsOutputStream = "pose_detections";
 
-@interface MPPBMultiPose() <MPPGraphDelegate>
-@property(nonatomic) MPPGraph* mediapipeGraph;
-@end
-
-@implementation MPPBMultiPose { }
+@implementation MPPBMultiPose {
+    std::unique_ptr<GraphSession> _session;
+}
 
 #pragma mark - Cleanup methods
 
 - (void)dealloc {
-    self.mediapipeGraph.delegate = nil;
-    [self.mediapipeGraph cancel];
-    
-    // Ignore errors since we're cleaning up.
-    [self.mediapipeGraph closeAllInputStreamsWithError:nil];
-    [self.mediapipeGraph waitUntilDoneWithError:nil];
+    // Cancels the graph and waits for its callbacks to return.
+    _session.reset();
 }
 
 #pragma mark - MediaPipe graph methods
-// https://google.github.io/mediapipe/getting_started/hello_world_ios.html#using-a-mediapipe-graph-in-ios
-
-+ (MPPGraph*)loadGraphFromResource:(NSString*)resource {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    NSBundle* bundle = [NSBundle bundleForClass:[self class]];
-    if (!resource || resource.length == 0) {
-        return nil;
-    }
-    NSURL* graphURL = [bundle URLForResource:resource withExtension:@"binarypb"];
-    NSData* data = [NSData dataWithContentsOfURL:graphURL options:0 error:&configLoadError];
-    if (!data) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config resource into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config;
-    config.ParseFromArray(data.bytes, data.length);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    [newGraph addFrameOutputStream:kDetectionsOutputStream outputPacketType:MPPPacketTypeRaw];
-
-    return newGraph;
-}
-
-+ (MPPGraph*)loadGraphFromString:(NSString*)string {
-    // Load the graph config resource.
-    NSError* configLoadError = nil;
-    
-    if (!string || string.length == 0) {
-        NSLog(@"Failed to load MediaPipe graph config: %@", configLoadError);
-        return nil;
-    }
-    
-    // Parse the graph config string into mediapipe::CalculatorGraphConfig proto object.
-    mediapipe::CalculatorGraphConfig config = mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(string.UTF8String);
-
-    // Create MediaPipe graph with mediapipe::CalculatorGraphConfig proto object.
-    MPPGraph* newGraph = [[MPPGraph alloc] initWithGraphConfig:config];
-
-    [newGraph addFrameOutputStream:kOutputStream outputPacketType:MPPPacketTypePixelBuffer];
-    [newGraph addFrameOutputStream:kDetectionsOutputStream outputPacketType:MPPPacketTypeRaw];
-
-    return newGraph;
-}
 
 - (instancetype)init
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromResource:kGraphName];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromResource([NSBundle bundleForClass:[self class]], kGraphName);
+        [self observeOutputs];
+        _renderEnabled = YES;
     }
     return self;
 }
@@ -97,60 +43,40 @@ static const char* kDetectionsOutputStream = "pose_detections";
 {
     self = [super init];
     if (self) {
-        self.mediapipeGraph = [[self class] loadGraphFromString:string];
-        self.mediapipeGraph.delegate = self;
-        self.mediapipeGraph.maxFramesInFlight = 2;
+        _session = MPPBCreateSessionFromString(string);
+        [self observeOutputs];
+        _renderEnabled = YES;
     }
     return self;
 }
 
+// Output callbacks run on MediaPipe worker threads. Observing only fails once
+// the graph has started, which cannot have happened yet.
+- (void)observeOutputs {
+    if (!_session) return;
+    __weak MPPBMultiPose* weakSelf = self;
+    MPPBObservePixelBuffers(_session.get(), kOutputStream, ^(CVPixelBufferRef pixelBuffer) {
+        MPPBMultiPose* strongSelf = weakSelf;
+        [strongSelf.delegate tracker: strongSelf didOutputPixelBuffer: pixelBuffer];
+    });
+    _session->ObserveOutput<std::vector<mediapipe::Detection>>(kDetectionsOutputStream,
+        [](const std::vector<mediapipe::Detection>& detections, mediapipe::Timestamp) {
+            NSLog(@"[MPPBMultiPose] Number of detection: %lu", detections.size());
+        }).IgnoreError();
+}
+
 - (void)startGraph {
-    // Start running self.mediapipeGraph.
-    NSError* error;
-    if (![self.mediapipeGraph startWithError:&error]) {
-        NSLog(@"Failed to start graph: %@", error);
-    }
+    if (!_session) return;
+    _session->SetSidePacket(kRenderInputSidePacket,
+                            mediapipe::MakePacket<bool>(self.renderEnabled)).IgnoreError();
+    MPPBStartSession(_session.get());
 }
 
 #pragma mark - MPPInputSourceDelegate methods
 
 - (void)processVideoFrame:(CVPixelBufferRef)imageBuffer
                 timestamp:(CMTime)timestamp {
-    
-    mediapipe::Timestamp graphTimestamp(static_cast<mediapipe::TimestampBaseType>(
-        mediapipe::Timestamp::kTimestampUnitsPerSecond * CMTimeGetSeconds(timestamp)));
-    
-    [self.mediapipeGraph sendPixelBuffer:imageBuffer
-                              intoStream:kInputStream
-                              packetType:MPPPacketTypePixelBuffer
-                               timestamp:graphTimestamp];
-}
-
-#pragma mark - MPPGraphDelegate methods
-
-// Receives CVPixelBufferRef from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-  didOutputPixelBuffer:(CVPixelBufferRef)pixelBuffer
-            fromStream:(const std::string&)streamName {
-    if (streamName == kOutputStream) {
-        [_delegate tracker: self didOutputPixelBuffer: pixelBuffer];
-    }
-}
-
-// Receives a raw packet from the MediaPipe graph. Invoked on a MediaPipe worker thread.
-- (void)mediapipeGraph:(MPPGraph*)graph
-       didOutputPacket:(const ::mediapipe::Packet&)packet
-            fromStream:(const std::string&)streamName {
-    if (streamName == kDetectionsOutputStream) {
-        if (packet.IsEmpty()) {
-            NSLog(@"[MPPBMultiPose] No pose detection", packet.Timestamp().Value());
-            return;
-        }
-
-        const auto& detections = packet.Get<std::vector<::mediapipe::Detection>>();
-
-        NSLog(@"[MPPBMultiPose] Number of detection: %lld", detections.size());
-    }
+    MPPBSendPixelBuffer(_session.get(), imageBuffer, timestamp);
 }
 
 @end